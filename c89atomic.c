@@ -1,8 +1,8 @@
 /*
-This file is only needed for the global lock, which is only needed for architectures that
-don't natively support a particular atomic operation. Most applications will not need this,
-but if you get errors about c89atomic_global_lock not being defined, you need to include
-this file in your project.
+This file is needed for the lock table, which is only needed for architectures that don't natively
+support a particular atomic operation, and for the wait/notify functions which need to talk to the OS.
+Most applications will not need this, but if you get errors about c89atomic_lock_table or
+c89atomic_wait_explicit_32 not being defined, you need to include this file in your project.
 */
 #ifndef c89atomic_c
 #define c89atomic_c
@@ -11,6 +11,145 @@ this file in your project.
 
 /* BEG c89atomic_global_lock.c */
 c89atomic_spinlock c89atomic_global_lock = 0;
+
+#if !defined(C89ATOMIC_USE_GLOBAL_LOCK)
+c89atomic_lock_table_entry c89atomic_lock_table[C89ATOMIC_LOCK_TABLE_SIZE];   /* Zero initialized, which means unlocked. */
+#endif
 /* END c89atomic_global_lock.c */
 
+
+/* BEG c89atomic_wait.c */
+#if defined(__linux__) && !defined(C89ATOMIC_NO_FUTEX)
+    #define C89ATOMIC_FUTEX
+#endif
+
+#if defined(C89ATOMIC_FUTEX)
+    #include <unistd.h>
+    #include <sys/syscall.h>    /* For SYS_futex. */
+    #include <linux/futex.h>    /* For FUTEX_WAIT_PRIVATE and FUTEX_WAKE_PRIVATE. */
+
+    #if !defined(__cplusplus)
+        /* unistd.h will not declare syscall() in strict C89 mode unless a feature test macro has been defined before including it. */
+        extern long syscall(long number, ...);
+    #endif
+
+    /* Private futexes were added in Linux 2.6.22. */
+    #ifndef FUTEX_WAIT_PRIVATE
+    #define FUTEX_WAIT_PRIVATE  FUTEX_WAIT
+    #endif
+    #ifndef FUTEX_WAKE_PRIVATE
+    #define FUTEX_WAKE_PRIVATE  FUTEX_WAKE
+    #endif
+#elif defined(_WIN32)
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sched.h>
+#endif
+
+/* The number of times a waiter will re-check the value before going to sleep. */
+#ifndef C89ATOMIC_WAIT_SPIN_COUNT
+#define C89ATOMIC_WAIT_SPIN_COUNT   100
+#endif
+
+#if defined(C89ATOMIC_FUTEX)
+/*
+A notify would normally need to do a syscall every time, which is a waste when nobody is waiting.
+To avoid this we keep track of the number of waiters in a small table indexed by the address being
+waited on. Different addresses can share a slot, but that just results in a wasted syscall.
+*/
+#ifndef C89ATOMIC_WAIT_TABLE_SIZE
+#define C89ATOMIC_WAIT_TABLE_SIZE   64  /* Must be a power of 2. */
+#endif
+
+static c89atomic_uint32 c89atomic_wait_table[C89ATOMIC_WAIT_TABLE_SIZE];
+
+static volatile c89atomic_uint32* c89atomic_wait_get_waiter_count(volatile c89atomic_uint32* ptr)
+{
+    unsigned long address = (unsigned long)ptr;  /* unsigned long is the size of a pointer on Linux. */
+    return &c89atomic_wait_table[((address >> 2) ^ (address >> 8)) & (C89ATOMIC_WAIT_TABLE_SIZE - 1)];
+}
+
+static void c89atomic_wait_park_32(volatile c89atomic_uint32* ptr, c89atomic_uint32 oldValue)
+{
+    volatile c89atomic_uint32* pWaiterCount = c89atomic_wait_get_waiter_count(ptr);
+
+    /*
+    The waiter count must be incremented before the kernel checks the value. This pairs with the fence
+    in c89atomic_notify_32() so that either we see the new value, or the notifier sees our count.
+    */
+    c89atomic_fetch_add_explicit_32(pWaiterCount, 1, c89atomic_memory_order_seq_cst);
+    {
+        /* The kernel will only put us to sleep if the value is still equal to oldValue. */
+        syscall(SYS_futex, ptr, FUTEX_WAIT_PRIVATE, oldValue, NULL, NULL, 0);
+    }
+    c89atomic_fetch_sub_explicit_32(pWaiterCount, 1, c89atomic_memory_order_relaxed);
+}
+
+static void c89atomic_notify_32(volatile c89atomic_uint32* ptr, int count)
+{
+    volatile c89atomic_uint32* pWaiterCount = c89atomic_wait_get_waiter_count(ptr);
+
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+    if (c89atomic_load_explicit_32(pWaiterCount, c89atomic_memory_order_relaxed) == 0) {
+        return; /* Nobody is waiting. */
+    }
+
+    syscall(SYS_futex, ptr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#else
+static void c89atomic_wait_park_32(volatile c89atomic_uint32* ptr, c89atomic_uint32 oldValue)
+{
+    /* There's no way to actually sleep on an address here so the best we can do is give up our time slice. */
+    (void)ptr;
+    (void)oldValue;
+
+    #if defined(_WIN32)
+    {
+        Sleep(0);
+    }
+    #elif defined(__unix__) || defined(__APPLE__)
+    {
+        sched_yield();
+    }
+    #endif
+}
+
+static void c89atomic_notify_32(volatile c89atomic_uint32* ptr, int count)
+{
+    /* Waiters are polling so there's nothing to do. */
+    (void)ptr;
+    (void)count;
+}
+#endif
+
+C89ATOMIC_API void c89atomic_wait_explicit_32(volatile c89atomic_uint32* ptr, c89atomic_uint32 oldValue, c89atomic_memory_order order)
+{
+    c89atomic_uint32 spinCount = 0;
+
+    for (;;) {
+        if (c89atomic_load_explicit_32(ptr, order) != oldValue) {
+            return;
+        }
+
+        /* Spin for a bit before parking in case the value is about to change. Parking is expensive. */
+        if (spinCount < C89ATOMIC_WAIT_SPIN_COUNT) {
+            spinCount += 1;
+            c89atomic_cpu_relax();
+        } else {
+            c89atomic_wait_park_32(ptr, oldValue);
+        }
+    }
+}
+
+C89ATOMIC_API void c89atomic_notify_one_32(volatile c89atomic_uint32* ptr)
+{
+    c89atomic_notify_32(ptr, 1);
+}
+
+C89ATOMIC_API void c89atomic_notify_all_32(volatile c89atomic_uint32* ptr)
+{
+    c89atomic_notify_32(ptr, 0x7FFFFFFF);
+}
+/* END c89atomic_wait.c */
+
 #endif /* c89atomic_h*/
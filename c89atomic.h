@@ -44,7 +44,9 @@ For practicality, this is not a drop-in replacement for C11's `stdatomic.h`. Bel
 between c89atomic and stdatomic.
 
     * All operations require an explicit size which is specified by the name of the function, and only 8-,
-      16-, 32- and 64-bit operations are supported. Objects of an arbitrary sizes are not supported.
+      16-, 32- and 64-bit operations are supported. Objects of an arbitrary sizes are not supported. There is
+      limited support for 128-bit objects via `c89atomic_uint128` which supports only compare-exchange and
+      load.
     * All APIs are namespaced with `c89`.
     * `c89atomic_*` data types are undecorated (there is no `_Atomic` decoration).
 
@@ -172,6 +174,24 @@ The following types and functions are implemented:
 |                                         | c89atomic_fetch_and_explicit_32               |
 |                                         | c89atomic_fetch_and_explicit_64               |
 +-----------------------------------------+-----------------------------------------------+
+| atomic_fetch_min                        | c89atomic_fetch_min_8                         |
+| atomic_fetch_min_explicit               | c89atomic_fetch_min_16                        |
+|                                         | c89atomic_fetch_min_32                        |
+|                                         | c89atomic_fetch_min_64                        |
+|                                         | c89atomic_fetch_min_explicit_8                |
+|                                         | c89atomic_fetch_min_explicit_16               |
+|                                         | c89atomic_fetch_min_explicit_32               |
+|                                         | c89atomic_fetch_min_explicit_64               |
++-----------------------------------------+-----------------------------------------------+
+| atomic_fetch_max                        | c89atomic_fetch_max_8                         |
+| atomic_fetch_max_explicit               | c89atomic_fetch_max_16                        |
+|                                         | c89atomic_fetch_max_32                        |
+|                                         | c89atomic_fetch_max_64                        |
+|                                         | c89atomic_fetch_max_explicit_8                |
+|                                         | c89atomic_fetch_max_explicit_16               |
+|                                         | c89atomic_fetch_max_explicit_32               |
+|                                         | c89atomic_fetch_max_explicit_64               |
++-----------------------------------------+-----------------------------------------------+
 | atomic_thread_fence()                   | c89atomic_thread_fence                        |
 | atomic_signal_fence()                   | c89atomic_signal_fence                        |
 +-----------------------------------------+-----------------------------------------------+
@@ -180,6 +200,18 @@ The following types and functions are implemented:
 |                                         | c89atomic_is_lock_free_32                     |
 |                                         | c89atomic_is_lock_free_64                     |
 +-----------------------------------------+-----------------------------------------------+
+| ATOMIC_CHAR_LOCK_FREE                   | C89ATOMIC_ALWAYS_LOCK_FREE_8                  |
+| ATOMIC_SHORT_LOCK_FREE                  | C89ATOMIC_ALWAYS_LOCK_FREE_16                 |
+| ATOMIC_INT_LOCK_FREE                    | C89ATOMIC_ALWAYS_LOCK_FREE_32                 |
+| ATOMIC_LLONG_LOCK_FREE                  | C89ATOMIC_ALWAYS_LOCK_FREE_64                 |
+| ATOMIC_POINTER_LOCK_FREE                | C89ATOMIC_ALWAYS_LOCK_FREE_PTR                |
++-----------------------------------------+-----------------------------------------------+
+| atomic_wait                             | c89atomic_wait_32                             |
+| atomic_wait_explicit                    | c89atomic_wait_explicit_32                    |
++-----------------------------------------+-----------------------------------------------+
+| atomic_notify_one                       | c89atomic_notify_one_32                       |
+| atomic_notify_all                       | c89atomic_notify_all_32                       |
++-----------------------------------------+-----------------------------------------------+
 | (Not Defined)                           | c89atomic_compare_and_swap_8                  |
 |                                         | c89atomic_compare_and_swap_16                 |
 |                                         | c89atomic_compare_and_swap_32                 |
@@ -280,6 +312,28 @@ typedef c89atomic_uint32        c89atomic_bool;
 #endif
 /* End Architecture Detection */
 
+/* Pointer Sized Types */
+#if defined(C89ATOMIC_64BIT)
+    typedef c89atomic_uint64    c89atomic_uintptr;
+    typedef c89atomic_int64     c89atomic_intptr;
+#else
+    typedef c89atomic_uint32    c89atomic_uintptr;
+    typedef c89atomic_int32     c89atomic_intptr;
+#endif
+/* End Pointer Sized Types */
+
+/* Cache Line Size */
+#ifndef C89ATOMIC_CACHE_LINE_SIZE
+    #if defined(C89ATOMIC_PPC64)
+    #define C89ATOMIC_CACHE_LINE_SIZE   128
+    #elif defined(__APPLE__) && defined(C89ATOMIC_ARM64) && defined(__ENVIRONMENT_MAC_OS_X_VERSION_MIN_REQUIRED)
+    #define C89ATOMIC_CACHE_LINE_SIZE   128
+    #else
+    #define C89ATOMIC_CACHE_LINE_SIZE   64
+    #endif
+#endif
+/* End Cache Line Size */
+
 /* Inline */
 /* We want to encourage the compiler to inline. When adding support for a new compiler, make sure it's handled here. */
 #if defined(_MSC_VER)
@@ -577,8 +631,22 @@ These functions are mandatory. If they cannot be implemented a compile time erro
 
     static C89ATOMIC_INLINE c89atomic_flag c89atomic_flag_load_explicit(volatile const c89atomic_flag* dst, c89atomic_memory_order order)
     {
-        (void)order;
-        return __sync_val_compare_and_swap((c89atomic_flag*)dst, 0, 0);
+        #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
+        {
+            /* x86 is strongly ordered so a plain load is enough. Don't use a compare-and-swap because that would take ownership of the cache line. */
+            c89atomic_flag result = *dst;
+            if (order != c89atomic_memory_order_relaxed) {
+                __asm__ __volatile__("" ::: "memory");
+            }
+
+            return result;
+        }
+        #else
+        {
+            (void)order;
+            return __sync_val_compare_and_swap((c89atomic_flag*)dst, 0, 0);
+        }
+        #endif
     }
 #endif
 
@@ -600,17 +668,30 @@ These functions are mandatory. If they cannot be implemented a compile time erro
     It looks like the SFENCE instruction was added in the Pentium III series, whereas the LFENCE and MFENCE instructions were added in
     the Pentium 4 series. It's not clear how this actually differs to a LOCK-prefixed instruction or an XCHG instruction with a memory
     operand. For simplicity and compatibility, I'm just using a LOCK-prefixed ADD instruction which adds 0 to the value pointed to by
-    the ESP register. The use of the ESP register is that it should theoretically have a high likelyhood to be in cache. For now, just
-    to keep things simple, this is always doing a full memory barrier which means the `order` parameter is ignored on x86/64.
+    the ESP register. The use of the ESP register is that it should theoretically have a high likelyhood to be in cache.
+
+    x86 is strongly ordered. The only reordering the CPU will do is to move a store after a later load to a different address, which
+    only matters for seq_cst. Acquire and release therefore only need to stop the compiler from reordering, and a relaxed fence does
+    nothing at all. This is also why loads and release stores below are just a MOV, and only seq_cst stores use XCHG.
     */
     #if defined(C89ATOMIC_X86)
-        #define c89atomic_thread_fence(order) __asm__ __volatile__("lock; addl $0, (%%esp)" ::: "memory")
+        #define C89ATOMIC_FENCE_SEQ_CST_GCC_X86() __asm__ __volatile__("lock; addl $0, (%%esp)" ::: "memory", "cc")
     #elif defined(C89ATOMIC_X64)
-        #define c89atomic_thread_fence(order) __asm__ __volatile__("lock; addq $0, (%%rsp)" ::: "memory")
+        #define C89ATOMIC_FENCE_SEQ_CST_GCC_X86() __asm__ __volatile__("lock; addq $0, (%%rsp)" ::: "memory", "cc")
     #else
         #error Unsupported architecture.
     #endif
 
+    static C89ATOMIC_INLINE void c89atomic_thread_fence(c89atomic_memory_order order)
+    {
+        /* The compiler should optimize this branch away because in practice the order is always specified as a constant. */
+        if (order == c89atomic_memory_order_seq_cst) {
+            C89ATOMIC_FENCE_SEQ_CST_GCC_X86();
+        } else if (order != c89atomic_memory_order_relaxed) {
+            __asm__ __volatile__("" ::: "memory");
+        }
+    }
+
 
     #define C89ATOMIC_XCHG_GCC_X86(instructionSizeSuffix, result, dst, src) \
         __asm__ __volatile__(                    \
@@ -630,8 +711,8 @@ These functions are mandatory. If they cannot be implemented a compile time erro
             : "m"(*dst)    /* %1 */             \
         )
 
-    #define C89ATOMIC_LOAD_RELEASE_GCC_X86(instructionSizeSuffix, result, dst) \
-        c89atomic_thread_fence(c89atomic_memory_order_release); \
+    /* Used for everything other than relaxed. The memory clobber stops the compiler from moving later accesses above the load. */
+    #define C89ATOMIC_LOAD_ACQUIRE_GCC_X86(instructionSizeSuffix, result, dst) \
         __asm__ __volatile__(                   \
             "mov"instructionSizeSuffix" %1, %0" \
             : "=r"(result) /* %0 */             \
@@ -639,15 +720,32 @@ These functions are mandatory. If they cannot be implemented a compile time erro
             : "memory"                          \
         )
 
-    #define C89ATOMIC_LOAD_SEQ_CST_GCC_X86(instructionSizeSuffix, result, dst) \
-        c89atomic_thread_fence(c89atomic_memory_order_seq_cst); \
+
+    #define C89ATOMIC_STORE_RELAXED_GCC_X86(instructionSizeSuffix, dst, src) \
         __asm__ __volatile__(                   \
             "mov"instructionSizeSuffix" %1, %0" \
-            : "=r"(result) /* %0 */             \
-            : "m"(*dst)    /* %1 */             \
+            : "=m"(*dst)   /* %0 */             \
+            : "r"(src)     /* %1 */             \
+        )
+
+    /* The memory clobber stops the compiler from moving earlier accesses below the store. */
+    #define C89ATOMIC_STORE_RELEASE_GCC_X86(instructionSizeSuffix, dst, src) \
+        __asm__ __volatile__(                   \
+            "mov"instructionSizeSuffix" %1, %0" \
+            : "=m"(*dst)   /* %0 */             \
+            : "r"(src)     /* %1 */             \
+            : "memory"                          \
+        )
+
+    /* XCHG with a memory operand is implicitly locked which gives us the full barrier required by seq_cst. */
+    #define C89ATOMIC_STORE_SEQ_CST_GCC_X86(instructionSizeSuffix, dst, src) \
+        __asm__ __volatile__(                   \
+            "xchg"instructionSizeSuffix" %1, %0" \
+            : "=m"(*dst),  /* %0 */             \
+              "+r"(src)    /* %1 */             \
+            :                                   \
             : "memory"                          \
-        );                                      \
-        c89atomic_thread_fence(c89atomic_memory_order_seq_cst)
+        )
 
 
     typedef c89atomic_uint32 c89atomic_flag;
@@ -672,29 +770,15 @@ These functions are mandatory. If they cannot be implemented a compile time erro
     {
         #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
         {
+            c89atomic_flag tmp = 0;
+
             /* The compiler should optimize this branch away because in practice the order is always specified as a constant. */
             if (order == c89atomic_memory_order_relaxed) {
-                __asm__ __volatile__(
-                    "movl $0, %0"
-                    : "=m"(*dst)    /* %0 */
-                );
-            } else if (order == c89atomic_memory_order_release) {
-                __asm__ __volatile__(
-                    "movl $0, %0"
-                    : "=m"(*dst)    /* %0 */
-                    :
-                    : "memory"
-                );
+                C89ATOMIC_STORE_RELAXED_GCC_X86("l", dst, tmp);
+            } else if (order != c89atomic_memory_order_seq_cst) {
+                C89ATOMIC_STORE_RELEASE_GCC_X86("l", dst, tmp);
             } else {
-                c89atomic_flag tmp = 0;
-                __asm__ __volatile__(
-                    "xchgl %0, %1"
-                    : "=r"(tmp),    /* %0 */
-                      "=m"(*dst)    /* %1 */
-                    : "0"(tmp),     /* %2 */
-                      "m"(*dst)     /* %3 */
-                    : "memory"
-                );
+                C89ATOMIC_STORE_SEQ_CST_GCC_X86("l", dst, tmp);
             }
         }
         #else
@@ -712,10 +796,8 @@ These functions are mandatory. If they cannot be implemented a compile time erro
 
             if (order == c89atomic_memory_order_relaxed) {
                 C89ATOMIC_LOAD_RELAXED_GCC_X86("l", result, dst);
-            } else if (order <= c89atomic_memory_order_release) {
-                C89ATOMIC_LOAD_RELEASE_GCC_X86("l", result, dst);
             } else {
-                C89ATOMIC_LOAD_SEQ_CST_GCC_X86("l", result, dst);
+                C89ATOMIC_LOAD_ACQUIRE_GCC_X86("l", result, dst);
             }
 
             return result;
@@ -768,6 +850,125 @@ These functions are mandatory. If they cannot be implemented a compile time erro
 #define c89atomic_flag_clear(dst)        c89atomic_flag_clear_explicit(dst, c89atomic_memory_order_release)
 /* END c89atomic_flag.h */
 
+/* BEG c89atomic_cpu_relax.h */
+/*
+c89atomic_cpu_relax() is a hint to the CPU that we're sitting in a spin-wait loop. On x86 this is the
+PAUSE instruction which stops the CPU from flooding the memory bus with speculative loads and gives
+the other hyper-thread on the same core a chance to run (which is quite possibly the lock holder).
+*/
+#if defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC)
+    #if defined(C89ATOMIC_X64) || defined(C89ATOMIC_X86)
+        #define c89atomic_cpu_relax()   _mm_pause()
+    #elif defined(C89ATOMIC_ARM)
+        #define c89atomic_cpu_relax()   __yield()
+    #else
+        #define c89atomic_cpu_relax()   _ReadWriteBarrier()
+    #endif
+#endif
+
+#if defined(C89ATOMIC_LEGACY_MSVC_ASM)
+    static C89ATOMIC_INLINE void c89atomic_cpu_relax(void)
+    {
+        /* REP NOP is the encoding of PAUSE. Older assemblers don't know about the PAUSE mnemonic, and older CPUs will just treat it as a NOP. */
+        __asm {
+            rep nop
+        }
+    }
+#endif
+
+#if defined(C89ATOMIC_MODERN_GCC) || defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)
+    #if defined(C89ATOMIC_X64) || defined(C89ATOMIC_X86)
+        /* Using "rep; nop" rather than "pause" for compatibility with old assemblers. It's the same encoding. */
+        #define c89atomic_cpu_relax()   __asm__ __volatile__("rep; nop" ::: "memory")
+    #elif defined(C89ATOMIC_ARM64)
+        /* YIELD is a NOP on most AArch64 implementations. ISB is what actually gives us a short delay. */
+        #define c89atomic_cpu_relax()   __asm__ __volatile__("isb" ::: "memory")
+    #elif defined(C89ATOMIC_ARM32) && defined(__ARM_ARCH) && __ARM_ARCH >= 7
+        #define c89atomic_cpu_relax()   __asm__ __volatile__("yield" ::: "memory")
+    #elif defined(C89ATOMIC_PPC64) || defined(C89ATOMIC_PPC32)
+        /* This is the "yield" hint for lowering the priority of the hardware thread. */
+        #define c89atomic_cpu_relax()   __asm__ __volatile__("or 27,27,27" ::: "memory")
+    #else
+        #define c89atomic_cpu_relax()   __asm__ __volatile__("" ::: "memory")
+    #endif
+#endif
+
+#if defined(C89ATOMIC_CHIBICC)
+    static C89ATOMIC_INLINE void c89atomic_cpu_relax(void)
+    {
+        asm("pause");
+    }
+#endif
+/* END c89atomic_cpu_relax.h */
+
+/* BEG c89atomic_backoff.h */
+/*
+A simple backoff policy for spin-wait loops. Each call to c89atomic_backoff_spin() executes twice as
+many relax hints as the previous call, up to `1 << C89ATOMIC_BACKOFF_SPIN_LIMIT`. This is what you
+want after a failed compare-and-swap.
+
+c89atomic_backoff_snooze() does the same thing, but once the spin limit is reached it'll start
+yielding the time slice with C89ATOMIC_YIELD() instead. This is what you want when you're waiting on
+another thread to do something, such as release a lock.
+
+By default C89ATOMIC_YIELD() just relaxes the CPU so that this file doesn't need to include any
+system headers. If you're on an operating system you'll want to plug in its yield by defining
+C89ATOMIC_YIELD() before including this file:
+
+    #include <sched.h>
+    #define C89ATOMIC_YIELD()   sched_yield()   // Or Sleep(0) or SwitchToThread() on Windows.
+*/
+#ifndef C89ATOMIC_BACKOFF_SPIN_LIMIT
+#define C89ATOMIC_BACKOFF_SPIN_LIMIT    6   /* Maximum of 2^6 = 64 relax hints per iteration. */
+#endif
+
+#ifndef C89ATOMIC_YIELD
+#define C89ATOMIC_YIELD()               c89atomic_cpu_relax()
+#endif
+
+typedef struct
+{
+    c89atomic_uint32 step;
+} c89atomic_backoff;
+
+static C89ATOMIC_INLINE void c89atomic_backoff_init(c89atomic_backoff* pBackoff)
+{
+    pBackoff->step = 0;
+}
+
+static C89ATOMIC_INLINE void c89atomic_backoff_spin(c89atomic_backoff* pBackoff)
+{
+    c89atomic_uint32 i;
+    c89atomic_uint32 count;
+
+    count = (c89atomic_uint32)1 << pBackoff->step;
+    for (i = 0; i < count; i += 1) {
+        c89atomic_cpu_relax();
+    }
+
+    if (pBackoff->step < C89ATOMIC_BACKOFF_SPIN_LIMIT) {
+        pBackoff->step += 1;
+    }
+}
+
+static C89ATOMIC_INLINE void c89atomic_backoff_snooze(c89atomic_backoff* pBackoff)
+{
+    if (pBackoff->step <= C89ATOMIC_BACKOFF_SPIN_LIMIT) {
+        c89atomic_uint32 i;
+        c89atomic_uint32 count;
+
+        count = (c89atomic_uint32)1 << pBackoff->step;
+        for (i = 0; i < count; i += 1) {
+            c89atomic_cpu_relax();
+        }
+
+        pBackoff->step += 1;
+    } else {
+        C89ATOMIC_YIELD();
+    }
+}
+/* END c89atomic_backoff.h */
+
 /* BEG c89atomic_spinlock.h */
 /*
 At this point we should have our c89atomic_flag type. We can now define our spinlock. With this
@@ -777,17 +978,30 @@ typedef c89atomic_flag c89atomic_spinlock;
 
 static C89ATOMIC_INLINE void c89atomic_spinlock_lock(volatile c89atomic_spinlock* pSpinlock)
 {
+    c89atomic_backoff backoff;
+    c89atomic_backoff_init(&backoff);
+
     for (;;) {
         if (c89atomic_flag_test_and_set_explicit(pSpinlock, c89atomic_memory_order_acquire) == 0) {
             break;
         }
 
         while (c89atomic_flag_load_explicit(pSpinlock, c89atomic_memory_order_relaxed) == 1) {
-            /* Do nothing. */
+            c89atomic_backoff_snooze(&backoff);
         }
     }
 }
 
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_spinlock_trylock(volatile c89atomic_spinlock* pSpinlock)
+{
+    /* Check first so a failed attempt doesn't take ownership of the cache line away from the owner. */
+    if (c89atomic_flag_load_explicit(pSpinlock, c89atomic_memory_order_relaxed) == 1) {
+        return 0;
+    }
+
+    return c89atomic_flag_test_and_set_explicit(pSpinlock, c89atomic_memory_order_acquire) == 0;
+}
+
 static C89ATOMIC_INLINE void c89atomic_spinlock_unlock(volatile c89atomic_spinlock* pSpinlock)
 {
     c89atomic_flag_clear_explicit(pSpinlock, c89atomic_memory_order_release);
@@ -795,7 +1009,71 @@ static C89ATOMIC_INLINE void c89atomic_spinlock_unlock(volatile c89atomic_spinlo
 /* END c89atomic_spinlock.h */
 
 /* BEG c89atomic_global_lock.h */
+/*
+Operations that can't be implemented natively are emulated with a spinlock. Rather than putting
+everything through one global lock, which would make unrelated atomics contend with each other, a
+table of cache-line-padded spinlocks is used and a lock is selected by hashing the address of the
+object. Objects sitting in the same 64 byte block always map to the same lock which means overlapping
+objects of different sizes are still protected by the same lock.
+
+If you define c89atomic_global_lock yourself rather than using c89atomic.c you can define
+C89ATOMIC_USE_GLOBAL_LOCK to get the old behaviour where all emulated operations share that lock.
+
+Each entry in the table is a seqlock. When 32-bit atomics are native but 64-bit atomics are not,
+emulated 64-bit writes bump the sequence number while holding the lock. This lets 64-bit loads read
+the value without writing to shared memory. See c89atomic_seqlock for details.
+*/
+#ifndef C89ATOMIC_LOCK_TABLE_SIZE
+#define C89ATOMIC_LOCK_TABLE_SIZE   64  /* Must be a power of 2. */
+#endif
+
+/* The seqlock functions are defined further down once the 32-bit atomics are available. */
+typedef struct
+{
+    c89atomic_spinlock lock;        /* Held by writers. */
+    c89atomic_uint32 sequence;      /* Odd while a write is in progress. */
+} c89atomic_seqlock;
+
+/* Aligned as well as padded so that the table itself starts on a cache line and neighbouring entries never share one. */
+#if defined(_MSC_VER)
+    typedef __declspec(align(C89ATOMIC_CACHE_LINE_SIZE)) struct
+    {
+        c89atomic_seqlock seqlock;
+        c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_seqlock)];
+    } c89atomic_lock_table_entry;
+#elif defined(__GNUC__)
+    typedef struct
+    {
+        c89atomic_seqlock seqlock;
+        c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_seqlock)];
+    } __attribute__((aligned(C89ATOMIC_CACHE_LINE_SIZE))) c89atomic_lock_table_entry;
+#else
+    typedef struct
+    {
+        c89atomic_seqlock seqlock;
+        c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_seqlock)];
+    } c89atomic_lock_table_entry;
+#endif
+
 extern c89atomic_spinlock c89atomic_global_lock;
+
+#if !defined(C89ATOMIC_USE_GLOBAL_LOCK)
+extern c89atomic_lock_table_entry c89atomic_lock_table[C89ATOMIC_LOCK_TABLE_SIZE];
+#endif
+
+/*
+This is a macro rather than an inline function so that nothing references the lock table unless an
+emulated operation is actually used. Otherwise c89atomic.c would be required even on platforms that
+don't need it with compilers that don't do inlining.
+*/
+#define C89ATOMIC_ADDRESS_HASH(ptr) ((((c89atomic_uintptr)(ptr)) >> 6) ^ (((c89atomic_uintptr)(ptr)) >> 16))
+
+#if defined(C89ATOMIC_USE_GLOBAL_LOCK)
+    #define c89atomic_get_address_lock(ptr) (&c89atomic_global_lock)
+#else
+    #define c89atomic_get_address_seqlock(ptr) (&c89atomic_lock_table[C89ATOMIC_ADDRESS_HASH(ptr) & (C89ATOMIC_LOCK_TABLE_SIZE - 1)].seqlock)
+    #define c89atomic_get_address_lock(ptr)    (&c89atomic_get_address_seqlock(ptr)->lock)
+#endif
 /* END c89atomic_global_lock.h */
 
 
@@ -809,7 +1087,21 @@ Some code paths have their own implementation of these functions in which case t
 not represented here.
 */
 #if defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC) || defined(C89ATOMIC_LEGACY_MSVC_ASM) || defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)
-    #if defined(C89ATOMIC_X64) || (defined(C89ATOMIC_X86) && ((defined(__GNUC__) && defined(__i486__)) || (defined(_M_IX86) && _M_IX86 >= 400)))  /* 400 = i486 */
+    /*
+    GCC only defines the macro for the exact -march being targeted so __i486__ is not defined when
+    targeting i586 and above. Newer versions of GCC tell us directly which sizes of CMPXCHG are
+    available, but for older versions we need to check the common targets explicitly.
+    */
+    #if defined(C89ATOMIC_X86) && defined(__GNUC__)
+        #if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8) || defined(__i586__) || defined(__i686__) || defined(__pentium4__) || defined(__k6__) || defined(__athlon__) || defined(__nocona__) || defined(__core2__)
+            #define C89ATOMIC_X86_HAS_CMPXCHG8B
+        #endif
+        #if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) || defined(__i486__) || defined(C89ATOMIC_X86_HAS_CMPXCHG8B)
+            #define C89ATOMIC_X86_HAS_CMPXCHG
+        #endif
+    #endif
+
+    #if defined(C89ATOMIC_X64) || (defined(C89ATOMIC_X86) && (defined(C89ATOMIC_X86_HAS_CMPXCHG) || (defined(_M_IX86) && _M_IX86 >= 400)))  /* 400 = i486 */
         #if defined(C89ATOMIC_LEGACY_MSVC) && defined(C89ATOMIC_X64)
             /* 64-bit builds on old MSVC do not have access to 8- and 16- bit atomic intrinsics nor an inline assembly. */
         #else
@@ -817,7 +1109,7 @@ not represented here.
             #define C89ATOMIC_IS_LOCK_FREE_16 1
         #endif
         #define C89ATOMIC_IS_LOCK_FREE_32     1
-        #if defined(C89ATOMIC_X64) || (defined(C89ATOMIC_X86) && ((defined(__GNUC__) && defined(__i586__)) || (defined(_M_IX86) && _M_IX86 >= 500)))  /* 500 = i586 (Pentium) */
+        #if defined(C89ATOMIC_X64) || (defined(C89ATOMIC_X86) && (defined(C89ATOMIC_X86_HAS_CMPXCHG8B) || (defined(_M_IX86) && _M_IX86 >= 500)))  /* 500 = i586 (Pentium) */
             #define C89ATOMIC_IS_LOCK_FREE_64 1
         #else
             /* 64-bit atomics cannot be lock-free on i486 and below because it lacks CMPXCHG8B. */
@@ -899,84 +1191,206 @@ not represented here.
 #endif
 
 
+/*
+C89ATOMIC_ALWAYS_LOCK_FREE_* are always defined to either 0 or 1 and can be used with #if to select
+an algorithm at compile time. These assume the object is naturally aligned. When one of these is 0 it
+does not necessarily mean the operation will use a lock, just that it can't be known at compile time.
+In that case use c89atomic_is_lock_free_*() to check at run time.
+*/
+#if defined(C89ATOMIC_MODERN_GCC)
+    #if defined(__GCC_ATOMIC_CHAR_LOCK_FREE) && __GCC_ATOMIC_CHAR_LOCK_FREE == 2
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_8    1
+    #endif
+    #if defined(__GCC_ATOMIC_SHORT_LOCK_FREE) && __GCC_ATOMIC_SHORT_LOCK_FREE == 2
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_16   1
+    #endif
+    #if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_32   1
+    #endif
+    #if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_64   1
+    #endif
+#elif defined(C89ATOMIC_CHIBICC)
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_8        1
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_16       1
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_32       1
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_64       1
+#else
+    #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_8    1
+    #endif
+    #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_16   1
+    #endif
+    #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_32   1
+    #endif
+    #if defined(C89ATOMIC_IS_LOCK_FREE_64)
+        #define C89ATOMIC_ALWAYS_LOCK_FREE_64   1
+    #endif
+#endif
+
+#ifndef C89ATOMIC_ALWAYS_LOCK_FREE_8
+#define C89ATOMIC_ALWAYS_LOCK_FREE_8            0
+#endif
+#ifndef C89ATOMIC_ALWAYS_LOCK_FREE_16
+#define C89ATOMIC_ALWAYS_LOCK_FREE_16           0
+#endif
+#ifndef C89ATOMIC_ALWAYS_LOCK_FREE_32
+#define C89ATOMIC_ALWAYS_LOCK_FREE_32           0
+#endif
+#ifndef C89ATOMIC_ALWAYS_LOCK_FREE_64
+#define C89ATOMIC_ALWAYS_LOCK_FREE_64           0
+#endif
+
+#if defined(C89ATOMIC_64BIT)
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_PTR      C89ATOMIC_ALWAYS_LOCK_FREE_64
+#else
+    #define C89ATOMIC_ALWAYS_LOCK_FREE_PTR      C89ATOMIC_ALWAYS_LOCK_FREE_32
+#endif
+
+
+/*
+When 32-bit atomics are native but 64-bit atomics need to be emulated, 64-bit loads use the seqlock in
+the lock table rather than taking the lock. This means readers never write to shared memory. For this
+to work, every emulated 64-bit write needs to bump the sequence number while it holds the lock which is
+what the C89ATOMIC_SEQLOCK_WRITE_BEGIN/END_* macros are for. These do nothing for the other sizes.
+*/
+#if !defined(C89ATOMIC_USE_GLOBAL_LOCK) && defined(C89ATOMIC_IS_LOCK_FREE_32) && !defined(C89ATOMIC_IS_LOCK_FREE_64)
+    #define C89ATOMIC_SEQLOCK_LOAD_64
+#endif
+
+#if defined(C89ATOMIC_SEQLOCK_LOAD_64)
+    static C89ATOMIC_INLINE void c89atomic_seqlock_write_begin_locked(c89atomic_seqlock* pSeqlock);
+    static C89ATOMIC_INLINE void c89atomic_seqlock_write_end_locked(c89atomic_seqlock* pSeqlock);
+    static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_seqlock_load_explicit_64(volatile const c89atomic_uint64* ptr, c89atomic_memory_order order);
+
+    #define C89ATOMIC_SEQLOCK_WRITE_BEGIN_64(ptr)           c89atomic_seqlock_write_begin_locked(c89atomic_get_address_seqlock(ptr))
+    #define C89ATOMIC_SEQLOCK_WRITE_END_64(ptr)             c89atomic_seqlock_write_end_locked(c89atomic_get_address_seqlock(ptr))
+    #define C89ATOMIC_LOAD_EXPLICIT_LOCK_64(ptr, order)     return c89atomic_seqlock_load_explicit_64(ptr, order)
+#else
+    #define C89ATOMIC_SEQLOCK_WRITE_BEGIN_64(ptr)
+    #define C89ATOMIC_SEQLOCK_WRITE_END_64(ptr)
+    #define C89ATOMIC_LOAD_EXPLICIT_LOCK_64(ptr, order)     C89ATOMIC_LOAD_EXPLICIT_LOCK(64, ptr, order)
+#endif
+
+#define C89ATOMIC_SEQLOCK_WRITE_BEGIN_8(ptr)
+#define C89ATOMIC_SEQLOCK_WRITE_END_8(ptr)
+#define C89ATOMIC_SEQLOCK_WRITE_BEGIN_16(ptr)
+#define C89ATOMIC_SEQLOCK_WRITE_END_16(ptr)
+#define C89ATOMIC_SEQLOCK_WRITE_BEGIN_32(ptr)
+#define C89ATOMIC_SEQLOCK_WRITE_END_32(ptr)
+
+
 #define C89ATOMIC_COMPARE_AND_SWAP_LOCK(sizeInBits, dst, expected, replacement) \
     c89atomic_uint##sizeInBits result; \
-    c89atomic_spinlock_lock(&c89atomic_global_lock); \
+    volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(dst); \
+    c89atomic_spinlock_lock(pLock); \
     { \
         result = *dst; \
         if (result == expected) { \
+            C89ATOMIC_SEQLOCK_WRITE_BEGIN_##sizeInBits(dst); \
             *dst = replacement; \
+            C89ATOMIC_SEQLOCK_WRITE_END_##sizeInBits(dst); \
         } \
     } \
-    c89atomic_spinlock_unlock(&c89atomic_global_lock); \
+    c89atomic_spinlock_unlock(pLock); \
     return result
 
 
 #define C89ATOMIC_LOAD_EXPLICIT_LOCK(sizeInBits, ptr, order) \
     c89atomic_uint##sizeInBits result; \
-    c89atomic_spinlock_lock(&c89atomic_global_lock); \
+    volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(ptr); \
+    c89atomic_spinlock_lock(pLock); \
     { \
         result = *ptr; \
         (void)order; \
     } \
-    c89atomic_spinlock_unlock(&c89atomic_global_lock); \
+    c89atomic_spinlock_unlock(pLock); \
     return result
 
 
 #define C89ATOMIC_STORE_EXPLICIT_LOCK(sizeInBits, dst, src, order) \
-    c89atomic_spinlock_lock(&c89atomic_global_lock); \
+    volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(dst); \
+    c89atomic_spinlock_lock(pLock); \
     { \
+        C89ATOMIC_SEQLOCK_WRITE_BEGIN_##sizeInBits(dst); \
         *dst = src; \
+        C89ATOMIC_SEQLOCK_WRITE_END_##sizeInBits(dst); \
         (void)order; \
     } \
-    c89atomic_spinlock_unlock(&c89atomic_global_lock)
+    c89atomic_spinlock_unlock(pLock)
 
 #define C89ATOMIC_STORE_EXPLICIT_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, src) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, src) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order
 
 
 #define C89ATOMIC_EXCHANGE_EXPLICIT_LOCK(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits result; \
-    c89atomic_spinlock_lock(&c89atomic_global_lock); \
+    volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(dst); \
+    c89atomic_spinlock_lock(pLock); \
     { \
         result = *dst; \
+        C89ATOMIC_SEQLOCK_WRITE_BEGIN_##sizeInBits(dst); \
         *dst = src; \
+        C89ATOMIC_SEQLOCK_WRITE_END_##sizeInBits(dst); \
         (void)order; \
     } \
-    c89atomic_spinlock_unlock(&c89atomic_global_lock); \
+    c89atomic_spinlock_unlock(pLock); \
     return result
 
 #define C89ATOMIC_EXCHANGE_EXPLICIT_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, src) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, src) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order; \
     return oldValue
 
 
 #define C89ATOMIC_FETCH_ADD_LOCK(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits result; \
-    c89atomic_spinlock_lock(&c89atomic_global_lock); \
+    volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(dst); \
+    c89atomic_spinlock_lock(pLock); \
     { \
         result = *dst; \
+        C89ATOMIC_SEQLOCK_WRITE_BEGIN_##sizeInBits(dst); \
         *dst += src; \
+        C89ATOMIC_SEQLOCK_WRITE_END_##sizeInBits(dst); \
         (void)order; \
     } \
-    c89atomic_spinlock_unlock(&c89atomic_global_lock); \
+    c89atomic_spinlock_unlock(pLock); \
     return result
 
 #define C89ATOMIC_FETCH_ADD_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
     c89atomic_uint##sizeInBits newValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
         newValue = oldValue + src; \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order; \
     return oldValue
 
@@ -984,10 +1398,16 @@ not represented here.
 #define C89ATOMIC_FETCH_AND_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
     c89atomic_uint##sizeInBits newValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
         newValue = (c89atomic_uint##sizeInBits)(oldValue & src); \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order; \
     return oldValue
 
@@ -995,10 +1415,16 @@ not represented here.
 #define C89ATOMIC_FETCH_OR_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
     c89atomic_uint##sizeInBits newValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
         newValue = (c89atomic_uint##sizeInBits)(oldValue | src); \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order; \
     return oldValue
 
@@ -1006,10 +1432,16 @@ not represented here.
 #define C89ATOMIC_FETCH_XOR_CAS(sizeInBits, dst, src, order) \
     c89atomic_uint##sizeInBits oldValue; \
     c89atomic_uint##sizeInBits newValue; \
-    do { \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    for (;;) { \
         oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
         newValue = (c89atomic_uint##sizeInBits)(oldValue ^ src); \
-    } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) != oldValue); \
+        if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) == oldValue) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
     (void)order; \
     return oldValue
 
@@ -1718,27 +2150,16 @@ not represented here.
         {
             c89atomic_uint8 result = 0;
 
-            if (order == c89atomic_memory_order_relaxed) {
-                __asm {
-                    mov esi, dst
-                    mov al, [esi]
-                    mov result, al
-                }
-            } else if (order <= c89atomic_memory_order_release) {
-                __asm {
-                    mov esi, dst
-                    mov al, [esi]
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov result, al
-                }
-            } else {
-                __asm {
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov esi, dst
-                    mov al, [esi]
-                    mov result, al
-                    lock add dword ptr [esp], 0 /* fence. */
-                }
+            /*
+            x86 does not reorder loads with other loads, nor stores with earlier loads, so a plain mov is
+            enough for every memory order. seq_cst is taken care of by stores which use XCHG. The compiler
+            will not move memory accesses across an __asm block.
+            */
+            (void)order;
+            __asm {
+                mov esi, dst
+                mov al, [esi]
+                mov result, al
             }
 
             return result;
@@ -1756,27 +2177,16 @@ not represented here.
         {
             c89atomic_uint16 result = 0;
 
-            if (order == c89atomic_memory_order_relaxed) {
-                __asm {
-                    mov esi, dst
-                    mov ax, [esi]
-                    mov result, ax
-                }
-            } else if (order <= c89atomic_memory_order_release) {
-                __asm {
-                    mov esi, dst
-                    mov ax, [esi]
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov result, ax
-                }
-            } else {
-                __asm {
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov esi, dst
-                    mov ax, [esi]
-                    mov result, ax
-                    lock add dword ptr [esp], 0 /* fence. */
-                }
+            /*
+            x86 does not reorder loads with other loads, nor stores with earlier loads, so a plain mov is
+            enough for every memory order. seq_cst is taken care of by stores which use XCHG. The compiler
+            will not move memory accesses across an __asm block.
+            */
+            (void)order;
+            __asm {
+                mov esi, dst
+                mov ax, [esi]
+                mov result, ax
             }
 
             return result;
@@ -1794,27 +2204,16 @@ not represented here.
         {
             c89atomic_uint32 result = 0;
 
-            if (order == c89atomic_memory_order_relaxed) {
-                __asm {
-                    mov esi, dst
-                    mov eax, [esi]
-                    mov result, eax
-                }
-            } else if (order <= c89atomic_memory_order_release) {
-                __asm {
-                    mov esi, dst
-                    mov eax, [esi]
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov result, eax
-                }
-            } else {
-                __asm {
-                    lock add dword ptr [esp], 0 /* fence. */
-                    mov esi, dst
-                    mov eax, [esi]
-                    mov result, eax
-                    lock add dword ptr [esp], 0 /* fence. */
-                }
+            /*
+            x86 does not reorder loads with other loads, nor stores with earlier loads, so a plain mov is
+            enough for every memory order. seq_cst is taken care of by stores which use XCHG. The compiler
+            will not move memory accesses across an __asm block.
+            */
+            (void)order;
+            __asm {
+                mov esi, dst
+                mov eax, [esi]
+                mov result, eax
             }
 
             return result;
@@ -1828,8 +2227,16 @@ not represented here.
 
     static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_load_explicit_64(volatile const c89atomic_uint64* dst, c89atomic_memory_order order)
     {
-        (void)order;
-        return c89atomic_compare_and_swap_64((volatile c89atomic_uint64*)dst, 0, 0);
+        #if defined(C89ATOMIC_SEQLOCK_LOAD_64)
+        {
+            C89ATOMIC_LOAD_EXPLICIT_LOCK_64(dst, order);
+        }
+        #else
+        {
+            (void)order;
+            return c89atomic_compare_and_swap_64((volatile c89atomic_uint64*)dst, 0, 0);
+        }
+        #endif
     }
 
 
@@ -1846,10 +2253,19 @@ not represented here.
         } else {
             #if defined(C89ATOMIC_IS_LOCK_FREE_8)
             {
-                __asm {
-                    mov esi, dst
-                    mov al, src
-                    xchg [esi], al
+                /* x86 does not reorder stores with earlier loads or stores so only seq_cst needs the implicit lock of XCHG. */
+                if (order == c89atomic_memory_order_seq_cst) {
+                    __asm {
+                        mov esi, dst
+                        mov al, src
+                        xchg [esi], al
+                    }
+                } else {
+                    __asm {
+                        mov esi, dst
+                        mov al, src
+                        mov [esi], al
+                    }
                 }
             }
             #else
@@ -1872,10 +2288,19 @@ not represented here.
         } else {
             #if defined(C89ATOMIC_IS_LOCK_FREE_16)
             {
-                __asm {
-                    mov esi, dst
-                    mov ax, src
-                    xchg [esi], ax
+                /* x86 does not reorder stores with earlier loads or stores so only seq_cst needs the implicit lock of XCHG. */
+                if (order == c89atomic_memory_order_seq_cst) {
+                    __asm {
+                        mov esi, dst
+                        mov ax, src
+                        xchg [esi], ax
+                    }
+                } else {
+                    __asm {
+                        mov esi, dst
+                        mov ax, src
+                        mov [esi], ax
+                    }
                 }
             }
             #else
@@ -1898,10 +2323,19 @@ not represented here.
         } else {
             #if defined(C89ATOMIC_IS_LOCK_FREE_32)
             {
-                __asm {
-                    mov esi, dst
-                    mov eax, src
-                    xchg [esi], eax
+                /* x86 does not reorder stores with earlier loads or stores so only seq_cst needs the implicit lock of XCHG. */
+                if (order == c89atomic_memory_order_seq_cst) {
+                    __asm {
+                        mov esi, dst
+                        mov eax, src
+                        xchg [esi], eax
+                    }
+                } else {
+                    __asm {
+                        mov esi, dst
+                        mov eax, src
+                        mov [esi], eax
+                    }
                 }
             }
             #else
@@ -2239,9 +2673,16 @@ not represented here.
     /* atomic_thread_fence */
     static C89ATOMIC_INLINE void __stdcall c89atomic_thread_fence(c89atomic_memory_order order)
     {
-        (void)order;
-        __asm {
-            lock add dword ptr [esp], 0
+        /*
+        The only reordering x86 does is a store with a later load which only matters for seq_cst. For
+        everything else we just need to stop the compiler, which an __asm block does for us.
+        */
+        if (order == c89atomic_memory_order_seq_cst) {
+            __asm {
+                lock add dword ptr [esp], 0
+            }
+        } else if (order != c89atomic_memory_order_relaxed) {
+            __asm {}
         }
     }
 
@@ -2255,10 +2696,11 @@ not represented here.
     #define c89atomic_thread_fence(order)                           __atomic_thread_fence(order)
     #define c89atomic_signal_fence(order)                           __atomic_signal_fence(order)
 
-    #define c89atomic_is_lock_free_8(ptr)                           __atomic_is_lock_free(1, ptr)
-    #define c89atomic_is_lock_free_16(ptr)                          __atomic_is_lock_free(2, ptr)
-    #define c89atomic_is_lock_free_32(ptr)                          __atomic_is_lock_free(4, ptr)
-    #define c89atomic_is_lock_free_64(ptr)                          __atomic_is_lock_free(8, ptr)
+    /* __atomic_is_lock_free() can be a call into libatomic so avoid it when we already know the answer. */
+    #define c89atomic_is_lock_free_8(ptr)                           (C89ATOMIC_ALWAYS_LOCK_FREE_8  || __atomic_is_lock_free(1, ptr))
+    #define c89atomic_is_lock_free_16(ptr)                          (C89ATOMIC_ALWAYS_LOCK_FREE_16 || __atomic_is_lock_free(2, ptr))
+    #define c89atomic_is_lock_free_32(ptr)                          (C89ATOMIC_ALWAYS_LOCK_FREE_32 || __atomic_is_lock_free(4, ptr))
+    #define c89atomic_is_lock_free_64(ptr)                          (C89ATOMIC_ALWAYS_LOCK_FREE_64 || __atomic_is_lock_free(8, ptr))
 
     #define c89atomic_store_explicit_8( dst, src, order)            __atomic_store_n(dst, src, order)
     #define c89atomic_store_explicit_16(dst, src, order)            __atomic_store_n(dst, src, order)
@@ -2362,8 +2804,31 @@ not represented here.
     #define c89atomic_signal_fence(order)   __asm__ __volatile__("":::"memory")
 
     #if defined(C89ATOMIC_LEGACY_GCC)
-        /* Legacy GCC atomic built-ins. Everything is a full memory barrier. */
-        #define c89atomic_thread_fence(order) __sync_synchronize(), (void)order
+        /*
+        Legacy GCC atomic built-ins. Everything is a full memory barrier.
+
+        The exception is x86 which is strongly ordered. On x86 the only reordering the CPU will do is to
+        move a store after a later load, which only matters for seq_cst. Everything else only needs to
+        stop the compiler from reordering which is what c89atomic_signal_fence() does. This lets us use
+        a plain MOV for loads and for anything other than seq_cst stores.
+        */
+        static C89ATOMIC_INLINE void c89atomic_thread_fence(c89atomic_memory_order order)
+        {
+            #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
+            {
+                if (order == c89atomic_memory_order_seq_cst) {
+                    __sync_synchronize();
+                } else if (order != c89atomic_memory_order_relaxed) {
+                    c89atomic_signal_fence(order);
+                }
+            }
+            #else
+            {
+                (void)order;
+                __sync_synchronize();
+            }
+            #endif
+        }
 
 
         /* compare_and_swap() */
@@ -2420,10 +2885,28 @@ not represented here.
         }
 
 
-        /* Atomic loads can be implemented in terms of a compare-and-swap. Need to implement as functions to silence warnings about `order` being unused. */
+        /*
+        Atomic loads can be implemented in terms of a compare-and-swap. That's a locked write though, which
+        takes exclusive ownership of the cache line, so on x86 we use a plain aligned load instead.
+        */
+        #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
+            #define C89ATOMIC_LOAD_EXPLICIT_GCC_X86(type, ptr, order) \
+            {                                                       \
+                type result = *ptr;                                 \
+                if (order != c89atomic_memory_order_relaxed) {      \
+                    c89atomic_signal_fence(order);                  \
+                }                                                   \
+                return result;                                      \
+            }
+        #endif
+
         static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_load_explicit_8(volatile const c89atomic_uint8* ptr, c89atomic_memory_order order)
         {
-            #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+            #if defined(C89ATOMIC_IS_LOCK_FREE_8) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_LOAD_EXPLICIT_GCC_X86(c89atomic_uint8, ptr, order);
+            }
+            #elif defined(C89ATOMIC_IS_LOCK_FREE_8)
             {
                 (void)order;    /* Always using the strongest memory order. */
                 return c89atomic_compare_and_swap_8((c89atomic_uint8*)ptr, 0, 0);
@@ -2437,7 +2920,11 @@ not represented here.
 
         static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_load_explicit_16(volatile const c89atomic_uint16* ptr, c89atomic_memory_order order)
         {
-            #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+            #if defined(C89ATOMIC_IS_LOCK_FREE_16) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_LOAD_EXPLICIT_GCC_X86(c89atomic_uint16, ptr, order);
+            }
+            #elif defined(C89ATOMIC_IS_LOCK_FREE_16)
             {
                 (void)order;    /* Always using the strongest memory order. */
                 return c89atomic_compare_and_swap_16((c89atomic_uint16*)ptr, 0, 0);
@@ -2451,7 +2938,11 @@ not represented here.
 
         static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_load_explicit_32(volatile const c89atomic_uint32* ptr, c89atomic_memory_order order)
         {
-            #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+            #if defined(C89ATOMIC_IS_LOCK_FREE_32) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_LOAD_EXPLICIT_GCC_X86(c89atomic_uint32, ptr, order);
+            }
+            #elif defined(C89ATOMIC_IS_LOCK_FREE_32)
             {
                 (void)order;    /* Always using the strongest memory order. */
                 return c89atomic_compare_and_swap_32((c89atomic_uint32*)ptr, 0, 0);
@@ -2465,14 +2956,18 @@ not represented here.
 
         static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_load_explicit_64(volatile const c89atomic_uint64* ptr, c89atomic_memory_order order)
         {
-            #if defined(C89ATOMIC_IS_LOCK_FREE_64)
+            #if defined(C89ATOMIC_IS_LOCK_FREE_64) && (defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_LOAD_EXPLICIT_GCC_X86(c89atomic_uint64, ptr, order);
+            }
+            #elif defined(C89ATOMIC_IS_LOCK_FREE_64)
             {
                 (void)order;    /* Always using the strongest memory order. */
                 return c89atomic_compare_and_swap_64((c89atomic_uint64*)ptr, 0, 0);
             }
             #else
             {
-                C89ATOMIC_LOAD_EXPLICIT_LOCK(64, ptr, order);
+                C89ATOMIC_LOAD_EXPLICIT_LOCK_64(ptr, order);
             }
             #endif
         }
@@ -2550,10 +3045,74 @@ not represented here.
 
 
         /* store() */
-        #define c89atomic_store_explicit_8( dst, src, order) (void)c89atomic_exchange_explicit_8 (dst, src, order)
-        #define c89atomic_store_explicit_16(dst, src, order) (void)c89atomic_exchange_explicit_16(dst, src, order)
-        #define c89atomic_store_explicit_32(dst, src, order) (void)c89atomic_exchange_explicit_32(dst, src, order)
-        #define c89atomic_store_explicit_64(dst, src, order) (void)c89atomic_exchange_explicit_64(dst, src, order)
+        #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
+            /*
+            Only seq_cst needs a locked instruction. __sync_lock_test_and_set() compiles to XCHG which is
+            implicitly locked, but it's only documented as an acquire barrier as far as the compiler is
+            concerned so it needs a compiler barrier in front of it.
+            */
+            #define C89ATOMIC_STORE_EXPLICIT_GCC_X86(dst, src, order)  \
+            {                                                       \
+                c89atomic_signal_fence(order);                      \
+                if (order == c89atomic_memory_order_seq_cst) {      \
+                    (void)__sync_lock_test_and_set(dst, src);       \
+                } else {                                            \
+                    *dst = src;                                     \
+                }                                                   \
+            }
+        #endif
+
+        static C89ATOMIC_INLINE void c89atomic_store_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+        {
+            #if defined(C89ATOMIC_IS_LOCK_FREE_8) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_STORE_EXPLICIT_GCC_X86(dst, src, order);
+            }
+            #else
+            {
+                (void)c89atomic_exchange_explicit_8(dst, src, order);
+            }
+            #endif
+        }
+
+        static C89ATOMIC_INLINE void c89atomic_store_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+        {
+            #if defined(C89ATOMIC_IS_LOCK_FREE_16) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_STORE_EXPLICIT_GCC_X86(dst, src, order);
+            }
+            #else
+            {
+                (void)c89atomic_exchange_explicit_16(dst, src, order);
+            }
+            #endif
+        }
+
+        static C89ATOMIC_INLINE void c89atomic_store_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+        {
+            #if defined(C89ATOMIC_IS_LOCK_FREE_32) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_STORE_EXPLICIT_GCC_X86(dst, src, order);
+            }
+            #else
+            {
+                (void)c89atomic_exchange_explicit_32(dst, src, order);
+            }
+            #endif
+        }
+
+        static C89ATOMIC_INLINE void c89atomic_store_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+        {
+            #if defined(C89ATOMIC_IS_LOCK_FREE_64) && (defined(C89ATOMIC_X64))
+            {
+                C89ATOMIC_STORE_EXPLICIT_GCC_X86(dst, src, order);
+            }
+            #else
+            {
+                (void)c89atomic_exchange_explicit_64(dst, src, order);
+            }
+            #endif
+        }
 
 
         /* fetch_add() */
@@ -2995,10 +3554,8 @@ not represented here.
                 {
                     if (order == c89atomic_memory_order_relaxed) {
                         C89ATOMIC_LOAD_RELAXED_GCC_X86("b", result, dst);
-                    } else if (order <= c89atomic_memory_order_release) {
-                        C89ATOMIC_LOAD_RELEASE_GCC_X86("b", result, dst);
                     } else {
-                        C89ATOMIC_LOAD_SEQ_CST_GCC_X86("b", result, dst);
+                        C89ATOMIC_LOAD_ACQUIRE_GCC_X86("b", result, dst);
                     }
                 }
                 #else
@@ -3024,10 +3581,8 @@ not represented here.
                 {
                     if (order == c89atomic_memory_order_relaxed) {
                         C89ATOMIC_LOAD_RELAXED_GCC_X86("w", result, dst);
-                    } else if (order <= c89atomic_memory_order_release) {
-                        C89ATOMIC_LOAD_RELEASE_GCC_X86("w", result, dst);
                     } else {
-                        C89ATOMIC_LOAD_SEQ_CST_GCC_X86("w", result, dst);
+                        C89ATOMIC_LOAD_ACQUIRE_GCC_X86("w", result, dst);
                     }
                 }
                 #else
@@ -3053,10 +3608,8 @@ not represented here.
                 {
                     if (order == c89atomic_memory_order_relaxed) {
                         C89ATOMIC_LOAD_RELAXED_GCC_X86("l", result, dst);
-                    } else if (order <= c89atomic_memory_order_release) {
-                        C89ATOMIC_LOAD_RELEASE_GCC_X86("l", result, dst);
                     } else {
-                        C89ATOMIC_LOAD_SEQ_CST_GCC_X86("l", result, dst);
+                        C89ATOMIC_LOAD_ACQUIRE_GCC_X86("l", result, dst);
                     }
                 }
                 #else
@@ -3082,10 +3635,8 @@ not represented here.
                 {
                     if (order == c89atomic_memory_order_relaxed) {
                         C89ATOMIC_LOAD_RELAXED_GCC_X86("q", result, dst);
-                    } else if (order <= c89atomic_memory_order_release) {
-                        C89ATOMIC_LOAD_RELEASE_GCC_X86("q", result, dst);
                     } else {
-                        C89ATOMIC_LOAD_SEQ_CST_GCC_X86("q", result, dst);
+                        C89ATOMIC_LOAD_ACQUIRE_GCC_X86("q", result, dst);
                     }
                 }
                 #elif defined(C89ATOMIC_X86)
@@ -3102,7 +3653,7 @@ not represented here.
             }
             #else
             {
-                C89ATOMIC_LOAD_EXPLICIT_LOCK(64, dst, order);
+                C89ATOMIC_LOAD_EXPLICIT_LOCK_64(dst, order);
             }
             #endif
         }
@@ -3218,18 +3769,11 @@ not represented here.
                 #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
                 {
                     if (order == c89atomic_memory_order_relaxed) {
-                        __asm__ __volatile__ (
-                            "movb %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                        );
+                        C89ATOMIC_STORE_RELAXED_GCC_X86("b", dst, src);
+                    } else if (order != c89atomic_memory_order_seq_cst) {
+                        C89ATOMIC_STORE_RELEASE_GCC_X86("b", dst, src);
                     } else {
-                        __asm__ __volatile__ (
-                            "xchgb %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                            : "memory"
-                        );
+                        C89ATOMIC_STORE_SEQ_CST_GCC_X86("b", dst, src);
                     }
                 }
                 #else
@@ -3252,18 +3796,11 @@ not represented here.
                 #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
                 {
                     if (order == c89atomic_memory_order_relaxed) {
-                        __asm__ __volatile__ (
-                            "movw %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                        );
+                        C89ATOMIC_STORE_RELAXED_GCC_X86("w", dst, src);
+                    } else if (order != c89atomic_memory_order_seq_cst) {
+                        C89ATOMIC_STORE_RELEASE_GCC_X86("w", dst, src);
                     } else {
-                        __asm__ __volatile__ (
-                            "xchgw %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                            : "memory"
-                        );
+                        C89ATOMIC_STORE_SEQ_CST_GCC_X86("w", dst, src);
                     }
                 }
                 #else
@@ -3286,18 +3823,11 @@ not represented here.
                 #if defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64)
                 {
                     if (order == c89atomic_memory_order_relaxed) {
-                        __asm__ __volatile__ (
-                            "movl %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                        );
+                        C89ATOMIC_STORE_RELAXED_GCC_X86("l", dst, src);
+                    } else if (order != c89atomic_memory_order_seq_cst) {
+                        C89ATOMIC_STORE_RELEASE_GCC_X86("l", dst, src);
                     } else {
-                        __asm__ __volatile__ (
-                            "xchgl %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                            : "memory"
-                        );
+                        C89ATOMIC_STORE_SEQ_CST_GCC_X86("l", dst, src);
                     }
                 }
                 #else
@@ -3320,18 +3850,11 @@ not represented here.
                 #if defined(C89ATOMIC_X64)
                 {
                     if (order == c89atomic_memory_order_relaxed) {
-                        __asm__ __volatile__ (
-                            "movq %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                        );
+                        C89ATOMIC_STORE_RELAXED_GCC_X86("q", dst, src);
+                    } else if (order != c89atomic_memory_order_seq_cst) {
+                        C89ATOMIC_STORE_RELEASE_GCC_X86("q", dst, src);
                     } else {
-                        __asm__ __volatile__ (
-                            "xchgq %1, %0"
-                            : "=m"(*dst)    /* %0 */
-                            : "r"(src)      /* %1 */
-                            : "memory"
-                        );
+                        C89ATOMIC_STORE_SEQ_CST_GCC_X86("q", dst, src);
                     }
                 }
                 #else
@@ -3615,10 +4138,16 @@ not represented here.
         { \
             c89atomic_uint##sizeInBits oldValue; \
             c89atomic_uint##sizeInBits newValue; \
-            do { \
+            c89atomic_backoff backoff; \
+            c89atomic_backoff_init(&backoff); \
+            for (;;) { \
                 oldValue = c89atomic_load_explicit_##sizeInBits(dst, c89atomic_memory_order_relaxed); \
                 newValue = oldValue opInst src; \
-            } while (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) != oldValue); \
+                if (c89atomic_compare_and_swap_##sizeInBits(dst, oldValue, newValue) == oldValue) { \
+                    break; \
+                } \
+                c89atomic_backoff_spin(&backoff); \
+            } \
             (void)order; \
             return oldValue; \
         }
@@ -3737,6 +4266,8 @@ Everything below this point is stuff that is implemented in terms of the functio
 Pointer versions of relevant operations. Note that some functions cannot be implemented as #defines because for some reason, some compilers
 complain with a warning if you don't use the return value. I'm not fully sure why this happens, but to work around this, those particular
 functions are just implemented as inlined functions.
+
+The offset for c89atomic_fetch_add_explicit_ptr() and c89atomic_fetch_sub_explicit_ptr() is in bytes, not elements.
 */
 #if defined(C89ATOMIC_64BIT)
     static C89ATOMIC_INLINE c89atomic_bool c89atomic_is_lock_free_ptr(volatile void** ptr)
@@ -3773,6 +4304,16 @@ functions are just implemented as inlined functions.
     {
         return (void*)c89atomic_compare_and_swap_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64)expected, (c89atomic_uint64)replacement);
     }
+
+    static C89ATOMIC_INLINE void* c89atomic_fetch_add_explicit_ptr(volatile void** dst, c89atomic_intptr offset, c89atomic_memory_order order)
+    {
+        return (void*)c89atomic_fetch_add_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64)offset, order);
+    }
+
+    static C89ATOMIC_INLINE void* c89atomic_fetch_sub_explicit_ptr(volatile void** dst, c89atomic_intptr offset, c89atomic_memory_order order)
+    {
+        return (void*)c89atomic_fetch_sub_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64)offset, order);
+    }
 #elif defined(C89ATOMIC_32BIT)
     static C89ATOMIC_INLINE c89atomic_bool c89atomic_is_lock_free_ptr(volatile void** ptr)
     {
@@ -3808,6 +4349,16 @@ functions are just implemented as inlined functions.
     {
         return (void*)c89atomic_compare_and_swap_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32)expected, (c89atomic_uint32)replacement);
     }
+
+    static C89ATOMIC_INLINE void* c89atomic_fetch_add_explicit_ptr(volatile void** dst, c89atomic_intptr offset, c89atomic_memory_order order)
+    {
+        return (void*)c89atomic_fetch_add_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32)offset, order);
+    }
+
+    static C89ATOMIC_INLINE void* c89atomic_fetch_sub_explicit_ptr(volatile void** dst, c89atomic_intptr offset, c89atomic_memory_order order)
+    {
+        return (void*)c89atomic_fetch_sub_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32)offset, order);
+    }
 #else
     #error Unsupported architecture.
 #endif
@@ -3818,8 +4369,380 @@ functions are just implemented as inlined functions.
 #define c89atomic_exchange_ptr(dst, src)                                    c89atomic_exchange_explicit_ptr((volatile void**)dst, (void*)src, c89atomic_memory_order_seq_cst)
 #define c89atomic_compare_exchange_strong_ptr(dst, expected, replacement)   c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)dst, (void**)expected, (void*)replacement, c89atomic_memory_order_seq_cst, c89atomic_memory_order_seq_cst)
 #define c89atomic_compare_exchange_weak_ptr(dst, expected, replacement)     c89atomic_compare_exchange_weak_explicit_ptr((volatile void**)dst, (void**)expected, (void*)replacement, c89atomic_memory_order_seq_cst, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_add_ptr(dst, offset)                                c89atomic_fetch_add_explicit_ptr((volatile void**)dst, offset, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_sub_ptr(dst, offset)                                c89atomic_fetch_sub_explicit_ptr((volatile void**)dst, offset, c89atomic_memory_order_seq_cst)
 /* END c89atomic_ptr.h */
 
+/* BEG c89atomic_tagged_ptr.h */
+/*
+A tagged pointer packs a pointer and a small counter into a single pointer-sized word. Bumping the
+counter every time the pointer is changed protects a compare-exchange against the ABA problem,
+where another thread pops a node and pushes it back between our load and our compare-exchange,
+without needing a double-width compare-exchange. The counter wraps so the protection is not
+perfect, but the window is much smaller.
+
+On x86-64 and AArch64 the tag lives in the upper 16 bits, which are not used by user-space
+pointers. This does not work for kernel-space pointers, or with pointer authentication, memory
+tagging or 5-level paging. In those cases define C89ATOMIC_TAGGED_PTR_USE_LOW_BITS.
+
+Everywhere else, or when C89ATOMIC_TAGGED_PTR_USE_LOW_BITS is defined, the tag lives in the low
+C89ATOMIC_TAGGED_PTR_LOW_BITS bits which means pointers must be aligned to a multiple of
+`1 << C89ATOMIC_TAGGED_PTR_LOW_BITS`. This defaults to the alignment of a pointer (2 bits on 32-bit
+and 3 bits on 64-bit), which only gives a handful of tag values. If you control the alignment of
+your nodes, such as by padding them to a cache line, you should increase it.
+
+c89atomic_tagged_ptr_compare_exchange_strong_explicit() and the weak version take a plain pointer
+as the replacement and increment the tag of `expected` for you.
+*/
+#if (defined(C89ATOMIC_X64) || defined(C89ATOMIC_ARM64)) && defined(C89ATOMIC_64BIT) && !defined(C89ATOMIC_TAGGED_PTR_USE_LOW_BITS)
+    #define C89ATOMIC_TAGGED_PTR_TAG_BITS   16
+    #define C89ATOMIC_TAGGED_PTR_TAG_SHIFT  48
+#else
+    #ifndef C89ATOMIC_TAGGED_PTR_LOW_BITS
+        #if defined(C89ATOMIC_64BIT)
+        #define C89ATOMIC_TAGGED_PTR_LOW_BITS   3
+        #else
+        #define C89ATOMIC_TAGGED_PTR_LOW_BITS   2
+        #endif
+    #endif
+    #define C89ATOMIC_TAGGED_PTR_TAG_BITS   C89ATOMIC_TAGGED_PTR_LOW_BITS
+    #define C89ATOMIC_TAGGED_PTR_TAG_SHIFT  0
+#endif
+
+#define C89ATOMIC_TAGGED_PTR_TAG_MASK       ((((c89atomic_uintptr)1 << C89ATOMIC_TAGGED_PTR_TAG_BITS) - 1) << C89ATOMIC_TAGGED_PTR_TAG_SHIFT)
+
+typedef c89atomic_uintptr c89atomic_tagged_ptr;
+
+static C89ATOMIC_INLINE c89atomic_tagged_ptr c89atomic_tagged_ptr_make(void* ptr, c89atomic_uintptr tag)
+{
+    return ((c89atomic_uintptr)ptr & ~C89ATOMIC_TAGGED_PTR_TAG_MASK) | ((tag << C89ATOMIC_TAGGED_PTR_TAG_SHIFT) & C89ATOMIC_TAGGED_PTR_TAG_MASK);
+}
+
+static C89ATOMIC_INLINE void* c89atomic_tagged_ptr_get_ptr(c89atomic_tagged_ptr tagged)
+{
+    return (void*)(tagged & ~C89ATOMIC_TAGGED_PTR_TAG_MASK);
+}
+
+static C89ATOMIC_INLINE c89atomic_uintptr c89atomic_tagged_ptr_get_tag(c89atomic_tagged_ptr tagged)
+{
+    return (tagged & C89ATOMIC_TAGGED_PTR_TAG_MASK) >> C89ATOMIC_TAGGED_PTR_TAG_SHIFT;
+}
+
+static C89ATOMIC_INLINE c89atomic_tagged_ptr c89atomic_tagged_ptr_load_explicit(volatile c89atomic_tagged_ptr* ptr, c89atomic_memory_order order)
+{
+    return (c89atomic_tagged_ptr)c89atomic_load_explicit_ptr((volatile void**)ptr, order);
+}
+
+static C89ATOMIC_INLINE void c89atomic_tagged_ptr_store_explicit(volatile c89atomic_tagged_ptr* dst, c89atomic_tagged_ptr src, c89atomic_memory_order order)
+{
+    c89atomic_store_explicit_ptr((volatile void**)dst, (void*)src, order);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_tagged_ptr_compare_exchange_strong_explicit(volatile c89atomic_tagged_ptr* dst, c89atomic_tagged_ptr* expected, void* replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_tagged_ptr desired = c89atomic_tagged_ptr_make(replacement, c89atomic_tagged_ptr_get_tag(*expected) + 1);
+    return c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)dst, (void**)expected, (void*)desired, successOrder, failureOrder);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_tagged_ptr_compare_exchange_weak_explicit(volatile c89atomic_tagged_ptr* dst, c89atomic_tagged_ptr* expected, void* replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_tagged_ptr desired = c89atomic_tagged_ptr_make(replacement, c89atomic_tagged_ptr_get_tag(*expected) + 1);
+    return c89atomic_compare_exchange_weak_explicit_ptr((volatile void**)dst, (void**)expected, (void*)desired, successOrder, failureOrder);
+}
+/* END c89atomic_tagged_ptr.h */
+
+/* BEG c89atomic_128.h */
+/*
+128-bit compare-exchange. This is mainly intended for pairing a pointer with a counter or tag so that
+lock-free data structures can avoid the ABA problem. Only compare-exchange and load are supported.
+
+The object must be aligned to 16 bytes. The c89atomic_uint128 type takes care of this on compilers that
+support an alignment attribute, but if you are allocating these dynamically you will need to make sure
+the allocation is aligned yourself.
+
+On x86-64 this uses CMPXCHG16B, which is missing on some very early 64-bit CPUs. Support is checked at
+runtime and if it's not available a spinlock is used instead, in which case you'll need c89atomic.c.
+If you're compiling with -mcx16, or anything that implies it, the check is skipped.
+
+There is no 128-bit load instruction that is guaranteed to be atomic, so c89atomic_load_explicit_128()
+is implemented as a compare-exchange. This means the object will be written to and therefore must not
+be in read-only memory.
+*/
+#if defined(_MSC_VER)
+    typedef __declspec(align(16)) struct
+    {
+        c89atomic_uint64 lo;
+        c89atomic_uint64 hi;
+    } c89atomic_uint128;
+#elif defined(__GNUC__)
+    typedef struct
+    {
+        c89atomic_uint64 lo;
+        c89atomic_uint64 hi;
+    } __attribute__((aligned(16))) c89atomic_uint128;
+#else
+    typedef struct
+    {
+        c89atomic_uint64 lo;
+        c89atomic_uint64 hi;
+    } c89atomic_uint128;
+#endif
+
+#if defined(C89ATOMIC_X64) && (defined(C89ATOMIC_MODERN_GCC) || defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM))
+    #define C89ATOMIC_128_GCC_ASM
+    #if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+        #define C89ATOMIC_IS_LOCK_FREE_128 1
+    #endif
+#elif (defined(C89ATOMIC_MODERN_GCC) || defined(C89ATOMIC_LEGACY_GCC)) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+    #define C89ATOMIC_128_GCC_SYNC
+    #define C89ATOMIC_IS_LOCK_FREE_128 1
+#elif (defined(C89ATOMIC_MODERN_MSVC) || (defined(C89ATOMIC_LEGACY_MSVC) && _MSC_VER >= 1500)) && (defined(C89ATOMIC_X64) || defined(C89ATOMIC_ARM64))
+    #define C89ATOMIC_128_MSVC
+    #if defined(C89ATOMIC_ARM64)
+        #define C89ATOMIC_IS_LOCK_FREE_128 1
+    #endif
+#endif
+
+#if !defined(C89ATOMIC_IS_LOCK_FREE_128)
+    static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_128_lock(volatile c89atomic_uint128* dst, c89atomic_uint128* expected, c89atomic_uint128 replacement)
+    {
+        volatile c89atomic_spinlock* pLock = c89atomic_get_address_lock(dst);
+        c89atomic_bool result;
+
+        c89atomic_spinlock_lock(pLock);
+        {
+            if (dst->lo == expected->lo && dst->hi == expected->hi) {
+                dst->lo = replacement.lo;
+                dst->hi = replacement.hi;
+                result = 1;
+            } else {
+                expected->lo = dst->lo;
+                expected->hi = dst->hi;
+                result = 0;
+            }
+        }
+        c89atomic_spinlock_unlock(pLock);
+
+        return result;
+    }
+#endif
+
+#if (defined(C89ATOMIC_128_GCC_ASM) || defined(C89ATOMIC_128_MSVC)) && !defined(C89ATOMIC_IS_LOCK_FREE_128)
+    static C89ATOMIC_INLINE c89atomic_bool c89atomic_has_cmpxchg16b(void)
+    {
+        /* 0 = not yet checked, 1 = unsupported, 2 = supported. Threads racing on the first check will just both do the check. */
+        static c89atomic_uint32 support = 0;
+        c89atomic_uint32 result = c89atomic_load_explicit_32(&support, c89atomic_memory_order_relaxed);
+
+        if (result == 0) {
+            c89atomic_uint32 featureBits;
+
+            #if defined(C89ATOMIC_128_MSVC)
+            {
+                int info[4];
+                __cpuid(info, 1);
+                featureBits = (c89atomic_uint32)info[2];
+            }
+            #else
+            {
+                c89atomic_uint32 eax = 1;
+                c89atomic_uint32 ebx;
+                c89atomic_uint32 edx;
+
+                featureBits = 0;
+                __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(featureBits), "=d"(edx));
+                (void)ebx;
+                (void)edx;
+            }
+            #endif
+
+            result = ((featureBits & (1 << 13)) != 0) ? 2 : 1;   /* CPUID.01H:ECX.CMPXCHG16B[bit 13] */
+            c89atomic_store_explicit_32(&support, result, c89atomic_memory_order_relaxed);
+        }
+
+        return result == 2;
+    }
+#endif
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_is_lock_free_128(volatile void* ptr)
+{
+    (void)ptr;
+    #if defined(C89ATOMIC_IS_LOCK_FREE_128)
+        return 1;
+    #elif defined(C89ATOMIC_128_GCC_ASM) || defined(C89ATOMIC_128_MSVC)
+        return c89atomic_has_cmpxchg16b();
+    #else
+        return 0;
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_explicit_128(volatile c89atomic_uint128* dst, c89atomic_uint128* expected, c89atomic_uint128 replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    /* All native implementations are full barriers. */
+    (void)successOrder;
+    (void)failureOrder;
+
+    #if defined(C89ATOMIC_128_GCC_ASM)
+    {
+        c89atomic_uint8 result;
+
+        #if !defined(C89ATOMIC_IS_LOCK_FREE_128)
+        {
+            if (!c89atomic_has_cmpxchg16b()) {
+                return c89atomic_compare_exchange_strong_128_lock(dst, expected, replacement);
+            }
+        }
+        #endif
+
+        __asm__ __volatile__(
+            "lock; cmpxchg16b %1\n"
+            "setz %0"
+            : "=q"(result), "+m"(*dst), "+a"(expected->lo), "+d"(expected->hi)
+            : "b"(replacement.lo), "c"(replacement.hi)
+            : "cc", "memory"
+        );
+
+        return (c89atomic_bool)result;
+    }
+    #elif defined(C89ATOMIC_128_GCC_SYNC)
+    {
+        __extension__ typedef unsigned __int128 c89atomic_uint128_native;
+        union
+        {
+            c89atomic_uint128 s;
+            c89atomic_uint128_native n;
+        } oldValue, newValue, prevValue;
+
+        oldValue.s = *expected;
+        newValue.s = replacement;
+
+        prevValue.n = __sync_val_compare_and_swap((volatile c89atomic_uint128_native*)dst, oldValue.n, newValue.n);
+        if (prevValue.n == oldValue.n) {
+            return 1;
+        }
+
+        *expected = prevValue.s;
+        return 0;
+    }
+    #elif defined(C89ATOMIC_128_MSVC)
+    {
+        #if !defined(C89ATOMIC_IS_LOCK_FREE_128)
+        {
+            if (!c89atomic_has_cmpxchg16b()) {
+                return c89atomic_compare_exchange_strong_128_lock(dst, expected, replacement);
+            }
+        }
+        #endif
+
+        return (c89atomic_bool)_InterlockedCompareExchange128((volatile __int64*)dst, (__int64)replacement.hi, (__int64)replacement.lo, (__int64*)expected);
+    }
+    #else
+    {
+        return c89atomic_compare_exchange_strong_128_lock(dst, expected, replacement);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_weak_explicit_128(volatile c89atomic_uint128* dst, c89atomic_uint128* expected, c89atomic_uint128 replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    return c89atomic_compare_exchange_strong_explicit_128(dst, expected, replacement, successOrder, failureOrder);
+}
+
+static C89ATOMIC_INLINE c89atomic_uint128 c89atomic_load_explicit_128(volatile c89atomic_uint128* ptr, c89atomic_memory_order order)
+{
+    c89atomic_uint128 result;
+    c89atomic_uint128 zero;
+
+    /* If the value is zero we'll write zero back, otherwise the compare fails and we get the current value. */
+    zero.lo = 0;
+    zero.hi = 0;
+    result = zero;
+    c89atomic_compare_exchange_strong_explicit_128(ptr, &result, zero, order, order);
+
+    return result;
+}
+
+#define c89atomic_load_128(ptr)                                             c89atomic_load_explicit_128(ptr, c89atomic_memory_order_seq_cst)
+#define c89atomic_compare_exchange_strong_128(dst, expected, replacement)   c89atomic_compare_exchange_strong_explicit_128(dst, expected, replacement, c89atomic_memory_order_seq_cst, c89atomic_memory_order_seq_cst)
+#define c89atomic_compare_exchange_weak_128(dst, expected, replacement)     c89atomic_compare_exchange_weak_explicit_128(dst, expected, replacement, c89atomic_memory_order_seq_cst, c89atomic_memory_order_seq_cst)
+/* END c89atomic_128.h */
+
+/* BEG c89atomic_backend_info.h */
+/*
+Information about how c89atomic has been configured for the current build. This is mostly useful for
+logging. If you need to choose an algorithm based on whether or not something is lock-free, use the
+C89ATOMIC_ALWAYS_LOCK_FREE_* constants instead so it can be done at compile time.
+*/
+typedef struct
+{
+    const char* pCodePath;          /* "MODERN_MSVC", "LEGACY_MSVC", "LEGACY_MSVC_ASM", "MODERN_GCC", "LEGACY_GCC", "LEGACY_GCC_ASM" or "CHIBICC". */
+    const char* pArchitecture;      /* "x64", "x86", "arm64", "arm32", "ppc64", "ppc32" or "unknown". */
+    c89atomic_bool isLockFree8;
+    c89atomic_bool isLockFree16;
+    c89atomic_bool isLockFree32;
+    c89atomic_bool isLockFree64;
+    c89atomic_bool isLockFreePtr;
+    c89atomic_bool isLockFree128;   /* Can depend on the CPU. */
+    c89atomic_uint32 cacheLineSize;
+    c89atomic_uint32 lockCount;     /* The number of spinlocks used for emulated operations. 1 when C89ATOMIC_USE_GLOBAL_LOCK is defined. */
+} c89atomic_backend_info;
+
+static C89ATOMIC_INLINE c89atomic_backend_info c89atomic_get_backend_info(void)
+{
+    c89atomic_backend_info info;
+
+    #if defined(C89ATOMIC_MODERN_MSVC)
+        info.pCodePath = "MODERN_MSVC";
+    #elif defined(C89ATOMIC_LEGACY_MSVC)
+        info.pCodePath = "LEGACY_MSVC";
+    #elif defined(C89ATOMIC_LEGACY_MSVC_ASM)
+        info.pCodePath = "LEGACY_MSVC_ASM";
+    #elif defined(C89ATOMIC_MODERN_GCC)
+        info.pCodePath = "MODERN_GCC";
+    #elif defined(C89ATOMIC_LEGACY_GCC)
+        info.pCodePath = "LEGACY_GCC";
+    #elif defined(C89ATOMIC_LEGACY_GCC_ASM)
+        info.pCodePath = "LEGACY_GCC_ASM";
+    #elif defined(C89ATOMIC_CHIBICC)
+        info.pCodePath = "CHIBICC";
+    #else
+        info.pCodePath = "unknown";
+    #endif
+
+    #if defined(C89ATOMIC_X64)
+        info.pArchitecture = "x64";
+    #elif defined(C89ATOMIC_X86)
+        info.pArchitecture = "x86";
+    #elif defined(C89ATOMIC_ARM64)
+        info.pArchitecture = "arm64";
+    #elif defined(C89ATOMIC_ARM32)
+        info.pArchitecture = "arm32";
+    #elif defined(C89ATOMIC_PPC64)
+        info.pArchitecture = "ppc64";
+    #elif defined(C89ATOMIC_PPC32)
+        info.pArchitecture = "ppc32";
+    #else
+        info.pArchitecture = "unknown";
+    #endif
+
+    info.isLockFree8   = (c89atomic_bool)c89atomic_is_lock_free_8(0);
+    info.isLockFree16  = (c89atomic_bool)c89atomic_is_lock_free_16(0);
+    info.isLockFree32  = (c89atomic_bool)c89atomic_is_lock_free_32(0);
+    info.isLockFree64  = (c89atomic_bool)c89atomic_is_lock_free_64(0);
+    info.isLockFreePtr = (c89atomic_bool)c89atomic_is_lock_free_ptr(0);
+    info.isLockFree128 = c89atomic_is_lock_free_128(0);
+    info.cacheLineSize = C89ATOMIC_CACHE_LINE_SIZE;
+
+    #if defined(C89ATOMIC_USE_GLOBAL_LOCK)
+        info.lockCount = 1;
+    #else
+        info.lockCount = C89ATOMIC_LOCK_TABLE_SIZE;
+    #endif
+
+    return info;
+}
+/* END c89atomic_backend_info.h */
+
 /* BEG c89atomic_unsigned.h */
 /* Implicit Unsigned Integer. */
 #define c89atomic_store_8( dst, src)                                    c89atomic_store_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
@@ -3985,27 +4908,1674 @@ functions are just implemented as inlined functions.
 /* END c89atomic_signed.h */
 
 
-/* BEG c89atomic_float.h */
-/* Floating Point Explicit. */
-typedef union
-{
-    c89atomic_uint32 i;
-    float f;
-} c89atomic_if32;
+/* BEG c89atomic_minmax.h */
+/*
+Atomic min and max. These are useful for tracking high and low water marks. Where the hardware has a
+native instruction for this it will be used. Otherwise it's a compare-exchange loop which will exit
+early without writing anything if the object does not need to be changed, in which case it is just a
+load. This is important when the value rarely changes because it avoids a locked read-modify-write.
+*/
+#if defined(C89ATOMIC_MODERN_GCC) && defined(__clang__) && defined(__has_builtin)
+    #if __has_builtin(__atomic_fetch_min) && __has_builtin(__atomic_fetch_max)
+        /* On x86 these are compiled to a compare-exchange loop without the early exit so we don't use them there. */
+        #if !defined(C89ATOMIC_X86) && !defined(C89ATOMIC_X64)
+            #define C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX
+        #endif
+    #endif
+#endif
 
-typedef union
-{
-    c89atomic_uint64 i;
-    double f;
-} c89atomic_if64;
+#if (defined(C89ATOMIC_MODERN_GCC) || defined(C89ATOMIC_LEGACY_GCC)) && defined(C89ATOMIC_ARM64) && defined(__ARM_FEATURE_ATOMICS)
+    /* ARMv8.1 Large System Extensions. */
+    #define C89ATOMIC_ARM64_LSE
+#endif
 
-#define c89atomic_clear_explicit_f32(ptr, order)                        c89atomic_clear_explicit_32((c89atomic_uint32*)ptr, order)
-#define c89atomic_clear_explicit_f64(ptr, order)                        c89atomic_clear_explicit_64((c89atomic_uint64*)ptr, order)
+/*
+The memory order to use for the load part of a read-modify-write that might not end up writing
+anything. A load cannot have release semantics.
+*/
+#define C89ATOMIC_RMW_LOAD_ORDER(order) \
+    (((order) == c89atomic_memory_order_relaxed || (order) == c89atomic_memory_order_release) ? c89atomic_memory_order_relaxed : \
+    (((order) == c89atomic_memory_order_consume) ? c89atomic_memory_order_consume : c89atomic_memory_order_acquire))
+
+#define C89ATOMIC_FETCH_MINMAX_CAS(sizeInBits, type, dst, src, order, cmp) \
+    type oldValue; \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    oldValue = (type)c89atomic_load_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, C89ATOMIC_RMW_LOAD_ORDER(order)); \
+    for (;;) { \
+        if (!(src cmp oldValue)) { \
+            break; \
+        } \
+        if (c89atomic_compare_exchange_weak_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, (c89atomic_uint##sizeInBits*)&oldValue, (c89atomic_uint##sizeInBits)src, order, C89ATOMIC_RMW_LOAD_ORDER(order))) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
+    return oldValue
 
-static C89ATOMIC_INLINE void c89atomic_store_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
+#if defined(C89ATOMIC_ARM64_LSE)
+    /* inst is the base instruction name, such as "ldumax". The ordering suffix is added here, and then the size suffix ("b", "h" or ""). */
+    #define C89ATOMIC_ARM64_LSE_FETCH_OP(inst, sizeSuffix, reg, type, dst, src, order) \
+        type result; \
+        switch (order) \
+        { \
+            case c89atomic_memory_order_relaxed: \
+            { \
+                __asm__ __volatile__(inst sizeSuffix " %" reg "2, %" reg "0, %1" : "=r"(result), "+Q"(*dst) : "r"(src) : "memory"); \
+            } break; \
+            case c89atomic_memory_order_consume: \
+            case c89atomic_memory_order_acquire: \
+            { \
+                __asm__ __volatile__(inst "a" sizeSuffix " %" reg "2, %" reg "0, %1" : "=r"(result), "+Q"(*dst) : "r"(src) : "memory"); \
+            } break; \
+            case c89atomic_memory_order_release: \
+            { \
+                __asm__ __volatile__(inst "l" sizeSuffix " %" reg "2, %" reg "0, %1" : "=r"(result), "+Q"(*dst) : "r"(src) : "memory"); \
+            } break; \
+            case c89atomic_memory_order_acq_rel: \
+            case c89atomic_memory_order_seq_cst: \
+            default: \
+            { \
+                __asm__ __volatile__(inst "al" sizeSuffix " %" reg "2, %" reg "0, %1" : "=r"(result), "+Q"(*dst) : "r"(src) : "memory"); \
+            } break; \
+        } \
+        return result
+#endif
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_fetch_min_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
 {
-    c89atomic_if32 x;
-    x.f = src;
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumin", "b", "w", c89atomic_uint8, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(8, c89atomic_uint8, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_fetch_min_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumin", "h", "w", c89atomic_uint16, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(16, c89atomic_uint16, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_fetch_min_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumin", "", "w", c89atomic_uint32, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(32, c89atomic_uint32, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_fetch_min_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumin", "", "x", c89atomic_uint64, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(64, c89atomic_uint64, dst, src, order, <);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_int8 c89atomic_fetch_min_explicit_i8(volatile c89atomic_int8* dst, c89atomic_int8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmin", "b", "w", c89atomic_int8, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(8, c89atomic_int8, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int16 c89atomic_fetch_min_explicit_i16(volatile c89atomic_int16* dst, c89atomic_int16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmin", "h", "w", c89atomic_int16, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(16, c89atomic_int16, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int32 c89atomic_fetch_min_explicit_i32(volatile c89atomic_int32* dst, c89atomic_int32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmin", "", "w", c89atomic_int32, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(32, c89atomic_int32, dst, src, order, <);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int64 c89atomic_fetch_min_explicit_i64(volatile c89atomic_int64* dst, c89atomic_int64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_min(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmin", "", "x", c89atomic_int64, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(64, c89atomic_int64, dst, src, order, <);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_fetch_max_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumax", "b", "w", c89atomic_uint8, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(8, c89atomic_uint8, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_fetch_max_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumax", "h", "w", c89atomic_uint16, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(16, c89atomic_uint16, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_fetch_max_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumax", "", "w", c89atomic_uint32, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(32, c89atomic_uint32, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_fetch_max_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldumax", "", "x", c89atomic_uint64, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(64, c89atomic_uint64, dst, src, order, >);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_int8 c89atomic_fetch_max_explicit_i8(volatile c89atomic_int8* dst, c89atomic_int8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmax", "b", "w", c89atomic_int8, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(8, c89atomic_int8, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int16 c89atomic_fetch_max_explicit_i16(volatile c89atomic_int16* dst, c89atomic_int16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmax", "h", "w", c89atomic_int16, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(16, c89atomic_int16, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int32 c89atomic_fetch_max_explicit_i32(volatile c89atomic_int32* dst, c89atomic_int32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmax", "", "w", c89atomic_int32, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(32, c89atomic_int32, dst, src, order, >);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_int64 c89atomic_fetch_max_explicit_i64(volatile c89atomic_int64* dst, c89atomic_int64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_HAS_ATOMIC_FETCH_MINMAX)
+    {
+        return __atomic_fetch_max(dst, src, order);
+    }
+    #elif defined(C89ATOMIC_ARM64_LSE)
+    {
+        C89ATOMIC_ARM64_LSE_FETCH_OP("ldsmax", "", "x", c89atomic_int64, dst, src, order);
+    }
+    #else
+    {
+        C89ATOMIC_FETCH_MINMAX_CAS(64, c89atomic_int64, dst, src, order, >);
+    }
+    #endif
+}
+
+
+#define c89atomic_fetch_min_8( dst, src)                                c89atomic_fetch_min_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_16(dst, src)                                c89atomic_fetch_min_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_32(dst, src)                                c89atomic_fetch_min_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_64(dst, src)                                c89atomic_fetch_min_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_fetch_min_i8( dst, src)                               c89atomic_fetch_min_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_i16(dst, src)                               c89atomic_fetch_min_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_i32(dst, src)                               c89atomic_fetch_min_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_i64(dst, src)                               c89atomic_fetch_min_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_fetch_max_8( dst, src)                                c89atomic_fetch_max_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_16(dst, src)                                c89atomic_fetch_max_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_32(dst, src)                                c89atomic_fetch_max_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_64(dst, src)                                c89atomic_fetch_max_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_fetch_max_i8( dst, src)                               c89atomic_fetch_max_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_i16(dst, src)                               c89atomic_fetch_max_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_i32(dst, src)                               c89atomic_fetch_max_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_i64(dst, src)                               c89atomic_fetch_max_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+/* END c89atomic_minmax.h */
+
+
+/* BEG c89atomic_rmw.h */
+/*
+Read-modify-write operations that either discard the result, such as c89atomic_add_explicit_32(), or
+return the new value instead of the old value, such as c89atomic_add_fetch_explicit_32().
+
+When the result is not needed, x86 can use a plain locked instruction like `lock add` or `lock or`
+instead of `lock xadd` or a compare-exchange loop, and ARMv8.1 can use `stadd` or `stset`. Compilers
+will do this automatically for the intrinsic based code paths when the result of the intrinsic is
+unused. The inline assembly code paths need to do it explicitly.
+
+chibicc is left on the compare-exchange loop. Its asm() only accepts a plain string with no operands,
+so there's no way to refer to dst and src from the instruction without relying on which registers
+chibicc happens to have left them in.
+*/
+#if defined(C89ATOMIC_LEGACY_MSVC_ASM)
+    static C89ATOMIC_INLINE void __stdcall c89atomic_add_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov al, src
+                lock add [ecx], al
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_add_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov ax, src
+                lock add [ecx], ax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_add_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov eax, src
+                lock add [ecx], eax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_add_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        (void)c89atomic_fetch_add_explicit_64(dst, src, order);
+    }
+
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_sub_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov al, src
+                lock sub [ecx], al
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_sub_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov ax, src
+                lock sub [ecx], ax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_sub_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov eax, src
+                lock sub [ecx], eax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_sub_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        (void)c89atomic_fetch_sub_explicit_64(dst, src, order);
+    }
+
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_or_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov al, src
+                lock or [ecx], al
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_or_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov ax, src
+                lock or [ecx], ax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_or_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov eax, src
+                lock or [ecx], eax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_or_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        (void)c89atomic_fetch_or_explicit_64(dst, src, order);
+    }
+
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_xor_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov al, src
+                lock xor [ecx], al
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_xor_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov ax, src
+                lock xor [ecx], ax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_xor_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov eax, src
+                lock xor [ecx], eax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_xor_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        (void)c89atomic_fetch_xor_explicit_64(dst, src, order);
+    }
+
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_and_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov al, src
+                lock and [ecx], al
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_and_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov ax, src
+                lock and [ecx], ax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_and_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            __asm {
+                mov ecx, dst
+                mov eax, src
+                lock and [ecx], eax
+            }
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void __stdcall c89atomic_and_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        (void)c89atomic_fetch_and_explicit_64(dst, src, order);
+    }
+#elif defined(C89ATOMIC_LEGACY_GCC_ASM) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+    #define C89ATOMIC_RMW_GCC_X86(instruction, instructionSizeSuffix, dst, src) \
+        __asm__ __volatile__(                                         \
+            "lock; " instruction instructionSizeSuffix " %1, %0"      \
+            : "=m"(*dst)    /* %0 */                                  \
+            : "q"(src),     /* %1 */                                  \
+              "m"(*dst)     /* %2 */                                  \
+            : "cc", "memory")
+
+    static C89ATOMIC_INLINE void c89atomic_add_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("add", "b", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_add_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("add", "w", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_add_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("add", "l", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_add_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("add", "q", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_add_explicit_64(dst, src, order);
+        }
+        #endif
+    }
+
+
+    static C89ATOMIC_INLINE void c89atomic_sub_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("sub", "b", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_sub_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("sub", "w", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_sub_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("sub", "l", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_sub_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("sub", "q", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_sub_explicit_64(dst, src, order);
+        }
+        #endif
+    }
+
+
+    static C89ATOMIC_INLINE void c89atomic_or_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("or", "b", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_or_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("or", "w", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_or_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("or", "l", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_or_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("or", "q", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_or_explicit_64(dst, src, order);
+        }
+        #endif
+    }
+
+
+    static C89ATOMIC_INLINE void c89atomic_xor_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("xor", "b", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_xor_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("xor", "w", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_xor_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("xor", "l", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_xor_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("xor", "q", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_xor_explicit_64(dst, src, order);
+        }
+        #endif
+    }
+
+
+    static C89ATOMIC_INLINE void c89atomic_and_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_8)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("and", "b", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_8(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_and_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_16)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("and", "w", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_16(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_and_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_32)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("and", "l", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_32(dst, src, order);
+        }
+        #endif
+    }
+
+    static C89ATOMIC_INLINE void c89atomic_and_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+    {
+        #if defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+        {
+            (void)order;
+            C89ATOMIC_RMW_GCC_X86("and", "q", dst, src);
+        }
+        #else
+        {
+            (void)c89atomic_fetch_and_explicit_64(dst, src, order);
+        }
+        #endif
+    }
+#else
+    #define c89atomic_add_explicit_8( dst, src, order)                  (void)c89atomic_fetch_add_explicit_8( dst, src, order)
+    #define c89atomic_add_explicit_16(dst, src, order)                  (void)c89atomic_fetch_add_explicit_16(dst, src, order)
+    #define c89atomic_add_explicit_32(dst, src, order)                  (void)c89atomic_fetch_add_explicit_32(dst, src, order)
+    #define c89atomic_add_explicit_64(dst, src, order)                  (void)c89atomic_fetch_add_explicit_64(dst, src, order)
+
+    #define c89atomic_sub_explicit_8( dst, src, order)                  (void)c89atomic_fetch_sub_explicit_8( dst, src, order)
+    #define c89atomic_sub_explicit_16(dst, src, order)                  (void)c89atomic_fetch_sub_explicit_16(dst, src, order)
+    #define c89atomic_sub_explicit_32(dst, src, order)                  (void)c89atomic_fetch_sub_explicit_32(dst, src, order)
+    #define c89atomic_sub_explicit_64(dst, src, order)                  (void)c89atomic_fetch_sub_explicit_64(dst, src, order)
+
+    #define c89atomic_or_explicit_8( dst, src, order)                   (void)c89atomic_fetch_or_explicit_8( dst, src, order)
+    #define c89atomic_or_explicit_16(dst, src, order)                   (void)c89atomic_fetch_or_explicit_16(dst, src, order)
+    #define c89atomic_or_explicit_32(dst, src, order)                   (void)c89atomic_fetch_or_explicit_32(dst, src, order)
+    #define c89atomic_or_explicit_64(dst, src, order)                   (void)c89atomic_fetch_or_explicit_64(dst, src, order)
+
+    #define c89atomic_xor_explicit_8( dst, src, order)                  (void)c89atomic_fetch_xor_explicit_8( dst, src, order)
+    #define c89atomic_xor_explicit_16(dst, src, order)                  (void)c89atomic_fetch_xor_explicit_16(dst, src, order)
+    #define c89atomic_xor_explicit_32(dst, src, order)                  (void)c89atomic_fetch_xor_explicit_32(dst, src, order)
+    #define c89atomic_xor_explicit_64(dst, src, order)                  (void)c89atomic_fetch_xor_explicit_64(dst, src, order)
+
+    #define c89atomic_and_explicit_8( dst, src, order)                  (void)c89atomic_fetch_and_explicit_8( dst, src, order)
+    #define c89atomic_and_explicit_16(dst, src, order)                  (void)c89atomic_fetch_and_explicit_16(dst, src, order)
+    #define c89atomic_and_explicit_32(dst, src, order)                  (void)c89atomic_fetch_and_explicit_32(dst, src, order)
+    #define c89atomic_and_explicit_64(dst, src, order)                  (void)c89atomic_fetch_and_explicit_64(dst, src, order)
+#endif
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_add_fetch_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_add_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint8)(c89atomic_fetch_add_explicit_8(dst, src, order) + src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_add_fetch_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_add_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint16)(c89atomic_fetch_add_explicit_16(dst, src, order) + src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_add_fetch_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_add_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint32)(c89atomic_fetch_add_explicit_32(dst, src, order) + src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_add_fetch_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_add_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint64)(c89atomic_fetch_add_explicit_64(dst, src, order) + src);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_sub_fetch_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_sub_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint8)(c89atomic_fetch_sub_explicit_8(dst, src, order) - src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_sub_fetch_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_sub_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint16)(c89atomic_fetch_sub_explicit_16(dst, src, order) - src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_sub_fetch_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_sub_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint32)(c89atomic_fetch_sub_explicit_32(dst, src, order) - src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_sub_fetch_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_sub_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint64)(c89atomic_fetch_sub_explicit_64(dst, src, order) - src);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_or_fetch_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_or_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint8)(c89atomic_fetch_or_explicit_8(dst, src, order) | src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_or_fetch_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_or_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint16)(c89atomic_fetch_or_explicit_16(dst, src, order) | src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_or_fetch_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_or_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint32)(c89atomic_fetch_or_explicit_32(dst, src, order) | src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_or_fetch_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_or_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint64)(c89atomic_fetch_or_explicit_64(dst, src, order) | src);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_xor_fetch_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_xor_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint8)(c89atomic_fetch_xor_explicit_8(dst, src, order) ^ src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_xor_fetch_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_xor_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint16)(c89atomic_fetch_xor_explicit_16(dst, src, order) ^ src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_xor_fetch_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_xor_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint32)(c89atomic_fetch_xor_explicit_32(dst, src, order) ^ src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_xor_fetch_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_xor_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint64)(c89atomic_fetch_xor_explicit_64(dst, src, order) ^ src);
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_uint8 c89atomic_and_fetch_explicit_8(volatile c89atomic_uint8* dst, c89atomic_uint8 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_and_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint8)(c89atomic_fetch_and_explicit_8(dst, src, order) & src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint16 c89atomic_and_fetch_explicit_16(volatile c89atomic_uint16* dst, c89atomic_uint16 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_and_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint16)(c89atomic_fetch_and_explicit_16(dst, src, order) & src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_and_fetch_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_and_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint32)(c89atomic_fetch_and_explicit_32(dst, src, order) & src);
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_and_fetch_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint64 src, c89atomic_memory_order order)
+{
+    #if defined(C89ATOMIC_MODERN_GCC)
+    {
+        return __atomic_and_fetch(dst, src, order);
+    }
+    #else
+    {
+        return (c89atomic_uint64)(c89atomic_fetch_and_explicit_64(dst, src, order) & src);
+    }
+    #endif
+}
+
+
+/* Signed. */
+#define c89atomic_add_explicit_i8( dst, src, order)                     c89atomic_add_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_add_explicit_i16(dst, src, order)                     c89atomic_add_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_add_explicit_i32(dst, src, order)                     c89atomic_add_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_add_explicit_i64(dst, src, order)                     c89atomic_add_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_sub_explicit_i8( dst, src, order)                     c89atomic_sub_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_sub_explicit_i16(dst, src, order)                     c89atomic_sub_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_sub_explicit_i32(dst, src, order)                     c89atomic_sub_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_sub_explicit_i64(dst, src, order)                     c89atomic_sub_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_or_explicit_i8( dst, src, order)                      c89atomic_or_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_or_explicit_i16(dst, src, order)                      c89atomic_or_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_or_explicit_i32(dst, src, order)                      c89atomic_or_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_or_explicit_i64(dst, src, order)                      c89atomic_or_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_xor_explicit_i8( dst, src, order)                     c89atomic_xor_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_xor_explicit_i16(dst, src, order)                     c89atomic_xor_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_xor_explicit_i32(dst, src, order)                     c89atomic_xor_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_xor_explicit_i64(dst, src, order)                     c89atomic_xor_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_and_explicit_i8( dst, src, order)                     c89atomic_and_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_and_explicit_i16(dst, src, order)                     c89atomic_and_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_and_explicit_i32(dst, src, order)                     c89atomic_and_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_and_explicit_i64(dst, src, order)                     c89atomic_and_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_add_fetch_explicit_i8( dst, src, order)               (c89atomic_int8 )c89atomic_add_fetch_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_add_fetch_explicit_i16(dst, src, order)               (c89atomic_int16)c89atomic_add_fetch_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_add_fetch_explicit_i32(dst, src, order)               (c89atomic_int32)c89atomic_add_fetch_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_add_fetch_explicit_i64(dst, src, order)               (c89atomic_int64)c89atomic_add_fetch_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_sub_fetch_explicit_i8( dst, src, order)               (c89atomic_int8 )c89atomic_sub_fetch_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_sub_fetch_explicit_i16(dst, src, order)               (c89atomic_int16)c89atomic_sub_fetch_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_sub_fetch_explicit_i32(dst, src, order)               (c89atomic_int32)c89atomic_sub_fetch_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_sub_fetch_explicit_i64(dst, src, order)               (c89atomic_int64)c89atomic_sub_fetch_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_or_fetch_explicit_i8( dst, src, order)                (c89atomic_int8 )c89atomic_or_fetch_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_or_fetch_explicit_i16(dst, src, order)                (c89atomic_int16)c89atomic_or_fetch_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_or_fetch_explicit_i32(dst, src, order)                (c89atomic_int32)c89atomic_or_fetch_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_or_fetch_explicit_i64(dst, src, order)                (c89atomic_int64)c89atomic_or_fetch_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_xor_fetch_explicit_i8( dst, src, order)               (c89atomic_int8 )c89atomic_xor_fetch_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_xor_fetch_explicit_i16(dst, src, order)               (c89atomic_int16)c89atomic_xor_fetch_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_xor_fetch_explicit_i32(dst, src, order)               (c89atomic_int32)c89atomic_xor_fetch_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_xor_fetch_explicit_i64(dst, src, order)               (c89atomic_int64)c89atomic_xor_fetch_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+#define c89atomic_and_fetch_explicit_i8( dst, src, order)               (c89atomic_int8 )c89atomic_and_fetch_explicit_8( (c89atomic_uint8* )dst, (c89atomic_uint8 )src, order)
+#define c89atomic_and_fetch_explicit_i16(dst, src, order)               (c89atomic_int16)c89atomic_and_fetch_explicit_16((c89atomic_uint16*)dst, (c89atomic_uint16)src, order)
+#define c89atomic_and_fetch_explicit_i32(dst, src, order)               (c89atomic_int32)c89atomic_and_fetch_explicit_32((c89atomic_uint32*)dst, (c89atomic_uint32)src, order)
+#define c89atomic_and_fetch_explicit_i64(dst, src, order)               (c89atomic_int64)c89atomic_and_fetch_explicit_64((c89atomic_uint64*)dst, (c89atomic_uint64)src, order)
+
+/* Implicit. */
+#define c89atomic_add_8( dst, src)                                      c89atomic_add_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_16(dst, src)                                      c89atomic_add_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_32(dst, src)                                      c89atomic_add_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_64(dst, src)                                      c89atomic_add_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_sub_8( dst, src)                                      c89atomic_sub_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_16(dst, src)                                      c89atomic_sub_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_32(dst, src)                                      c89atomic_sub_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_64(dst, src)                                      c89atomic_sub_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_or_8( dst, src)                                       c89atomic_or_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_16(dst, src)                                       c89atomic_or_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_32(dst, src)                                       c89atomic_or_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_64(dst, src)                                       c89atomic_or_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_xor_8( dst, src)                                      c89atomic_xor_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_16(dst, src)                                      c89atomic_xor_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_32(dst, src)                                      c89atomic_xor_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_64(dst, src)                                      c89atomic_xor_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_and_8( dst, src)                                      c89atomic_and_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_16(dst, src)                                      c89atomic_and_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_32(dst, src)                                      c89atomic_and_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_64(dst, src)                                      c89atomic_and_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_add_i8( dst, src)                                     c89atomic_add_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_i16(dst, src)                                     c89atomic_add_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_i32(dst, src)                                     c89atomic_add_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_i64(dst, src)                                     c89atomic_add_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_sub_i8( dst, src)                                     c89atomic_sub_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_i16(dst, src)                                     c89atomic_sub_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_i32(dst, src)                                     c89atomic_sub_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_i64(dst, src)                                     c89atomic_sub_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_or_i8( dst, src)                                      c89atomic_or_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_i16(dst, src)                                      c89atomic_or_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_i32(dst, src)                                      c89atomic_or_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_i64(dst, src)                                      c89atomic_or_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_xor_i8( dst, src)                                     c89atomic_xor_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_i16(dst, src)                                     c89atomic_xor_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_i32(dst, src)                                     c89atomic_xor_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_i64(dst, src)                                     c89atomic_xor_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_and_i8( dst, src)                                     c89atomic_and_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_i16(dst, src)                                     c89atomic_and_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_i32(dst, src)                                     c89atomic_and_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_i64(dst, src)                                     c89atomic_and_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_add_fetch_8( dst, src)                                c89atomic_add_fetch_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_16(dst, src)                                c89atomic_add_fetch_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_32(dst, src)                                c89atomic_add_fetch_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_64(dst, src)                                c89atomic_add_fetch_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_sub_fetch_8( dst, src)                                c89atomic_sub_fetch_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_16(dst, src)                                c89atomic_sub_fetch_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_32(dst, src)                                c89atomic_sub_fetch_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_64(dst, src)                                c89atomic_sub_fetch_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_or_fetch_8( dst, src)                                 c89atomic_or_fetch_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_16(dst, src)                                 c89atomic_or_fetch_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_32(dst, src)                                 c89atomic_or_fetch_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_64(dst, src)                                 c89atomic_or_fetch_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_xor_fetch_8( dst, src)                                c89atomic_xor_fetch_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_16(dst, src)                                c89atomic_xor_fetch_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_32(dst, src)                                c89atomic_xor_fetch_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_64(dst, src)                                c89atomic_xor_fetch_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_and_fetch_8( dst, src)                                c89atomic_and_fetch_explicit_8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_16(dst, src)                                c89atomic_and_fetch_explicit_16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_32(dst, src)                                c89atomic_and_fetch_explicit_32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_64(dst, src)                                c89atomic_and_fetch_explicit_64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_add_fetch_i8( dst, src)                               c89atomic_add_fetch_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_i16(dst, src)                               c89atomic_add_fetch_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_i32(dst, src)                               c89atomic_add_fetch_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_add_fetch_i64(dst, src)                               c89atomic_add_fetch_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_sub_fetch_i8( dst, src)                               c89atomic_sub_fetch_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_i16(dst, src)                               c89atomic_sub_fetch_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_i32(dst, src)                               c89atomic_sub_fetch_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_sub_fetch_i64(dst, src)                               c89atomic_sub_fetch_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_or_fetch_i8( dst, src)                                c89atomic_or_fetch_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_i16(dst, src)                                c89atomic_or_fetch_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_i32(dst, src)                                c89atomic_or_fetch_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_or_fetch_i64(dst, src)                                c89atomic_or_fetch_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_xor_fetch_i8( dst, src)                               c89atomic_xor_fetch_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_i16(dst, src)                               c89atomic_xor_fetch_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_i32(dst, src)                               c89atomic_xor_fetch_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_xor_fetch_i64(dst, src)                               c89atomic_xor_fetch_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_and_fetch_i8( dst, src)                               c89atomic_and_fetch_explicit_i8( dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_i16(dst, src)                               c89atomic_and_fetch_explicit_i16(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_i32(dst, src)                               c89atomic_and_fetch_explicit_i32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_and_fetch_i64(dst, src)                               c89atomic_and_fetch_explicit_i64(dst, src, c89atomic_memory_order_seq_cst)
+/* END c89atomic_rmw.h */
+
+
+/* BEG c89atomic_bit.h */
+/*
+Atomically sets, clears or flips a single bit and returns whether or not the bit was previously set.
+The bit index is zero based, starting from the least significant bit, and is masked to the size of the
+object, so 32 is the same as 0 for the 32-bit versions.
+
+On x86 these use `lock bts`, `lock btr` and `lock btc` which means there's no need for a compare-exchange
+loop, even when other threads are modifying different bits in the same word. Modern GCC and Clang will
+generate these instructions by themselves from the fetch_or/fetch_and/fetch_xor pattern used elsewhere.
+*/
+#if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+    #define C89ATOMIC_BT_GCC_X86(instruction, instructionSizeSuffix, result, dst, bitIndex) \
+        __asm__ __volatile__(                                           \
+            "lock; " instruction instructionSizeSuffix " %2, %1\n\t"    \
+            "setc %0"                                                   \
+            : "=q"(result),     /* %0 */                                \
+              "=m"(*dst)        /* %1 */                                \
+            : "r"(bitIndex),    /* %2 */                                \
+              "m"(*dst)         /* %3 */                                \
+            : "cc", "memory")
+#endif
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_set_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 31;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_32) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+    {
+        c89atomic_uint8 result;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("bts", "l", result, dst, bitIndex);
+
+        return (c89atomic_bool)result;
+    }
+    #elif defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC)
+    {
+        (void)order;
+        return (c89atomic_bool)_interlockedbittestandset((volatile long*)dst, (long)bitIndex);
+    }
+    #elif defined(C89ATOMIC_LEGACY_MSVC_ASM) && defined(C89ATOMIC_IS_LOCK_FREE_32)
+    {
+        c89atomic_uint8 result = 0;
+
+        (void)order;
+        __asm {
+            mov ecx, dst
+            mov eax, bitIndex
+            lock bts [ecx], eax
+            setc result
+        }
+
+        return (c89atomic_bool)result;
+    }
+    #else
+    {
+        c89atomic_uint32 mask = (c89atomic_uint32)1 << bitIndex;
+        return (c89atomic_fetch_or_explicit_32(dst, mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_set_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 63;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+    {
+        c89atomic_uint8 result;
+        c89atomic_uint64 bitIndex64 = bitIndex;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("bts", "q", result, dst, bitIndex64);
+
+        return (c89atomic_bool)result;
+    }
+    #elif (defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC)) && (defined(C89ATOMIC_X64) || defined(C89ATOMIC_ARM64))
+    {
+        (void)order;
+        return (c89atomic_bool)_interlockedbittestandset64((volatile __int64*)dst, (__int64)bitIndex);
+    }
+    #else
+    {
+        c89atomic_uint64 mask = (c89atomic_uint64)1 << bitIndex;
+        return (c89atomic_fetch_or_explicit_64(dst, mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_reset_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 31;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_32) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+    {
+        c89atomic_uint8 result;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("btr", "l", result, dst, bitIndex);
+
+        return (c89atomic_bool)result;
+    }
+    #elif defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC)
+    {
+        (void)order;
+        return (c89atomic_bool)_interlockedbittestandreset((volatile long*)dst, (long)bitIndex);
+    }
+    #elif defined(C89ATOMIC_LEGACY_MSVC_ASM) && defined(C89ATOMIC_IS_LOCK_FREE_32)
+    {
+        c89atomic_uint8 result = 0;
+
+        (void)order;
+        __asm {
+            mov ecx, dst
+            mov eax, bitIndex
+            lock btr [ecx], eax
+            setc result
+        }
+
+        return (c89atomic_bool)result;
+    }
+    #else
+    {
+        c89atomic_uint32 mask = (c89atomic_uint32)1 << bitIndex;
+        return (c89atomic_fetch_and_explicit_32(dst, ~mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_reset_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 63;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+    {
+        c89atomic_uint8 result;
+        c89atomic_uint64 bitIndex64 = bitIndex;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("btr", "q", result, dst, bitIndex64);
+
+        return (c89atomic_bool)result;
+    }
+    #elif (defined(C89ATOMIC_MODERN_MSVC) || defined(C89ATOMIC_LEGACY_MSVC)) && (defined(C89ATOMIC_X64) || defined(C89ATOMIC_ARM64))
+    {
+        (void)order;
+        return (c89atomic_bool)_interlockedbittestandreset64((volatile __int64*)dst, (__int64)bitIndex);
+    }
+    #else
+    {
+        c89atomic_uint64 mask = (c89atomic_uint64)1 << bitIndex;
+        return (c89atomic_fetch_and_explicit_64(dst, ~mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_complement_explicit_32(volatile c89atomic_uint32* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 31;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_32) && (defined(C89ATOMIC_X86) || defined(C89ATOMIC_X64))
+    {
+        c89atomic_uint8 result;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("btc", "l", result, dst, bitIndex);
+
+        return (c89atomic_bool)result;
+    }
+    #elif defined(C89ATOMIC_LEGACY_MSVC_ASM) && defined(C89ATOMIC_IS_LOCK_FREE_32)
+    {
+        c89atomic_uint8 result = 0;
+
+        (void)order;
+        __asm {
+            mov ecx, dst
+            mov eax, bitIndex
+            lock btc [ecx], eax
+            setc result
+        }
+
+        return (c89atomic_bool)result;
+    }
+    #else
+    {
+        c89atomic_uint32 mask = (c89atomic_uint32)1 << bitIndex;
+        return (c89atomic_fetch_xor_explicit_32(dst, mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_bit_test_and_complement_explicit_64(volatile c89atomic_uint64* dst, c89atomic_uint32 bitIndex, c89atomic_memory_order order)
+{
+    bitIndex &= 63;
+
+    #if (defined(C89ATOMIC_LEGACY_GCC) || defined(C89ATOMIC_LEGACY_GCC_ASM)) && defined(C89ATOMIC_IS_LOCK_FREE_64) && defined(C89ATOMIC_X64)
+    {
+        c89atomic_uint8 result;
+        c89atomic_uint64 bitIndex64 = bitIndex;
+
+        (void)order;
+        C89ATOMIC_BT_GCC_X86("btc", "q", result, dst, bitIndex64);
+
+        return (c89atomic_bool)result;
+    }
+    #else
+    {
+        c89atomic_uint64 mask = (c89atomic_uint64)1 << bitIndex;
+        return (c89atomic_fetch_xor_explicit_64(dst, mask, order) & mask) != 0;
+    }
+    #endif
+}
+
+#define c89atomic_bit_test_and_set_32(dst, bitIndex)                    c89atomic_bit_test_and_set_explicit_32(dst, bitIndex, c89atomic_memory_order_seq_cst)
+#define c89atomic_bit_test_and_set_64(dst, bitIndex)                    c89atomic_bit_test_and_set_explicit_64(dst, bitIndex, c89atomic_memory_order_seq_cst)
+#define c89atomic_bit_test_and_reset_32(dst, bitIndex)                  c89atomic_bit_test_and_reset_explicit_32(dst, bitIndex, c89atomic_memory_order_seq_cst)
+#define c89atomic_bit_test_and_reset_64(dst, bitIndex)                  c89atomic_bit_test_and_reset_explicit_64(dst, bitIndex, c89atomic_memory_order_seq_cst)
+#define c89atomic_bit_test_and_complement_32(dst, bitIndex)             c89atomic_bit_test_and_complement_explicit_32(dst, bitIndex, c89atomic_memory_order_seq_cst)
+#define c89atomic_bit_test_and_complement_64(dst, bitIndex)             c89atomic_bit_test_and_complement_explicit_64(dst, bitIndex, c89atomic_memory_order_seq_cst)
+/* END c89atomic_bit.h */
+
+
+/* BEG c89atomic_float.h */
+/* Floating Point Explicit. */
+typedef union
+{
+    c89atomic_uint32 i;
+    float f;
+} c89atomic_if32;
+
+typedef union
+{
+    c89atomic_uint64 i;
+    double f;
+} c89atomic_if64;
+
+#define c89atomic_clear_explicit_f32(ptr, order)                        c89atomic_clear_explicit_32((c89atomic_uint32*)ptr, order)
+#define c89atomic_clear_explicit_f64(ptr, order)                        c89atomic_clear_explicit_64((c89atomic_uint64*)ptr, order)
+
+static C89ATOMIC_INLINE void c89atomic_store_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
+{
+    c89atomic_if32 x;
+    x.f = src;
     c89atomic_store_explicit_32((volatile c89atomic_uint32*)dst, x.i, order);
 }
 
@@ -4051,71 +6621,156 @@ static C89ATOMIC_INLINE double c89atomic_exchange_explicit_f64(volatile double*
 }
 
 
-static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_explicit_f32(volatile float* dst, float* expected, float replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_explicit_f32(volatile float* dst, float* expected, float replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_if32 d;
+    d.f = replacement;
+    return c89atomic_compare_exchange_strong_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32*)expected, d.i, successOrder, failureOrder);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_explicit_f64(volatile double* dst, double* expected, double replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_if64 d;
+    d.f = replacement;
+    return c89atomic_compare_exchange_strong_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64*)expected, d.i, successOrder, failureOrder);
+}
+
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_weak_explicit_f32(volatile float* dst, float* expected, float replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_if32 d;
+    d.f = replacement;
+    return c89atomic_compare_exchange_weak_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32*)expected, d.i, successOrder, failureOrder);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_weak_explicit_f64(volatile double* dst, double* expected, double replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_if64 d;
+    d.f = replacement;
+    return c89atomic_compare_exchange_weak_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64*)expected, d.i, successOrder, failureOrder);
+}
+
+
+/*
+Floating point arithmetic cannot be done on the integer representation so these are implemented with a
+compare-exchange loop. The compare is done on the bit pattern rather than the float value which means a
+NaN or a negative zero in the object will not cause the loop to spin forever.
+*/
+#define C89ATOMIC_FETCH_OP_FLOAT_CAS(sizeInBits, dst, order, newValueExpr) \
+    c89atomic_if##sizeInBits oldValue; \
+    c89atomic_if##sizeInBits newValue; \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    oldValue.i = c89atomic_load_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, c89atomic_memory_order_relaxed); \
+    for (;;) { \
+        newValue.f = newValueExpr; \
+        if (c89atomic_compare_exchange_weak_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, &oldValue.i, newValue.i, order, c89atomic_memory_order_relaxed)) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    }
+
+/*
+Min and max follow the rules of fmin() and fmax() in that a NaN is treated as missing data. A NaN src
+will never be stored, and a NaN in the object will always be replaced. When the object does not need
+to be changed nothing is written and the operation is just a load.
+*/
+#define C89ATOMIC_FETCH_MINMAX_FLOAT_CAS(sizeInBits, dst, src, order, cmp) \
+    c89atomic_if##sizeInBits oldValue; \
+    c89atomic_if##sizeInBits newValue; \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    newValue.f = src; \
+    oldValue.i = c89atomic_load_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, C89ATOMIC_RMW_LOAD_ORDER(order)); \
+    for (;;) { \
+        if (!(newValue.f cmp oldValue.f) && !(oldValue.f != oldValue.f && newValue.f == newValue.f)) { \
+            break; \
+        } \
+        if (c89atomic_compare_exchange_weak_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, &oldValue.i, newValue.i, order, C89ATOMIC_RMW_LOAD_ORDER(order))) { \
+            break; \
+        } \
+        c89atomic_backoff_spin(&backoff); \
+    } \
+    return oldValue.f
+
+
+static C89ATOMIC_INLINE float c89atomic_fetch_add_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
+{
+    C89ATOMIC_FETCH_OP_FLOAT_CAS(32, dst, order, oldValue.f + src);
+    return oldValue.f;
+}
+
+static C89ATOMIC_INLINE double c89atomic_fetch_add_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
+{
+    C89ATOMIC_FETCH_OP_FLOAT_CAS(64, dst, order, oldValue.f + src);
+    return oldValue.f;
+}
+
+
+static C89ATOMIC_INLINE float c89atomic_fetch_sub_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
 {
-    c89atomic_if32 d;
-    d.f = replacement;
-    return c89atomic_compare_exchange_strong_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32*)expected, d.i, successOrder, failureOrder);
+    C89ATOMIC_FETCH_OP_FLOAT_CAS(32, dst, order, oldValue.f - src);
+    return oldValue.f;
 }
 
-static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_strong_explicit_f64(volatile double* dst, double* expected, double replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+static C89ATOMIC_INLINE double c89atomic_fetch_sub_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
 {
-    c89atomic_if64 d;
-    d.f = replacement;
-    return c89atomic_compare_exchange_strong_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64*)expected, d.i, successOrder, failureOrder);
+    C89ATOMIC_FETCH_OP_FLOAT_CAS(64, dst, order, oldValue.f - src);
+    return oldValue.f;
 }
 
 
-static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_weak_explicit_f32(volatile float* dst, float* expected, float replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+static C89ATOMIC_INLINE float c89atomic_fetch_min_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
 {
-    c89atomic_if32 d;
-    d.f = replacement;
-    return c89atomic_compare_exchange_weak_explicit_32((volatile c89atomic_uint32*)dst, (c89atomic_uint32*)expected, d.i, successOrder, failureOrder);
+    C89ATOMIC_FETCH_MINMAX_FLOAT_CAS(32, dst, src, order, <);
 }
 
-static C89ATOMIC_INLINE c89atomic_bool c89atomic_compare_exchange_weak_explicit_f64(volatile double* dst, double* expected, double replacement, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+static C89ATOMIC_INLINE double c89atomic_fetch_min_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
 {
-    c89atomic_if64 d;
-    d.f = replacement;
-    return c89atomic_compare_exchange_weak_explicit_64((volatile c89atomic_uint64*)dst, (c89atomic_uint64*)expected, d.i, successOrder, failureOrder);
+    C89ATOMIC_FETCH_MINMAX_FLOAT_CAS(64, dst, src, order, <);
 }
 
 
-static C89ATOMIC_INLINE float c89atomic_fetch_add_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
+static C89ATOMIC_INLINE float c89atomic_fetch_max_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
 {
-    c89atomic_if32 r;
-    c89atomic_if32 x;
-    x.f = src;
-    r.i = c89atomic_fetch_add_explicit_32((volatile c89atomic_uint32*)dst, x.i, order);
-    return r.f;
+    C89ATOMIC_FETCH_MINMAX_FLOAT_CAS(32, dst, src, order, >);
 }
 
-static C89ATOMIC_INLINE double c89atomic_fetch_add_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
+static C89ATOMIC_INLINE double c89atomic_fetch_max_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
 {
-    c89atomic_if64 r;
-    c89atomic_if64 x;
-    x.f = src;
-    r.i = c89atomic_fetch_add_explicit_64((volatile c89atomic_uint64*)dst, x.i, order);
-    return r.f;
+    C89ATOMIC_FETCH_MINMAX_FLOAT_CAS(64, dst, src, order, >);
 }
 
 
-static C89ATOMIC_INLINE float c89atomic_fetch_sub_explicit_f32(volatile float* dst, float src, c89atomic_memory_order order)
+/*
+Accumulation for things like metrics where many threads add to the same value and nobody needs the
+previous value. This is relaxed, so it gives no ordering guarantees with respect to other memory, and
+under contention it backs off harder than c89atomic_fetch_add_explicit_f32() so that threads spend
+less time fighting over the cache line. Use c89atomic_load_explicit_f32() to read the total.
+*/
+#define C89ATOMIC_ACCUMULATE_FLOAT_CAS(sizeInBits, dst, src) \
+    c89atomic_if##sizeInBits oldValue; \
+    c89atomic_if##sizeInBits newValue; \
+    c89atomic_backoff backoff; \
+    c89atomic_backoff_init(&backoff); \
+    oldValue.i = c89atomic_load_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, c89atomic_memory_order_relaxed); \
+    for (;;) { \
+        newValue.f = oldValue.f + src; \
+        if (c89atomic_compare_exchange_weak_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, &oldValue.i, newValue.i, c89atomic_memory_order_relaxed, c89atomic_memory_order_relaxed)) { \
+            break; \
+        } \
+        c89atomic_backoff_snooze(&backoff); \
+        oldValue.i = c89atomic_load_explicit_##sizeInBits((volatile c89atomic_uint##sizeInBits*)dst, c89atomic_memory_order_relaxed); \
+    }
+
+static C89ATOMIC_INLINE void c89atomic_accumulate_f32(volatile float* dst, float src)
 {
-    c89atomic_if32 r;
-    c89atomic_if32 x;
-    x.f = src;
-    r.i = c89atomic_fetch_sub_explicit_32((volatile c89atomic_uint32*)dst, x.i, order);
-    return r.f;
+    C89ATOMIC_ACCUMULATE_FLOAT_CAS(32, dst, src);
 }
 
-static C89ATOMIC_INLINE double c89atomic_fetch_sub_explicit_f64(volatile double* dst, double src, c89atomic_memory_order order)
+static C89ATOMIC_INLINE void c89atomic_accumulate_f64(volatile double* dst, double src)
 {
-    c89atomic_if64 r;
-    c89atomic_if64 x;
-    x.f = src;
-    r.i = c89atomic_fetch_sub_explicit_64((volatile c89atomic_uint64*)dst, x.i, order);
-    return r.f;
+    C89ATOMIC_ACCUMULATE_FLOAT_CAS(64, dst, src);
 }
 
 
@@ -4202,6 +6857,12 @@ static C89ATOMIC_INLINE double c89atomic_fetch_and_explicit_f64(volatile double*
 #define c89atomic_fetch_sub_f32(dst, src)                               c89atomic_fetch_sub_explicit_f32(dst, src, c89atomic_memory_order_seq_cst)
 #define c89atomic_fetch_sub_f64(dst, src)                               c89atomic_fetch_sub_explicit_f64(dst, src, c89atomic_memory_order_seq_cst)
 
+#define c89atomic_fetch_min_f32(dst, src)                               c89atomic_fetch_min_explicit_f32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_min_f64(dst, src)                               c89atomic_fetch_min_explicit_f64(dst, src, c89atomic_memory_order_seq_cst)
+
+#define c89atomic_fetch_max_f32(dst, src)                               c89atomic_fetch_max_explicit_f32(dst, src, c89atomic_memory_order_seq_cst)
+#define c89atomic_fetch_max_f64(dst, src)                               c89atomic_fetch_max_explicit_f64(dst, src, c89atomic_memory_order_seq_cst)
+
 #define c89atomic_fetch_or_f32(dst, src)                                c89atomic_fetch_or_explicit_f32(dst, src, c89atomic_memory_order_seq_cst)
 #define c89atomic_fetch_or_f64(dst, src)                                c89atomic_fetch_or_explicit_f64(dst, src, c89atomic_memory_order_seq_cst)
 
@@ -4233,6 +6894,522 @@ static C89ATOMIC_INLINE double c89atomic_compare_and_swap_f64(volatile double* d
 /* END c89atomic_float.h */
 
 
+/* BEG c89atomic_ticket_lock.h */
+/*
+A ticket lock. Threads are granted the lock in the order they called c89atomic_ticket_lock_lock() so
+unlike c89atomic_spinlock, no thread can be starved. All waiters still spin on the same cache line so
+under heavy contention consider c89atomic_mcs_lock instead.
+
+Initialize the lock by zeroing it.
+*/
+typedef struct
+{
+    c89atomic_uint32 nextTicket;
+    c89atomic_uint32 nowServing;
+} c89atomic_ticket_lock;
+
+static C89ATOMIC_INLINE void c89atomic_ticket_lock_lock(c89atomic_ticket_lock* pLock)
+{
+    c89atomic_backoff backoff;
+    c89atomic_uint32 ticket = c89atomic_fetch_add_explicit_32(&pLock->nextTicket, 1, c89atomic_memory_order_relaxed);
+
+    c89atomic_backoff_init(&backoff);
+
+    while (c89atomic_load_explicit_32(&pLock->nowServing, c89atomic_memory_order_acquire) != ticket) {
+        c89atomic_backoff_snooze(&backoff);
+    }
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_ticket_lock_trylock(c89atomic_ticket_lock* pLock)
+{
+    /*
+    We can only take a ticket if it would be served immediately. The load of nowServing needs to be an
+    acquire because that's what pairs with the release in unlock. The acquire on the compare-exchange
+    doesn't help here because it's on nextTicket which the previous owner never wrote to.
+    */
+    c89atomic_uint32 nowServing = c89atomic_load_explicit_32(&pLock->nowServing, c89atomic_memory_order_acquire);
+    c89atomic_uint32 expected   = nowServing;
+
+    return c89atomic_compare_exchange_strong_explicit_32(&pLock->nextTicket, &expected, nowServing + 1, c89atomic_memory_order_acquire, c89atomic_memory_order_relaxed);
+}
+
+static C89ATOMIC_INLINE void c89atomic_ticket_lock_unlock(c89atomic_ticket_lock* pLock)
+{
+    /* Only the owner writes to nowServing so this doesn't need to be a read-modify-write. */
+    c89atomic_uint32 nowServing = c89atomic_load_explicit_32(&pLock->nowServing, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pLock->nowServing, nowServing + 1, c89atomic_memory_order_release);
+}
+/* END c89atomic_ticket_lock.h */
+
+/* BEG c89atomic_mcs_lock.h */
+/*
+An MCS queue lock. Each waiter spins on a flag in its own node rather than on the lock itself so
+handing the lock over only touches the cache line of the next waiter in the queue. Like the ticket
+lock, waiters are granted the lock in the order they arrived.
+
+Each call to c89atomic_mcs_lock_lock() or a successful call to c89atomic_mcs_lock_trylock() needs a
+node which must stay alive until the matching c89atomic_mcs_lock_unlock(). The node is usually just a
+local variable. The node is padded to a cache line so that waiters don't share a cache line with each
+other, but you'll need to make sure it's aligned yourself if that matters to you.
+
+Initialize the lock by zeroing it.
+*/
+typedef struct c89atomic_mcs_node c89atomic_mcs_node;
+struct c89atomic_mcs_node
+{
+    c89atomic_mcs_node* pNext;
+    c89atomic_uint32 locked;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(void*) - sizeof(c89atomic_uint32)];
+};
+
+typedef struct
+{
+    c89atomic_mcs_node* pTail;
+} c89atomic_mcs_lock;
+
+static C89ATOMIC_INLINE void c89atomic_mcs_lock_lock(c89atomic_mcs_lock* pLock, c89atomic_mcs_node* pNode)
+{
+    c89atomic_mcs_node* pPrev;
+
+    c89atomic_store_explicit_ptr((volatile void**)&pNode->pNext, (void*)0, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pNode->locked, 1, c89atomic_memory_order_relaxed);
+
+    pPrev = (c89atomic_mcs_node*)c89atomic_exchange_explicit_ptr((volatile void**)&pLock->pTail, pNode, c89atomic_memory_order_acq_rel);
+    if (pPrev != 0) {
+        c89atomic_backoff backoff;
+        c89atomic_backoff_init(&backoff);
+
+        /* Join the queue and wait for the previous owner to hand the lock over to us. */
+        c89atomic_store_explicit_ptr((volatile void**)&pPrev->pNext, pNode, c89atomic_memory_order_release);
+
+        while (c89atomic_load_explicit_32(&pNode->locked, c89atomic_memory_order_acquire) != 0) {
+            c89atomic_backoff_snooze(&backoff);
+        }
+    }
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_mcs_lock_trylock(c89atomic_mcs_lock* pLock, c89atomic_mcs_node* pNode)
+{
+    void* pExpected = (void*)0;
+
+    c89atomic_store_explicit_ptr((volatile void**)&pNode->pNext, (void*)0, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pNode->locked, 0, c89atomic_memory_order_relaxed);
+
+    return c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pLock->pTail, &pExpected, pNode, c89atomic_memory_order_acquire, c89atomic_memory_order_relaxed);
+}
+
+static C89ATOMIC_INLINE void c89atomic_mcs_lock_unlock(c89atomic_mcs_lock* pLock, c89atomic_mcs_node* pNode)
+{
+    c89atomic_mcs_node* pNext = (c89atomic_mcs_node*)c89atomic_load_explicit_ptr((volatile void**)&pNode->pNext, c89atomic_memory_order_acquire);
+
+    if (pNext == 0) {
+        void* pExpected = pNode;
+
+        /* If we're still the tail there's nobody waiting and we can just clear the lock. */
+        if (c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pLock->pTail, &pExpected, (void*)0, c89atomic_memory_order_release, c89atomic_memory_order_relaxed)) {
+            return;
+        }
+
+        /* Somebody has swapped themselves in as the tail, but hasn't linked themselves to us yet. */
+        for (;;) {
+            pNext = (c89atomic_mcs_node*)c89atomic_load_explicit_ptr((volatile void**)&pNode->pNext, c89atomic_memory_order_acquire);
+            if (pNext != 0) {
+                break;
+            }
+
+            c89atomic_cpu_relax();
+        }
+    }
+
+    c89atomic_store_explicit_32(&pNext->locked, 0, c89atomic_memory_order_release);
+}
+/* END c89atomic_mcs_lock.h */
+
+/* BEG c89atomic_seqlock.h */
+/*
+A sequence lock. This is for data that is read often and written rarely. Readers never write to the
+lock which means they don't take ownership of its cache line and therefore don't slow each other
+down. Writers are serialized with a spinlock. A reader looks like this:
+
+    c89atomic_uint32 seq;
+    do {
+        seq = c89atomic_seqlock_read_begin(&lock);
+        a = c89atomic_load_explicit_32(&data.a, c89atomic_memory_order_relaxed);
+        b = c89atomic_load_explicit_32(&data.b, c89atomic_memory_order_relaxed);
+    } while (c89atomic_seqlock_read_retry(&lock, seq));
+
+A reader can see a partially written state between read_begin() and read_retry() so nothing read
+inside the loop should be acted upon until read_retry() returns false. For the same reason the data
+should be read with relaxed atomic loads rather than plain loads.
+
+Writers wrap their changes in c89atomic_seqlock_write_lock() and c89atomic_seqlock_write_unlock().
+Writers can use plain stores.
+
+Initialize the lock by zeroing it.
+*/
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_seqlock_read_begin(c89atomic_seqlock* pSeqlock)
+{
+    c89atomic_backoff backoff;
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_uint32 sequence = c89atomic_load_explicit_32(&pSeqlock->sequence, c89atomic_memory_order_acquire);
+        if ((sequence & 1) == 0) {
+            return sequence;
+        }
+
+        /* A write is in progress. */
+        c89atomic_backoff_snooze(&backoff);
+    }
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_seqlock_read_retry(c89atomic_seqlock* pSeqlock, c89atomic_uint32 sequence)
+{
+    /* The fence stops the reads of the data from being moved below the second read of the sequence. */
+    c89atomic_thread_fence(c89atomic_memory_order_acquire);
+    return c89atomic_load_explicit_32(&pSeqlock->sequence, c89atomic_memory_order_relaxed) != sequence;
+}
+
+/* These are for when the spinlock is already held. The emulated 64-bit operations use these. */
+static C89ATOMIC_INLINE void c89atomic_seqlock_write_begin_locked(c89atomic_seqlock* pSeqlock)
+{
+    /* Only the holder of the lock writes to the sequence so this doesn't need to be a read-modify-write. */
+    c89atomic_uint32 sequence = c89atomic_load_explicit_32(&pSeqlock->sequence, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pSeqlock->sequence, sequence + 1, c89atomic_memory_order_relaxed);
+
+    /* The fence stops the writes to the data from being moved above the change to the sequence. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+}
+
+static C89ATOMIC_INLINE void c89atomic_seqlock_write_end_locked(c89atomic_seqlock* pSeqlock)
+{
+    c89atomic_uint32 sequence = c89atomic_load_explicit_32(&pSeqlock->sequence, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pSeqlock->sequence, sequence + 1, c89atomic_memory_order_release);
+}
+
+static C89ATOMIC_INLINE void c89atomic_seqlock_write_lock(c89atomic_seqlock* pSeqlock)
+{
+    c89atomic_spinlock_lock(&pSeqlock->lock);
+    c89atomic_seqlock_write_begin_locked(pSeqlock);
+}
+
+static C89ATOMIC_INLINE void c89atomic_seqlock_write_unlock(c89atomic_seqlock* pSeqlock)
+{
+    c89atomic_seqlock_write_end_locked(pSeqlock);
+    c89atomic_spinlock_unlock(&pSeqlock->lock);
+}
+
+#if defined(C89ATOMIC_SEQLOCK_LOAD_64)
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_seqlock_load_explicit_64(volatile const c89atomic_uint64* ptr, c89atomic_memory_order order)
+{
+    c89atomic_seqlock* pSeqlock = c89atomic_get_address_seqlock(ptr);
+    volatile const c89atomic_uint32* pHalves = (volatile const c89atomic_uint32*)ptr;
+    c89atomic_uint32 sequence;
+    union
+    {
+        c89atomic_uint32 halves[2];
+        c89atomic_uint64 value;
+    } result;
+
+    if (order == c89atomic_memory_order_seq_cst) {
+        c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+    }
+
+    do {
+        sequence = c89atomic_seqlock_read_begin(pSeqlock);
+        result.halves[0] = c89atomic_load_explicit_32(&pHalves[0], c89atomic_memory_order_relaxed);
+        result.halves[1] = c89atomic_load_explicit_32(&pHalves[1], c89atomic_memory_order_relaxed);
+    } while (c89atomic_seqlock_read_retry(pSeqlock, sequence));
+
+    return result.value;
+}
+#endif
+/* END c89atomic_seqlock.h */
+
+/* BEG c89atomic_shard.h */
+/*
+Sharded data structures such as c89atomic_rwlock and c89atomic_counter need to spread threads across
+their shards. By default the address of the calling thread's stack is hashed, which is a cheap and
+portable stand-in for a thread ID. Threads that happen to hash to the same shard still work correctly,
+they just share a cache line.
+
+If you have a cheap way of getting the current CPU you can plug it in by defining
+C89ATOMIC_CURRENT_CPU() before including this file. With glibc you could use sched_getcpu(). This
+keeps threads on the same core on the same shard, which is better when there are more threads than
+cores.
+*/
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_get_shard_index(void)
+{
+#if defined(C89ATOMIC_CURRENT_CPU)
+    return (c89atomic_uint32)C89ATOMIC_CURRENT_CPU();
+#else
+    /* Thread stacks are normally at least a page apart so the bits above the page offset are what differ between threads. */
+    c89atomic_uint32 local;
+    c89atomic_uintptr address = (c89atomic_uintptr)&local;
+
+    return (c89atomic_uint32)((address >> 12) ^ (address >> 16) ^ (address >> 20));
+#endif
+}
+/* END c89atomic_shard.h */
+
+/* BEG c89atomic_rwlock.h */
+/*
+A reader-writer lock for data that is read from many threads at the same time. Rather than having
+every reader increment the same counter, readers are spread across C89ATOMIC_RWLOCK_SLOT_COUNT
+counters which are each on their own cache line. This means readers on different threads don't
+usually fight over the same cache line. The cost is that a writer needs to check every slot, and the
+lock is quite large (one cache line per slot, plus one for the writer).
+
+The lock prefers writers. Once a writer has announced itself, new readers will wait until it's done
+which means a steady stream of readers cannot starve a writer. Writers are serialized with each
+other in the same way as c89atomic_spinlock.
+
+c89atomic_rwlock_read_lock() returns the slot the reader was placed in. This needs to be passed to
+c89atomic_rwlock_read_unlock(). The slot is picked with c89atomic_get_shard_index().
+
+A reader can try to become a writer with c89atomic_rwlock_try_upgrade(). This will fail if another
+writer got in first, in which case the read lock is still held and you'll need to release it before
+taking the write lock. On success it waits for all other readers to leave, so don't call it while the
+same thread holds a second read lock. A writer can become a reader without letting any other writer in between with
+c89atomic_rwlock_downgrade().
+
+Initialize the lock by zeroing it.
+*/
+#ifndef C89ATOMIC_RWLOCK_SLOT_COUNT
+#define C89ATOMIC_RWLOCK_SLOT_COUNT 8   /* Must be a power of 2. */
+#endif
+
+typedef struct
+{
+    c89atomic_uint32 readers;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_uint32)];
+} c89atomic_rwlock_slot;
+
+typedef struct
+{
+    c89atomic_uint32 writer;    /* Non-zero when a writer holds the lock or is waiting for readers to leave. */
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_uint32)];
+    c89atomic_rwlock_slot slots[C89ATOMIC_RWLOCK_SLOT_COUNT];
+} c89atomic_rwlock;
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_rwlock_read_lock(c89atomic_rwlock* pLock)
+{
+    c89atomic_uint32 slot = c89atomic_get_shard_index() & (C89ATOMIC_RWLOCK_SLOT_COUNT - 1);
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        /* Don't bother registering ourselves while a writer is around. */
+        while (c89atomic_load_explicit_32(&pLock->writer, c89atomic_memory_order_relaxed) != 0) {
+            c89atomic_backoff_snooze(&backoff);
+        }
+
+        /*
+        The increment needs to be visible before we check the writer flag, and the writer sets its
+        flag before checking the slots. That way at least one of us will see the other.
+        */
+        c89atomic_fetch_add_explicit_32(&pLock->slots[slot].readers, 1, c89atomic_memory_order_seq_cst);
+        if (c89atomic_load_explicit_32(&pLock->writer, c89atomic_memory_order_seq_cst) == 0) {
+            return slot;
+        }
+
+        /* A writer got in first. Back out and let it through. */
+        c89atomic_fetch_sub_explicit_32(&pLock->slots[slot].readers, 1, c89atomic_memory_order_release);
+    }
+}
+
+static C89ATOMIC_INLINE void c89atomic_rwlock_read_unlock(c89atomic_rwlock* pLock, c89atomic_uint32 slot)
+{
+    c89atomic_fetch_sub_explicit_32(&pLock->slots[slot].readers, 1, c89atomic_memory_order_release);
+}
+
+static C89ATOMIC_INLINE void c89atomic_rwlock_wait_for_readers(c89atomic_rwlock* pLock)
+{
+    c89atomic_uint32 slot;
+
+    for (slot = 0; slot < C89ATOMIC_RWLOCK_SLOT_COUNT; slot += 1) {
+        c89atomic_backoff backoff;
+        c89atomic_backoff_init(&backoff);
+
+        while (c89atomic_load_explicit_32(&pLock->slots[slot].readers, c89atomic_memory_order_seq_cst) != 0) {
+            c89atomic_backoff_snooze(&backoff);
+        }
+    }
+}
+
+static C89ATOMIC_INLINE void c89atomic_rwlock_write_lock(c89atomic_rwlock* pLock)
+{
+    c89atomic_backoff backoff;
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        if (c89atomic_exchange_explicit_32(&pLock->writer, 1, c89atomic_memory_order_seq_cst) == 0) {
+            break;
+        }
+
+        while (c89atomic_load_explicit_32(&pLock->writer, c89atomic_memory_order_relaxed) != 0) {
+            c89atomic_backoff_snooze(&backoff);
+        }
+    }
+
+    /* New readers will now stay out. We just need to wait for the existing ones to leave. */
+    c89atomic_rwlock_wait_for_readers(pLock);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_rwlock_write_trylock(c89atomic_rwlock* pLock)
+{
+    c89atomic_uint32 expected = 0;
+    c89atomic_uint32 slot;
+
+    if (!c89atomic_compare_exchange_strong_explicit_32(&pLock->writer, &expected, 1, c89atomic_memory_order_seq_cst, c89atomic_memory_order_relaxed)) {
+        return 0;
+    }
+
+    for (slot = 0; slot < C89ATOMIC_RWLOCK_SLOT_COUNT; slot += 1) {
+        if (c89atomic_load_explicit_32(&pLock->slots[slot].readers, c89atomic_memory_order_seq_cst) != 0) {
+            c89atomic_store_explicit_32(&pLock->writer, 0, c89atomic_memory_order_release);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static C89ATOMIC_INLINE void c89atomic_rwlock_write_unlock(c89atomic_rwlock* pLock)
+{
+    c89atomic_store_explicit_32(&pLock->writer, 0, c89atomic_memory_order_release);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_rwlock_try_upgrade(c89atomic_rwlock* pLock, c89atomic_uint32 slot)
+{
+    c89atomic_uint32 expected = 0;
+
+    /*
+    If another writer is already waiting it'll be waiting on us, so we can't wait on it. The caller
+    keeps their read lock in this case.
+    */
+    if (!c89atomic_compare_exchange_strong_explicit_32(&pLock->writer, &expected, 1, c89atomic_memory_order_seq_cst, c89atomic_memory_order_relaxed)) {
+        return 0;
+    }
+
+    /* We're the writer now so our own read lock can go. Then it's the same as a normal write lock. */
+    c89atomic_fetch_sub_explicit_32(&pLock->slots[slot].readers, 1, c89atomic_memory_order_relaxed);
+    c89atomic_rwlock_wait_for_readers(pLock);
+
+    return 1;
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_rwlock_downgrade(c89atomic_rwlock* pLock)
+{
+    c89atomic_uint32 slot = c89atomic_get_shard_index() & (C89ATOMIC_RWLOCK_SLOT_COUNT - 1);
+
+    /* Register as a reader before letting go of the writer flag so no other writer can get in between. */
+    c89atomic_fetch_add_explicit_32(&pLock->slots[slot].readers, 1, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pLock->writer, 0, c89atomic_memory_order_release);
+
+    return slot;
+}
+/* END c89atomic_rwlock.h */
+
+/* BEG c89atomic_counter.h */
+/*
+A counter for statistics that are incremented from many threads, but read rarely. A single counter
+that every thread increments bounces its cache line between cores on every increment. This splits
+the counter into C89ATOMIC_COUNTER_SHARD_COUNT shards, each on their own cache line, and each thread
+only increments the shard picked by c89atomic_get_shard_index(). Reading the counter needs to add up
+every shard so it is more expensive than an increment.
+
+Reads are not a snapshot. Increments that happen while a read is in progress may or may not be
+included, but c89atomic_counter_reset_and_read() never loses an increment. Each increment is either
+included in the returned value or left in the counter for the next call. This is what you want for
+reporting a count per interval.
+
+Increments are relaxed and do not synchronize with anything.
+
+Initialize the counter by zeroing it.
+*/
+#ifndef C89ATOMIC_COUNTER_SHARD_COUNT
+#define C89ATOMIC_COUNTER_SHARD_COUNT   16  /* Must be a power of 2. */
+#endif
+
+typedef struct
+{
+    c89atomic_uint64 value;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_uint64)];
+} c89atomic_counter_shard;
+
+typedef struct
+{
+    c89atomic_counter_shard shards[C89ATOMIC_COUNTER_SHARD_COUNT];
+} c89atomic_counter;
+
+static C89ATOMIC_INLINE void c89atomic_counter_add(c89atomic_counter* pCounter, c89atomic_uint64 amount)
+{
+    c89atomic_uint32 shard = c89atomic_get_shard_index() & (C89ATOMIC_COUNTER_SHARD_COUNT - 1);
+    c89atomic_fetch_add_explicit_64(&pCounter->shards[shard].value, amount, c89atomic_memory_order_relaxed);
+}
+
+static C89ATOMIC_INLINE void c89atomic_counter_increment(c89atomic_counter* pCounter)
+{
+    c89atomic_counter_add(pCounter, 1);
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_counter_read(c89atomic_counter* pCounter)
+{
+    c89atomic_uint64 sum = 0;
+    c89atomic_uint32 shard;
+
+    for (shard = 0; shard < C89ATOMIC_COUNTER_SHARD_COUNT; shard += 1) {
+        sum += c89atomic_load_explicit_64(&pCounter->shards[shard].value, c89atomic_memory_order_relaxed);
+    }
+
+    return sum;
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64 c89atomic_counter_reset_and_read(c89atomic_counter* pCounter)
+{
+    c89atomic_uint64 sum = 0;
+    c89atomic_uint32 shard;
+
+    for (shard = 0; shard < C89ATOMIC_COUNTER_SHARD_COUNT; shard += 1) {
+        /* Don't take ownership of the cache line if there's nothing to take. */
+        if (c89atomic_load_explicit_64(&pCounter->shards[shard].value, c89atomic_memory_order_relaxed) != 0) {
+            sum += c89atomic_exchange_explicit_64(&pCounter->shards[shard].value, 0, c89atomic_memory_order_relaxed);
+        }
+    }
+
+    return sum;
+}
+/* END c89atomic_counter.h */
+
+/* BEG c89atomic_wait.h */
+/*
+Waiting and notifying. These have the same semantics as C++20's `atomic::wait()`, `notify_one()` and
+`notify_all()`. `c89atomic_wait_explicit_32()` will block for as long as the value pointed to by `ptr`
+is equal to `oldValue`. Another thread changes the value and then calls one of the notify functions to
+wake the waiter(s) up.
+
+These are not inlined and are implemented in c89atomic.c because they need to talk to the OS. On Linux
+they are implemented with a futex. On other platforms the waiter will spin for a while and then fall
+back to yielding its time slice until the value changes, in which case notifying is a no-op.
+*/
+#ifndef C89ATOMIC_API
+#define C89ATOMIC_API
+#endif
+
+C89ATOMIC_API void c89atomic_wait_explicit_32(volatile c89atomic_uint32* ptr, c89atomic_uint32 oldValue, c89atomic_memory_order order);
+C89ATOMIC_API void c89atomic_notify_one_32(volatile c89atomic_uint32* ptr);
+C89ATOMIC_API void c89atomic_notify_all_32(volatile c89atomic_uint32* ptr);
+
+#define c89atomic_wait_32(ptr, oldValue)                                c89atomic_wait_explicit_32(ptr, oldValue, c89atomic_memory_order_seq_cst)
+#define c89atomic_wait_explicit_i32(ptr, oldValue, order)               c89atomic_wait_explicit_32((c89atomic_uint32*)ptr, (c89atomic_uint32)oldValue, order)
+#define c89atomic_wait_i32(ptr, oldValue)                               c89atomic_wait_explicit_i32(ptr, oldValue, c89atomic_memory_order_seq_cst)
+#define c89atomic_notify_one_i32(ptr)                                   c89atomic_notify_one_32((c89atomic_uint32*)ptr)
+#define c89atomic_notify_all_i32(ptr)                                   c89atomic_notify_all_32((c89atomic_uint32*)ptr)
+/* END c89atomic_wait.h */
+
+
 #if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)))
     #pragma GCC diagnostic pop  /* long long warnings with Clang. */
 #endif
@@ -49,10 +49,9 @@ C89ATOMIC_BITMAP_ALLOCATOR_API c89atomic_bitmap_allocator_result c89atomic_bitma
 {
     size_t i;
 
-    /* All we need to do is find the first set bit and return it's index. */
+    /* All we need to do is find the first clear bit, set it, and return it's index. */
     for (i = 0; i < pAllocator->sizeInWords; i += 1) {
         c89atomic_uint32 oldWord;
-        c89atomic_uint32 newWord;
         c89atomic_uint32 bitIndex;
 
         for (;;) {
@@ -64,9 +63,13 @@ C89ATOMIC_BITMAP_ALLOCATOR_API c89atomic_bitmap_allocator_result c89atomic_bitma
             bitIndex = c89atomic_clz_32(~oldWord);
             assert(bitIndex < 32);
 
-            newWord = oldWord | (0x80000000UL >> bitIndex);
-
-            if (c89atomic_compare_exchange_strong_explicit_32(&pAllocator->bitmap[i], &oldWord, newWord, c89atomic_memory_order_acq_rel, c89atomic_memory_order_relaxed)) {
+            /*
+            Bits are numbered from the most significant bit in the bitmap, but from the least
+            significant bit by c89atomic_bit_test_and_set_explicit_32(). We only need to try again
+            if somebody else claimed this specific bit in the meantime. Changes to other bits in the
+            word do not affect us.
+            */
+            if (!c89atomic_bit_test_and_set_explicit_32(&pAllocator->bitmap[i], 31 - bitIndex, c89atomic_memory_order_acq_rel)) {
                 *pIndex = (i * sizeof(pAllocator->bitmap[0]) * 8) + bitIndex;
                 return C89ATOMIC_BITMAP_ALLOCATOR_SUCCESS;
             }
@@ -81,8 +84,6 @@ C89ATOMIC_BITMAP_ALLOCATOR_API void c89atomic_bitmap_allocator_free(c89atomic_bi
 {
     c89atomic_uint32 wordIndex;
     c89atomic_uint32 bitIndex;
-    c89atomic_uint32 oldWord;
-    c89atomic_uint32 newWord;
 
     wordIndex = (c89atomic_uint32)((index & 0xFFFFFFFF) >> 5);   /* slot / 32 */
     bitIndex  = (c89atomic_uint32)((index & 0xFFFFFFFF) & 31);   /* slot % 32 */
@@ -92,16 +93,9 @@ C89ATOMIC_BITMAP_ALLOCATOR_API void c89atomic_bitmap_allocator_free(c89atomic_bi
         return;  /* Index out of bounds. */
     }
 
-    do
-    {
-        oldWord = c89atomic_load_explicit_32(&pAllocator->bitmap[wordIndex], c89atomic_memory_order_relaxed);
-        newWord = oldWord & ~(0x80000000UL >> bitIndex);
-
-        /* Assert to catch a double free. */
-        if ((oldWord & (0x80000000UL >> bitIndex)) == 0) {
-            assert(!"Double free detected in c89atomic_bitmap_allocator_free().");
-        }
-    } while (!c89atomic_compare_exchange_strong_explicit_32(&pAllocator->bitmap[wordIndex], &oldWord, newWord, c89atomic_memory_order_acq_rel, c89atomic_memory_order_relaxed));
+    if (!c89atomic_bit_test_and_reset_explicit_32(&pAllocator->bitmap[wordIndex], 31 - bitIndex, c89atomic_memory_order_acq_rel)) {
+        assert(!"Double free detected in c89atomic_bitmap_allocator_free().");
+    }
 }
 /* END c89atomic_bitmap_allocator.c */
 
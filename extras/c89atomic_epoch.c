@@ -0,0 +1,228 @@
+#ifndef c89atomic_epoch_c
+#define c89atomic_epoch_c
+
+#include "c89atomic_epoch.h"
+
+#include <assert.h>
+
+/* BEG c89atomic_epoch.c */
+C89ATOMIC_EPOCH_API c89atomic_epoch_result c89atomic_epoch_domain_init(c89atomic_epoch_record* pRecords, c89atomic_uint32 recordCount, c89atomic_epoch_free_proc onFree, void* pUserData, c89atomic_epoch_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+    c89atomic_uint32 iBag;
+
+    if (pDomain == NULL || pRecords == NULL || recordCount == 0 || onFree == NULL) {
+        return C89ATOMIC_EPOCH_INVALID_ARGS;
+    }
+
+    for (iRecord = 0; iRecord < recordCount; iRecord += 1) {
+        pRecords[iRecord].state               = 0;
+        pRecords[iRecord].inUse               = 0;
+        pRecords[iRecord].nestCount           = 0;
+        pRecords[iRecord].retiresSinceAdvance = 0;
+
+        for (iBag = 0; iBag < 3; iBag += 1) {
+            pRecords[iRecord].bagEpochs[iBag] = 0;
+            pRecords[iRecord].bagCounts[iBag] = 0;
+            pRecords[iRecord].pBags[iBag]     = NULL;
+        }
+    }
+
+    pDomain->epoch       = 0;
+    pDomain->pRecords    = pRecords;
+    pDomain->recordCount = recordCount;
+    pDomain->onFree      = onFree;
+    pDomain->pUserData   = pUserData;
+
+    /* Make sure other threads see the initialized records if the domain is handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_EPOCH_SUCCESS;
+}
+
+static void c89atomic_epoch_free_bag(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord, c89atomic_uint32 iBag)
+{
+    c89atomic_epoch_node* pNode = pRecord->pBags[iBag];
+
+    while (pNode != NULL) {
+        c89atomic_epoch_node* pNext = pNode->pNext;
+        pDomain->onFree(pDomain->pUserData, pNode);
+        pNode = pNext;
+    }
+
+    pRecord->pBags[iBag]     = NULL;
+    pRecord->bagCounts[iBag] = 0;
+}
+
+C89ATOMIC_EPOCH_API void c89atomic_epoch_domain_uninit(c89atomic_epoch_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+    c89atomic_uint32 iBag;
+
+    /* Nobody else is using the domain at this point so everything can be freed. */
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        for (iBag = 0; iBag < 3; iBag += 1) {
+            c89atomic_epoch_free_bag(pDomain, &pDomain->pRecords[iRecord], iBag);
+        }
+    }
+}
+
+C89ATOMIC_EPOCH_API c89atomic_epoch_result c89atomic_epoch_domain_acquire_record(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record** ppRecord)
+{
+    c89atomic_uint32 iRecord;
+
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_epoch_record* pRecord = &pDomain->pRecords[iRecord];
+        c89atomic_uint32 expected = 0;
+
+        if (c89atomic_load_explicit_32(&pRecord->inUse, c89atomic_memory_order_relaxed) != 0) {
+            continue;
+        }
+
+        /* Acquire so we see the bags left behind by the previous owner. */
+        if (c89atomic_compare_exchange_strong_explicit_32(&pRecord->inUse, &expected, 1, c89atomic_memory_order_acquire, c89atomic_memory_order_relaxed)) {
+            *ppRecord = pRecord;
+            return C89ATOMIC_EPOCH_SUCCESS;
+        }
+    }
+
+    *ppRecord = NULL;
+    return C89ATOMIC_EPOCH_OUT_OF_RECORDS;
+}
+
+C89ATOMIC_EPOCH_API void c89atomic_epoch_domain_release_record(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord)
+{
+    assert(pRecord->nestCount == 0);
+
+    /* Try to clean up while we're here. Anything left over will be picked up by the next owner. */
+    c89atomic_epoch_reclaim(pDomain, pRecord);
+
+    c89atomic_store_explicit_32(&pRecord->inUse, 0, c89atomic_memory_order_release);
+}
+
+C89ATOMIC_EPOCH_API void c89atomic_epoch_enter(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord)
+{
+    c89atomic_uint32 epoch;
+
+    pRecord->nestCount += 1;
+    if (pRecord->nestCount > 1) {
+        return;
+    }
+
+    epoch = c89atomic_load_explicit_32(&pDomain->epoch, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pRecord->state, (epoch << 1) | 1, c89atomic_memory_order_relaxed);
+
+    /*
+    Our announcement must be visible before we read anything from the data structure. This pairs with
+    the fence in c89atomic_epoch_try_advance(). It doesn't matter if the epoch has moved on since we
+    loaded it. We'll just hold back the next advance until we exit.
+    */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+}
+
+C89ATOMIC_EPOCH_API void c89atomic_epoch_exit(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord)
+{
+    (void)pDomain;
+
+    assert(pRecord->nestCount > 0);
+
+    pRecord->nestCount -= 1;
+    if (pRecord->nestCount > 0) {
+        return;
+    }
+
+    /* Release so that our reads from the data structure are done before anything gets freed. */
+    c89atomic_store_explicit_32(&pRecord->state, 0, c89atomic_memory_order_release);
+}
+
+static c89atomic_uint32 c89atomic_epoch_try_advance(c89atomic_epoch_domain* pDomain)
+{
+    c89atomic_uint32 epoch = c89atomic_load_explicit_32(&pDomain->epoch, c89atomic_memory_order_relaxed);
+    c89atomic_uint32 iRecord;
+
+    /* Pairs with the fence in c89atomic_epoch_enter(). */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+
+    /*
+    Every record is checked, even those not in use. Records that aren't in use are never inside a
+    critical section so they'll just be skipped.
+    */
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_uint32 state = c89atomic_load_explicit_32(&pDomain->pRecords[iRecord].state, c89atomic_memory_order_acquire);
+
+        if ((state & 1) != 0 && state != ((epoch << 1) | 1)) {
+            return epoch;   /* This thread hasn't seen the current epoch yet. */
+        }
+    }
+
+    /* If this fails someone else has advanced it for us. */
+    c89atomic_compare_exchange_strong_explicit_32(&pDomain->epoch, &epoch, epoch + 1, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire);
+
+    return c89atomic_load_explicit_32(&pDomain->epoch, c89atomic_memory_order_acquire);
+}
+
+static void c89atomic_epoch_collect(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord, c89atomic_uint32 epoch)
+{
+    c89atomic_uint32 iBag;
+
+    for (iBag = 0; iBag < 3; iBag += 1) {
+        if (pRecord->pBags[iBag] != NULL && (c89atomic_uint32)(epoch - pRecord->bagEpochs[iBag]) >= 2) {
+            c89atomic_epoch_free_bag(pDomain, pRecord, iBag);
+        }
+    }
+}
+
+C89ATOMIC_EPOCH_API void c89atomic_epoch_retire(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord, c89atomic_epoch_node* pNode)
+{
+    c89atomic_uint32 epoch;
+    c89atomic_uint32 iBag;
+
+    /*
+    The node was unlinked before this point, so any reader that could have seen it has announced this
+    epoch or an earlier one.
+    */
+    epoch = c89atomic_load_explicit_32(&pDomain->epoch, c89atomic_memory_order_acquire);
+
+    /* Free anything that is old enough before adding to the bag for this epoch, which might be holding nodes from 3 epochs ago. */
+    c89atomic_epoch_collect(pDomain, pRecord, epoch);
+
+    /*
+    Everything left over is from this epoch or the one before it, so at least one bag is empty. The bag
+    isn't picked with `epoch % 3` because that isn't continuous when the epoch wraps around.
+    */
+    for (iBag = 0; iBag < 3; iBag += 1) {
+        if (pRecord->pBags[iBag] != NULL && pRecord->bagEpochs[iBag] == epoch) {
+            break;
+        }
+    }
+
+    if (iBag == 3) {
+        for (iBag = 0; iBag < 3; iBag += 1) {
+            if (pRecord->pBags[iBag] == NULL) {
+                break;
+            }
+        }
+    }
+
+    assert(iBag < 3);
+
+    pNode->pNext = pRecord->pBags[iBag];
+    pRecord->pBags[iBag]      = pNode;
+    pRecord->bagEpochs[iBag]  = epoch;
+    pRecord->bagCounts[iBag] += 1;
+
+    pRecord->retiresSinceAdvance += 1;
+    if (pRecord->retiresSinceAdvance >= C89ATOMIC_EPOCH_ADVANCE_INTERVAL) {
+        pRecord->retiresSinceAdvance = 0;
+        c89atomic_epoch_collect(pDomain, pRecord, c89atomic_epoch_try_advance(pDomain));
+    }
+}
+
+C89ATOMIC_EPOCH_API c89atomic_uint32 c89atomic_epoch_reclaim(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord)
+{
+    c89atomic_epoch_collect(pDomain, pRecord, c89atomic_epoch_try_advance(pDomain));
+    return pRecord->bagCounts[0] + pRecord->bagCounts[1] + pRecord->bagCounts[2];
+}
+/* END c89atomic_epoch.c */
+
+#endif /* c89atomic_epoch_c */
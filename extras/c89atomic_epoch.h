@@ -0,0 +1,129 @@
+/*
+Epoch-based reclamation (EBR). This implements "Fraser, Practical Lock-Freedom (University of Cambridge, 2004)".
+
+This solves the same problem as hazard pointers (see c89atomic_hazard_pointers.h), which is knowing when it's safe to free a node
+that has been unlinked from a lock-free data structure. Rather than protecting each pointer individually, readers wrap their entire
+traversal in a critical section. Entering a critical section is a relaxed store and a fence, and exiting is a release store, no
+matter how many nodes are visited. This makes it much cheaper than hazard pointers for read-heavy workloads that visit lots of nodes.
+
+The downside is that a thread that stalls inside a critical section will stop every retired node from being freed, so memory usage
+is not bounded. Use hazard pointers if that's a problem.
+
+There is a global epoch which is advanced once every thread that is inside a critical section has seen the current epoch. A node
+retired during epoch E cannot be referenced by anything once the global epoch reaches E + 2, at which point it is freed. Each thread
+has three bags of retired nodes, one for each of the last three epochs.
+
+Like hazard pointers, everything lives in a domain, and each thread needs to acquire a record from the domain. You need to supply
+the memory for the records:
+
+    c89atomic_epoch_record records[16];
+    c89atomic_epoch_domain domain;
+    c89atomic_epoch_domain_init(records, 16, my_free, pMyUserData, &domain);
+
+    c89atomic_epoch_record* pRecord;
+    c89atomic_epoch_domain_acquire_record(&domain, &pRecord);
+
+Retired nodes are kept in intrusive lists so that there's no limit on how many there can be. To be able to retire an object it
+needs to have a c89atomic_epoch_node somewhere inside it. The free callback is given a pointer to this node:
+
+    typedef struct
+    {
+        c89atomic_epoch_node epochNode;
+        int value;
+        ...
+    } my_node;
+
+    static void my_free(void* pUserData, c89atomic_epoch_node* pEpochNode)
+    {
+        free((my_node*)((char*)pEpochNode - offsetof(my_node, epochNode)));
+    }
+
+Readers wrap their accesses in a critical section. Critical sections can be nested:
+
+    c89atomic_epoch_enter(&domain, pRecord);
+    {
+        ... read from the data structure ...
+    }
+    c89atomic_epoch_exit(&domain, pRecord);
+
+Writers retire nodes once they've been unlinked. This can be done inside or outside of a critical section:
+
+    c89atomic_epoch_retire(&domain, pRecord, &pUnlinkedNode->epochNode);
+
+Every C89ATOMIC_EPOCH_ADVANCE_INTERVAL retires the thread will try to advance the global epoch. This needs to check every record so
+it's spread out over a number of retires. You can also try to advance and free what you can straight away with
+c89atomic_epoch_reclaim().
+
+When a thread is finished with the domain it releases the record. This must be done outside of a critical section. Any retired nodes
+that haven't been freed stay with the record and are taken over by the next thread to acquire it. c89atomic_epoch_domain_uninit()
+frees every retired node, and must only be called once no other thread is using the domain.
+
+This does not do input parameter validation for null pointers except in c89atomic_epoch_domain_init().
+*/
+#ifndef c89atomic_epoch_h
+#define c89atomic_epoch_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_EPOCH_API
+#define C89ATOMIC_EPOCH_API
+#endif
+
+/* The number of retires between attempts to advance the global epoch. */
+#ifndef C89ATOMIC_EPOCH_ADVANCE_INTERVAL
+#define C89ATOMIC_EPOCH_ADVANCE_INTERVAL    64
+#endif
+
+typedef enum
+{
+    C89ATOMIC_EPOCH_SUCCESS = 0,
+    C89ATOMIC_EPOCH_INVALID_ARGS,
+    C89ATOMIC_EPOCH_OUT_OF_RECORDS      /* Can be returned when acquiring a record and every record is in use. */
+} c89atomic_epoch_result;
+
+
+/* BEG c89atomic_epoch.h */
+typedef struct c89atomic_epoch_node
+{
+    struct c89atomic_epoch_node* pNext;
+} c89atomic_epoch_node;
+
+typedef void (* c89atomic_epoch_free_proc)(void* pUserData, c89atomic_epoch_node* pNode);
+
+typedef struct c89atomic_epoch_record
+{
+    /* Read by every thread when advancing the epoch. */
+    c89atomic_uint32 state;     /* (epoch << 1) | 1 when inside a critical section, 0 otherwise. */
+    c89atomic_uint32 inUse;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE];
+
+    /* Only ever accessed by the thread that owns the record. */
+    c89atomic_uint32 nestCount;
+    c89atomic_uint32 retiresSinceAdvance;
+    c89atomic_uint32 bagEpochs[3];
+    c89atomic_uint32 bagCounts[3];
+    c89atomic_epoch_node* pBags[3];
+} c89atomic_epoch_record;
+
+typedef struct c89atomic_epoch_domain
+{
+    c89atomic_uint32 epoch;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE];
+    c89atomic_epoch_record* pRecords;
+    c89atomic_uint32 recordCount;
+    c89atomic_epoch_free_proc onFree;
+    void* pUserData;
+} c89atomic_epoch_domain;
+
+C89ATOMIC_EPOCH_API c89atomic_epoch_result c89atomic_epoch_domain_init(c89atomic_epoch_record* pRecords, c89atomic_uint32 recordCount, c89atomic_epoch_free_proc onFree, void* pUserData, c89atomic_epoch_domain* pDomain);
+C89ATOMIC_EPOCH_API void c89atomic_epoch_domain_uninit(c89atomic_epoch_domain* pDomain);
+C89ATOMIC_EPOCH_API c89atomic_epoch_result c89atomic_epoch_domain_acquire_record(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record** ppRecord);
+C89ATOMIC_EPOCH_API void c89atomic_epoch_domain_release_record(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord);
+C89ATOMIC_EPOCH_API void c89atomic_epoch_enter(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord);
+C89ATOMIC_EPOCH_API void c89atomic_epoch_exit(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord);
+C89ATOMIC_EPOCH_API void c89atomic_epoch_retire(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord, c89atomic_epoch_node* pNode);
+C89ATOMIC_EPOCH_API c89atomic_uint32 c89atomic_epoch_reclaim(c89atomic_epoch_domain* pDomain, c89atomic_epoch_record* pRecord);  /* Tries to advance the epoch and frees what it can. Returns the number of nodes that are still waiting. */
+/* END c89atomic_epoch.h */
+
+#endif /* c89atomic_epoch_h */
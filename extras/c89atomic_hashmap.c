@@ -0,0 +1,489 @@
+#ifndef c89atomic_hashmap_c
+#define c89atomic_hashmap_c
+
+#include "c89atomic_hashmap.h"
+
+#include <assert.h>
+
+/*
+Values are stored with 2 added to them so that 0 and 1 can be used to mean "no value yet" and "removed".
+The top bit is set when a slot has been frozen for resizing. Once a slot is frozen its value will never
+change again and the up to date value lives in the next table.
+
+A slot with a key but no value is in the middle of being inserted, or is waiting for its value to be
+moved over from the old table during a resize. Either way it's treated as if the key wasn't there.
+
+Empty slots are frozen by setting the key to C89ATOMIC_HASHMAP_FROZEN_KEY rather than by setting a bit
+in the value. Freezing and claiming an empty slot both need to be a compare-exchange on the key so that
+only one of them can happen. Otherwise a thread that doesn't know about the resize yet could put a key
+into a slot that another thread had already frozen and moved on from, and lookups for any key that went
+to the next table because of that slot would carry on probing past it.
+*/
+#define C89ATOMIC_HASHMAP_UNSET                 0
+#define C89ATOMIC_HASHMAP_TOMBSTONE             1
+#define C89ATOMIC_HASHMAP_FROZEN                ((c89atomic_uint64)0x80000000 << 32)
+#define C89ATOMIC_HASHMAP_FROZEN_KEY            (((c89atomic_uint64)0xFFFFFFFF << 32) | 0xFFFFFFFF)
+#define C89ATOMIC_HASHMAP_ENCODE(value)         ((value) + 2)
+#define C89ATOMIC_HASHMAP_DECODE(value)         ((value) - 2)
+#define C89ATOMIC_HASHMAP_HAS_VALUE(value)      ((value) > C89ATOMIC_HASHMAP_TOMBSTONE)
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_hashmap_hash(c89atomic_uint64 key, c89atomic_uint32 capacity)
+{
+    /* This is the finalizer from SplitMix64. Keys are often sequential which linear probing doesn't like. */
+    key ^= key >> 30;
+    key *= ((c89atomic_uint64)0xBF58476D << 32) | 0x1CE4E5B9;
+    key ^= key >> 27;
+    key *= ((c89atomic_uint64)0x94D049BB << 32) | 0x133111EB;
+    key ^= key >> 31;
+
+    return (c89atomic_uint32)key & (capacity - 1);
+}
+
+static C89ATOMIC_INLINE c89atomic_hashmap_table* c89atomic_hashmap_get_next_table(c89atomic_hashmap_table* pTable)
+{
+    return (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pTable->pNext, c89atomic_memory_order_acquire);
+}
+
+/*
+Counts a slot that's about to be taken in a table before trying to take it, so that the count never falls
+behind what's really been used. If the table is the next table of one that's still being resized, it also
+makes sure there's going to be enough room left for everything that's still to be moved over, which is
+what stops moving a slot from ever running out of room. Anything that's been moved already is either
+counted in the used count, or the key is already in the table. Slots that are halfway through being moved
+are counted twice, which is fine.
+
+The number of slots that have been moved has to be loaded before the used count is incremented. A slot
+that is moved after this point is one we've counted as still to be moved.
+*/
+static c89atomic_bool c89atomic_hashmap_reserve_slot(c89atomic_hashmap_table* pPrevTable, c89atomic_hashmap_table* pTable)
+{
+    c89atomic_uint32 remainingCount = 0;
+    c89atomic_uint32 usedCount;
+
+    if (pPrevTable != NULL) {
+        c89atomic_uint32 migratedCount = c89atomic_load_explicit_32(&pPrevTable->migratedCount, c89atomic_memory_order_acquire);
+        if (migratedCount < pPrevTable->capacity) {
+            remainingCount = pPrevTable->capacity - migratedCount;
+        }
+    }
+
+    usedCount = c89atomic_fetch_add_explicit_32(&pTable->usedCount, 1, c89atomic_memory_order_acq_rel) + 1;
+    if (usedCount > pTable->capacity || remainingCount > pTable->capacity - usedCount) {
+        c89atomic_fetch_sub_explicit_32(&pTable->usedCount, 1, c89atomic_memory_order_relaxed);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* For when the slot we reserved was taken by someone else first. */
+static void c89atomic_hashmap_unreserve_slot(c89atomic_hashmap_table* pTable)
+{
+    c89atomic_fetch_sub_explicit_32(&pTable->usedCount, 1, c89atomic_memory_order_relaxed);
+}
+
+/*
+Puts a value that's been moved from the old table into the new one. If the key already has a value in
+the new table it's newer than this one and is left alone.
+*/
+static void c89atomic_hashmap_copy_to_table(c89atomic_hashmap_table* pTable, c89atomic_uint64 key, c89atomic_uint64 value)
+{
+    c89atomic_uint32 mask = pTable->capacity - 1;
+    c89atomic_uint32 index = c89atomic_hashmap_hash(key, pTable->capacity);
+    c89atomic_uint32 iProbe;
+
+    for (iProbe = 0; iProbe < pTable->capacity; iProbe += 1) {
+        c89atomic_hashmap_slot* pSlot = &pTable->pSlots[index];
+        c89atomic_uint64 slotKey = c89atomic_load_explicit_64(&pSlot->key, c89atomic_memory_order_acquire);
+
+        if (slotKey == 0) {
+            /* Writers leave enough room for this. See c89atomic_hashmap_reserve_slot(). */
+            c89atomic_fetch_add_explicit_32(&pTable->usedCount, 1, c89atomic_memory_order_acq_rel);
+
+            if (c89atomic_compare_exchange_strong_explicit_64(&pSlot->key, &slotKey, key, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+                slotKey = key;
+            } else {
+                c89atomic_hashmap_unreserve_slot(pTable);
+            }
+        }
+
+        if (slotKey == key) {
+            c89atomic_uint64 expected = C89ATOMIC_HASHMAP_UNSET;
+            c89atomic_compare_exchange_strong_explicit_64(&pSlot->value, &expected, value, c89atomic_memory_order_release, c89atomic_memory_order_relaxed);
+            return;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    /* Writers always leave enough room for this. See c89atomic_hashmap_reserve_slot(). */
+    assert(!"The new table is too small to hold everything in the old table.");
+}
+
+/* Freezes a slot in a table that's being resized, and makes sure its value has made it to the next table. */
+static void c89atomic_hashmap_migrate_slot(c89atomic_hashmap_table* pTable, c89atomic_hashmap_slot* pSlot)
+{
+    c89atomic_uint64 key = c89atomic_load_explicit_64(&pSlot->key, c89atomic_memory_order_acquire);
+    c89atomic_uint64 value;
+
+    /* If this fails someone has put a key into the slot and it needs to be frozen like any other. */
+    if (key == 0) {
+        if (c89atomic_compare_exchange_strong_explicit_64(&pSlot->key, &key, C89ATOMIC_HASHMAP_FROZEN_KEY, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+            return;
+        }
+    }
+
+    if (key == C89ATOMIC_HASHMAP_FROZEN_KEY) {
+        return;
+    }
+
+    value = c89atomic_load_explicit_64(&pSlot->value, c89atomic_memory_order_acquire);
+
+    while ((value & C89ATOMIC_HASHMAP_FROZEN) == 0) {
+        if (c89atomic_compare_exchange_weak_explicit_64(&pSlot->value, &value, value | C89ATOMIC_HASHMAP_FROZEN, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+            break;
+        }
+    }
+
+    /*
+    More than one thread can get here for the same slot, either because they're both trying to write to it
+    or because a writer has got in before the thread migrating its chunk. Copying is fine to do more than once.
+    */
+    value &= ~C89ATOMIC_HASHMAP_FROZEN;
+    if (C89ATOMIC_HASHMAP_HAS_VALUE(value)) {
+        c89atomic_hashmap_copy_to_table(c89atomic_hashmap_get_next_table(pTable), key, value);
+    }
+}
+
+/* Does the work of both put and remove. Removing is done by writing a tombstone. */
+static c89atomic_hashmap_result c89atomic_hashmap_write(c89atomic_hashmap* pMap, c89atomic_uint64 key, c89atomic_uint64 newValue)
+{
+    c89atomic_hashmap_table* pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+    c89atomic_hashmap_table* pPrevTable = NULL;    /* Set when we've followed a resize to get to pTable. */
+    c89atomic_bool isRemove = (newValue == C89ATOMIC_HASHMAP_TOMBSTONE);
+
+    /* If a resize is in progress, every writer does a bit of the work. */
+    if (c89atomic_hashmap_get_next_table(pTable) != NULL) {
+        c89atomic_hashmap_migrate(pMap);
+    }
+
+    for (;;) {
+        c89atomic_hashmap_table* pNextTable = c89atomic_hashmap_get_next_table(pTable);
+        c89atomic_uint32 mask = pTable->capacity - 1;
+        c89atomic_uint32 index = c89atomic_hashmap_hash(key, pTable->capacity);
+        c89atomic_uint32 iProbe = 0;
+        c89atomic_bool moveToNextTable = 0;
+
+        while (iProbe < pTable->capacity && !moveToNextTable) {
+            c89atomic_hashmap_slot* pSlot = &pTable->pSlots[index];
+            c89atomic_uint64 slotKey = c89atomic_load_explicit_64(&pSlot->key, c89atomic_memory_order_acquire);
+            c89atomic_uint64 value;
+
+            if (slotKey == C89ATOMIC_HASHMAP_FROZEN_KEY) {
+                moveToNextTable = 1;
+                continue;
+            }
+
+            if (slotKey == 0) {
+                if (isRemove) {
+                    return C89ATOMIC_HASHMAP_NOT_FOUND;
+                }
+
+                if (pNextTable != NULL) {
+                    /*
+                    The key isn't in this table. It needs to go in the next one, but first this slot needs to be
+                    frozen so nobody that doesn't know about the resize can put the same key in here. If this
+                    fails someone has beaten us to the slot and we need to look at it again.
+                    */
+                    if (c89atomic_compare_exchange_strong_explicit_64(&pSlot->key, &slotKey, C89ATOMIC_HASHMAP_FROZEN_KEY, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+                        moveToNextTable = 1;
+                    }
+
+                    continue;
+                }
+
+                if (!c89atomic_hashmap_reserve_slot(pPrevTable, pTable)) {
+                    return C89ATOMIC_HASHMAP_FULL;
+                }
+
+                if (c89atomic_compare_exchange_strong_explicit_64(&pSlot->key, &slotKey, key, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+                    slotKey = key;
+                } else {
+                    c89atomic_hashmap_unreserve_slot(pTable);
+                }
+            }
+
+            if (slotKey != key) {
+                index   = (index + 1) & mask;
+                iProbe += 1;
+                continue;
+            }
+
+            /* We've found our slot. */
+            value = c89atomic_load_explicit_64(&pSlot->value, c89atomic_memory_order_acquire);
+
+            for (;;) {
+                if ((value & C89ATOMIC_HASHMAP_FROZEN) != 0) {
+                    /* This slot is being moved. Make sure its value has made it to the next table before we write to it there. */
+                    c89atomic_hashmap_migrate_slot(pTable, pSlot);
+                    moveToNextTable = 1;
+                    break;
+                }
+
+                if (isRemove && !C89ATOMIC_HASHMAP_HAS_VALUE(value)) {
+                    return C89ATOMIC_HASHMAP_NOT_FOUND;
+                }
+
+                /* Release so that whoever gets the value sees what it refers to. */
+                if (c89atomic_compare_exchange_weak_explicit_64(&pSlot->value, &value, newValue, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+                    return C89ATOMIC_HASHMAP_SUCCESS;
+                }
+            }
+        }
+
+        if (!moveToNextTable) {
+            /* We've looked at every slot. */
+            if (pNextTable == NULL) {
+                return isRemove ? C89ATOMIC_HASHMAP_NOT_FOUND : C89ATOMIC_HASHMAP_FULL;
+            }
+        }
+
+        /* A frozen slot means pNext has been set, even if it was NULL when we first loaded it. */
+        pPrevTable = pTable;
+        pTable = c89atomic_hashmap_get_next_table(pTable);
+        assert(pTable != NULL);
+    }
+}
+
+
+/* BEG c89atomic_hashmap.c */
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_table_init(c89atomic_hashmap_slot* pSlots, c89atomic_uint32 capacity, c89atomic_hashmap_table* pTable)
+{
+    c89atomic_uint32 iSlot;
+
+    if (pTable == NULL || pSlots == NULL) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    for (iSlot = 0; iSlot < capacity; iSlot += 1) {
+        pSlots[iSlot].key   = 0;
+        pSlots[iSlot].value = C89ATOMIC_HASHMAP_UNSET;
+    }
+
+    pTable->pSlots        = pSlots;
+    pTable->capacity      = capacity;
+    pTable->usedCount     = 0;
+    pTable->migrateCursor = 0;
+    pTable->migratedCount = 0;
+    pTable->pNext         = NULL;
+
+    /* Make sure other threads see the initialized slots when the table is handed over in c89atomic_hashmap_begin_resize(). */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_HASHMAP_SUCCESS;
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_init(c89atomic_hashmap_table* pTable, c89atomic_hashmap* pMap)
+{
+    if (pMap == NULL || pTable == NULL) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    c89atomic_store_explicit_ptr((volatile void**)&pMap->pTable, pTable, c89atomic_memory_order_release);
+
+    return C89ATOMIC_HASHMAP_SUCCESS;
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_put(c89atomic_hashmap* pMap, c89atomic_uint64 key, c89atomic_uint64 value)
+{
+    if (key == 0 || key == C89ATOMIC_HASHMAP_FROZEN_KEY || value > C89ATOMIC_HASHMAP_MAX_VALUE) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    return c89atomic_hashmap_write(pMap, key, C89ATOMIC_HASHMAP_ENCODE(value));
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_get(c89atomic_hashmap* pMap, c89atomic_uint64 key, c89atomic_uint64* pValue)
+{
+    c89atomic_hashmap_table* pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+    c89atomic_uint64 frozenValue = C89ATOMIC_HASHMAP_UNSET;
+
+    if (key == 0 || key == C89ATOMIC_HASHMAP_FROZEN_KEY) {
+        return C89ATOMIC_HASHMAP_NOT_FOUND;
+    }
+
+    /*
+    If we find the key in a frozen slot we need to look in the next table for the up to date value. If the
+    key isn't in the next table yet it means the value hasn't been moved over yet, in which case the value
+    from the frozen slot is still the latest. Nobody can write to the key in the next table until it has
+    been moved.
+    */
+    while (pTable != NULL) {
+        c89atomic_uint32 mask = pTable->capacity - 1;
+        c89atomic_uint32 index = c89atomic_hashmap_hash(key, pTable->capacity);
+        c89atomic_uint32 iProbe;
+        c89atomic_uint64 value = C89ATOMIC_HASHMAP_UNSET;
+        c89atomic_bool moveToNextTable = 1;  /* If we look at every slot without finding the key or an empty slot. */
+
+        for (iProbe = 0; iProbe < pTable->capacity; iProbe += 1) {
+            c89atomic_hashmap_slot* pSlot = &pTable->pSlots[index];
+            c89atomic_uint64 slotKey = c89atomic_load_explicit_64(&pSlot->key, c89atomic_memory_order_acquire);
+
+            if (slotKey == key) {
+                value = c89atomic_load_explicit_64(&pSlot->value, c89atomic_memory_order_acquire);
+                moveToNextTable = (value & C89ATOMIC_HASHMAP_FROZEN) != 0;
+
+                if (moveToNextTable) {
+                    frozenValue = value & ~C89ATOMIC_HASHMAP_FROZEN;
+                }
+
+                break;
+            }
+
+            if (slotKey == 0 || slotKey == C89ATOMIC_HASHMAP_FROZEN_KEY) {
+                /* The key isn't in this table. If the slot is frozen it might have been put in the next one. */
+                moveToNextTable = (slotKey == C89ATOMIC_HASHMAP_FROZEN_KEY);
+                break;
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        if (moveToNextTable) {
+            pTable = c89atomic_hashmap_get_next_table(pTable);
+            continue;
+        }
+
+        if (C89ATOMIC_HASHMAP_HAS_VALUE(value)) {
+            *pValue = C89ATOMIC_HASHMAP_DECODE(value);
+            return C89ATOMIC_HASHMAP_SUCCESS;
+        }
+
+        if (value == C89ATOMIC_HASHMAP_TOMBSTONE) {
+            return C89ATOMIC_HASHMAP_NOT_FOUND;
+        }
+
+        break;  /* Not here, or not here yet. */
+    }
+
+    if (C89ATOMIC_HASHMAP_HAS_VALUE(frozenValue)) {
+        *pValue = C89ATOMIC_HASHMAP_DECODE(frozenValue);
+        return C89ATOMIC_HASHMAP_SUCCESS;
+    }
+
+    return C89ATOMIC_HASHMAP_NOT_FOUND;
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_remove(c89atomic_hashmap* pMap, c89atomic_uint64 key)
+{
+    if (key == 0 || key == C89ATOMIC_HASHMAP_FROZEN_KEY) {
+        return C89ATOMIC_HASHMAP_NOT_FOUND;
+    }
+
+    return c89atomic_hashmap_write(pMap, key, C89ATOMIC_HASHMAP_TOMBSTONE);
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_begin_resize(c89atomic_hashmap* pMap, c89atomic_hashmap_table* pNewTable)
+{
+    c89atomic_hashmap_table* pTable;
+    void* pExpected = NULL;
+
+    if (pMap == NULL || pNewTable == NULL) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+
+    /*
+    This won't catch everything, but it will catch a table that has already been used and not initialized
+    again, and a table that's too small for what's already in the current one.
+    */
+    if (pTable == pNewTable || c89atomic_load_explicit_ptr((volatile void**)&pNewTable->pNext, c89atomic_memory_order_relaxed) != NULL || c89atomic_load_explicit_32(&pNewTable->usedCount, c89atomic_memory_order_relaxed) != 0) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    if (pNewTable->capacity < c89atomic_load_explicit_32(&pTable->usedCount, c89atomic_memory_order_relaxed)) {
+        return C89ATOMIC_HASHMAP_INVALID_ARGS;
+    }
+
+    /* Release so that anybody who sees the new table also sees its initialized slots. */
+    if (!c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pTable->pNext, &pExpected, pNewTable, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+        return C89ATOMIC_HASHMAP_BUSY;
+    }
+
+    return C89ATOMIC_HASHMAP_SUCCESS;
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_bool c89atomic_hashmap_migrate(c89atomic_hashmap* pMap)
+{
+    c89atomic_hashmap_table* pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+    c89atomic_hashmap_table* pNextTable = c89atomic_hashmap_get_next_table(pTable);
+    c89atomic_uint32 iSlotBeg;
+    c89atomic_uint32 iSlotEnd;
+    c89atomic_uint32 iSlot;
+
+    if (pNextTable == NULL) {
+        return 0;   /* Not resizing. */
+    }
+
+    /* Check first so the cursor doesn't keep counting up (and eventually wrap) once every chunk has been claimed. */
+    iSlotBeg = c89atomic_load_explicit_32(&pTable->migrateCursor, c89atomic_memory_order_relaxed);
+    if (iSlotBeg < pTable->capacity) {
+        iSlotBeg = c89atomic_fetch_add_explicit_32(&pTable->migrateCursor, C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE, c89atomic_memory_order_relaxed);
+    }
+
+    if (iSlotBeg >= pTable->capacity) {
+        /*
+        Every chunk has been claimed but the resize hasn't finished. We can't wait for the threads that claimed
+        the remaining chunks because they might have been preempted, and in the meantime everything new would
+        be piling up in the next table. Instead we go over the whole table ourselves. Most of it will already
+        be frozen so this is mostly just loads.
+        */
+        for (iSlot = 0; iSlot < pTable->capacity; iSlot += 1) {
+            c89atomic_hashmap_migrate_slot(pTable, &pTable->pSlots[iSlot]);
+        }
+
+        /* Everything has been moved now, so writers that are still looking at this table don't need to leave room for any of it. */
+        c89atomic_store_explicit_32(&pTable->migratedCount, pTable->capacity, c89atomic_memory_order_release);
+
+        /* If this fails someone else got there first. */
+        c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pMap->pTable, (void**)&pTable, pNextTable, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire);
+        return 0;
+    }
+
+    iSlotEnd = iSlotBeg + C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE;
+    if (iSlotEnd > pTable->capacity) {
+        iSlotEnd = pTable->capacity;
+    }
+
+    for (iSlot = iSlotBeg; iSlot < iSlotEnd; iSlot += 1) {
+        c89atomic_hashmap_migrate_slot(pTable, &pTable->pSlots[iSlot]);
+    }
+
+    /* Whoever moves the last chunk makes the next table the current one, unless someone else has already done it. */
+    if (c89atomic_fetch_add_explicit_32(&pTable->migratedCount, iSlotEnd - iSlotBeg, c89atomic_memory_order_acq_rel) + (iSlotEnd - iSlotBeg) == pTable->capacity) {
+        c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pMap->pTable, (void**)&pTable, pNextTable, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire);
+        return 0;
+    }
+
+    return 1;
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_uint32 c89atomic_hashmap_get_used_slot_count(c89atomic_hashmap* pMap)
+{
+    c89atomic_hashmap_table* pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+    return c89atomic_load_explicit_32(&pTable->usedCount, c89atomic_memory_order_relaxed);
+}
+
+C89ATOMIC_HASHMAP_API c89atomic_uint32 c89atomic_hashmap_get_capacity(c89atomic_hashmap* pMap)
+{
+    c89atomic_hashmap_table* pTable = (c89atomic_hashmap_table*)c89atomic_load_explicit_ptr((volatile void**)&pMap->pTable, c89atomic_memory_order_acquire);
+    return pTable->capacity;
+}
+/* END c89atomic_hashmap.c */
+
+#endif  /* c89atomic_hashmap_c */
@@ -0,0 +1,121 @@
+/*
+A lock-free hash map for 64-bit keys and values. This is an open-addressing table with linear probing, along the same lines as
+Jeff Preshing's "The World's Simplest Lock-Free Hash Table" with an incremental resize inspired by Cliff Click's non-blocking hash
+map.
+
+This is intended for lookup tables that are read far more often than they're written to, such as connection or session tables.
+Any number of threads can insert, look up and remove at the same time. Looking up a key doesn't write to anything and is wait-free.
+Inserting and removing are lock-free and use compare-exchange on the key and value of a slot.
+
+You need to supply the memory for the slots. A table is the slots plus a bit of bookkeeping. The capacity must be a power of 2 and
+the slots must be aligned to 8 bytes:
+
+    c89atomic_hashmap_slot slots[1024];
+    c89atomic_hashmap_table table;
+    c89atomic_hashmap_table_init(slots, 1024, &table);
+
+    c89atomic_hashmap map;
+    c89atomic_hashmap_init(&table, &map);
+
+    c89atomic_hashmap_put(&map, connectionID, (c89atomic_uint64)pConnection);
+    ...
+    c89atomic_uint64 value;
+    if (c89atomic_hashmap_get(&map, connectionID, &value) == C89ATOMIC_HASHMAP_SUCCESS) {
+        my_connection* pConnection = (my_connection*)(c89atomic_uintptr)value;
+    }
+
+Keys of 0 and 0xFFFFFFFFFFFFFFFF are reserved. They mean an empty slot and an empty slot that's been frozen for resizing. The
+top bit of values is also reserved for resizing, so values can't be any bigger than C89ATOMIC_HASHMAP_MAX_VALUE. Pointers and
+indices will always fit.
+
+Once a key has been put into a slot it stays there. Removing a key leaves a tombstone in the slot's value. If the same key is put
+back it'll reuse the slot, but other keys can't. This means a table where lots of different keys come and go will fill up over time
+even if the number of keys in it at any one time is small. Tombstones are dropped when the table is resized.
+
+Tables can't grow on their own. When c89atomic_hashmap_put() returns C89ATOMIC_HASHMAP_FULL, or ideally well before then, you need
+to give the map a new table with c89atomic_hashmap_begin_resize(). You can keep an eye on how full a table is getting with
+c89atomic_hashmap_get_used_slot_count(). Linear probing gets slow when the table gets close to full, so around 75% is a good time:
+
+    if (c89atomic_hashmap_get_used_slot_count(&map) > c89atomic_hashmap_get_capacity(&map) / 4 * 3) {
+        c89atomic_hashmap_table_init(pBiggerSlots, biggerCapacity, pBiggerTable);
+        c89atomic_hashmap_begin_resize(&map, pBiggerTable);
+    }
+
+Resizing doesn't stop the world. The map keeps working while the entries are moved to the new table. The work is split into chunks
+of C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE slots, and every put and remove moves a chunk along the way. Lookups don't help. You can
+also do some of the work yourself by calling c89atomic_hashmap_migrate() which returns false once the resize has finished. If the
+thread that took the last chunk is held up, the next writer to come along will go over the whole table and finish the resize
+itself rather than wait for it. Only one resize can be in progress at a time.
+
+New keys that are put during a resize go straight into the new table, so they're competing for space with the entries that haven't
+been moved over yet. Room is always kept for everything that's still to be moved, which means c89atomic_hashmap_put() can return
+C89ATOMIC_HASHMAP_FULL during a resize even though the new table isn't full yet. When that happens, call c89atomic_hashmap_migrate()
+until it returns false and try again. The earlier you start the resize and the bigger the new table, the less likely this is.
+
+Once a resize has finished, other threads might still be looking at the old table. It's up to you to make sure nobody is using it
+before you free or reuse its memory. c89atomic_epoch.h and c89atomic_rcu.h can help with this. A table can only be resized from
+once. If you want to reuse its memory you need to initialize it again.
+
+This will not validate function parameters for null pointers except in the init functions.
+*/
+#ifndef c89atomic_hashmap_h
+#define c89atomic_hashmap_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_HASHMAP_API
+#define C89ATOMIC_HASHMAP_API
+#endif
+
+/* The number of slots moved to the new table at a time when resizing. */
+#ifndef C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE
+#define C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE    64
+#endif
+
+#define C89ATOMIC_HASHMAP_MAX_VALUE     (((c89atomic_uint64)0x7FFFFFFF << 32) | 0xFFFFFFFD)
+
+typedef enum
+{
+    C89ATOMIC_HASHMAP_SUCCESS = 0,
+    C89ATOMIC_HASHMAP_INVALID_ARGS,
+    C89ATOMIC_HASHMAP_FULL,             /* Can be returned when putting and there's no room left in the table, or when the room that's left is needed for a resize. */
+    C89ATOMIC_HASHMAP_NOT_FOUND,        /* Can be returned when getting or removing. */
+    C89ATOMIC_HASHMAP_BUSY              /* Can be returned when beginning a resize and another is already in progress. */
+} c89atomic_hashmap_result;
+
+/* BEG c89atomic_hashmap.h */
+typedef struct c89atomic_hashmap_slot
+{
+    c89atomic_uint64 key;       /* Atomic. 0 if the slot is empty. This is set to a reserved key when an empty slot is frozen for resizing. See c89atomic_hashmap.c. */
+    c89atomic_uint64 value;     /* Atomic. This is encoded. See c89atomic_hashmap.c. */
+} c89atomic_hashmap_slot;
+
+typedef struct c89atomic_hashmap_table
+{
+    c89atomic_hashmap_slot* pSlots;
+    c89atomic_uint32 capacity;                  /* Always a power of 2. */
+    struct c89atomic_hashmap_table* pNext;      /* Atomic. The table this one is being resized to, or NULL. Every operation reads this but it's only written once. */
+    c89atomic_uint8 pad0[C89ATOMIC_CACHE_LINE_SIZE];   /* Keeps the counters below, which writers hammer, off the cache line that every lookup reads. */
+    c89atomic_uint32 usedCount;                 /* Atomic. The number of slots with a key, including those that have been removed. */
+    c89atomic_uint32 migrateCursor;             /* Atomic. The next chunk to be moved to pNext. */
+    c89atomic_uint32 migratedCount;             /* Atomic. The number of slots that have been moved to pNext. */
+} c89atomic_hashmap_table;
+
+typedef struct c89atomic_hashmap
+{
+    c89atomic_hashmap_table* pTable;            /* Atomic. */
+} c89atomic_hashmap;
+
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_table_init(c89atomic_hashmap_slot* pSlots, c89atomic_uint32 capacity, c89atomic_hashmap_table* pTable);    /* Capacity must be a power of 2. */
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_init(c89atomic_hashmap_table* pTable, c89atomic_hashmap* pMap);
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_put(c89atomic_hashmap* pMap, c89atomic_uint64 key, c89atomic_uint64 value);     /* Inserts the key, or replaces its value if it's already there. Returns C89ATOMIC_HASHMAP_FULL if there's no room for a new key, which can happen during a resize. */
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_get(c89atomic_hashmap* pMap, c89atomic_uint64 key, c89atomic_uint64* pValue);
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_remove(c89atomic_hashmap* pMap, c89atomic_uint64 key);
+C89ATOMIC_HASHMAP_API c89atomic_hashmap_result c89atomic_hashmap_begin_resize(c89atomic_hashmap* pMap, c89atomic_hashmap_table* pNewTable);  /* The new table must be freshly initialized and must be big enough for everything in the current table. Returns C89ATOMIC_HASHMAP_BUSY if a resize is already in progress. */
+C89ATOMIC_HASHMAP_API c89atomic_bool c89atomic_hashmap_migrate(c89atomic_hashmap* pMap);   /* Moves a chunk of slots to the new table. Returns true if a resize is still in progress. */
+C89ATOMIC_HASHMAP_API c89atomic_uint32 c89atomic_hashmap_get_used_slot_count(c89atomic_hashmap* pMap);
+C89ATOMIC_HASHMAP_API c89atomic_uint32 c89atomic_hashmap_get_capacity(c89atomic_hashmap* pMap);
+/* END c89atomic_hashmap.h */
+
+#endif  /* c89atomic_hashmap_h */
@@ -0,0 +1,210 @@
+#ifndef c89atomic_hazard_pointers_c
+#define c89atomic_hazard_pointers_c
+
+#include "c89atomic_hazard_pointers.h"
+
+#include <assert.h>
+
+/* BEG c89atomic_hazard_pointers.c */
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_hazard_result c89atomic_hazard_domain_init(c89atomic_hazard_record* pRecords, c89atomic_uint32 recordCount, c89atomic_hazard_free_proc onFree, void* pUserData, c89atomic_hazard_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+    c89atomic_uint32 iHazard;
+
+    if (pDomain == NULL || pRecords == NULL || recordCount == 0 || onFree == NULL) {
+        return C89ATOMIC_HAZARD_INVALID_ARGS;
+    }
+
+    /*
+    Retiring could end up waiting forever if every retired object can be protected at the same time. See the notes in the header.
+    This is the same as checking that the retire capacity is bigger than the number of hazard pointers, without the multiply overflowing.
+    */
+    if (recordCount > (C89ATOMIC_HAZARD_RETIRE_CAPACITY - 1) / C89ATOMIC_HAZARD_POINTER_COUNT) {
+        return C89ATOMIC_HAZARD_INVALID_ARGS;
+    }
+
+    for (iRecord = 0; iRecord < recordCount; iRecord += 1) {
+        for (iHazard = 0; iHazard < C89ATOMIC_HAZARD_POINTER_COUNT; iHazard += 1) {
+            pRecords[iRecord].hazards[iHazard] = NULL;
+        }
+
+        pRecords[iRecord].inUse        = 0;
+        pRecords[iRecord].retiredCount = 0;
+    }
+
+    pDomain->pRecords    = pRecords;
+    pDomain->recordCount = recordCount;
+    pDomain->onFree      = onFree;
+    pDomain->pUserData   = pUserData;
+
+    /* Make sure other threads see the initialized records if the domain is handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_HAZARD_SUCCESS;
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_domain_uninit(c89atomic_hazard_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+    c89atomic_uint32 iRetired;
+
+    /* Nobody else is using the domain at this point so there's no need to check any hazards. */
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_hazard_record* pRecord = &pDomain->pRecords[iRecord];
+
+        for (iRetired = 0; iRetired < pRecord->retiredCount; iRetired += 1) {
+            pDomain->onFree(pDomain->pUserData, pRecord->retired[iRetired]);
+        }
+
+        pRecord->retiredCount = 0;
+    }
+}
+
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_hazard_result c89atomic_hazard_domain_acquire_record(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record** ppRecord)
+{
+    c89atomic_uint32 iRecord;
+
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_hazard_record* pRecord = &pDomain->pRecords[iRecord];
+        c89atomic_uint32 expected = 0;
+
+        if (c89atomic_load_explicit_32(&pRecord->inUse, c89atomic_memory_order_relaxed) != 0) {
+            continue;
+        }
+
+        /* Acquire so we see the retire list left behind by the previous owner. */
+        if (c89atomic_compare_exchange_strong_explicit_32(&pRecord->inUse, &expected, 1, c89atomic_memory_order_acquire, c89atomic_memory_order_relaxed)) {
+            *ppRecord = pRecord;
+            return C89ATOMIC_HAZARD_SUCCESS;
+        }
+    }
+
+    *ppRecord = NULL;
+    return C89ATOMIC_HAZARD_OUT_OF_RECORDS;
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_domain_release_record(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord)
+{
+    c89atomic_uint32 iHazard;
+
+    for (iHazard = 0; iHazard < C89ATOMIC_HAZARD_POINTER_COUNT; iHazard += 1) {
+        c89atomic_hazard_clear(pRecord, iHazard);
+    }
+
+    /* Try to clean up while we're here. Anything left over will be picked up by the next owner. */
+    c89atomic_hazard_reclaim(pDomain, pRecord);
+
+    c89atomic_store_explicit_32(&pRecord->inUse, 0, c89atomic_memory_order_release);
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void* c89atomic_hazard_protect(c89atomic_hazard_record* pRecord, c89atomic_uint32 index, volatile void** ppSource)
+{
+    void* pObject = c89atomic_load_explicit_ptr(ppSource, c89atomic_memory_order_relaxed);
+
+    assert(index < C89ATOMIC_HAZARD_POINTER_COUNT);
+
+    for (;;) {
+        void* pCurrent;
+
+        c89atomic_store_explicit_ptr((volatile void**)&pRecord->hazards[index], pObject, c89atomic_memory_order_relaxed);
+
+        /*
+        The hazard pointer must be visible before we check the source again. This pairs with the fence in
+        the scan. Either the scanning thread sees our hazard pointer, or we see that the object has been
+        unlinked. The acquire on the load makes the contents of the object visible to us.
+        */
+        c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+
+        pCurrent = c89atomic_load_explicit_ptr(ppSource, c89atomic_memory_order_acquire);
+        if (pCurrent == pObject) {
+            return pObject;
+        }
+
+        /* It changed before we could protect it. Try again with the new value. */
+        pObject = pCurrent;
+    }
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_set(c89atomic_hazard_record* pRecord, c89atomic_uint32 index, void* pObject)
+{
+    assert(index < C89ATOMIC_HAZARD_POINTER_COUNT);
+    c89atomic_store_explicit_ptr((volatile void**)&pRecord->hazards[index], pObject, c89atomic_memory_order_seq_cst);
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_clear(c89atomic_hazard_record* pRecord, c89atomic_uint32 index)
+{
+    assert(index < C89ATOMIC_HAZARD_POINTER_COUNT);
+
+    /* Release so that our reads of the object are done before the scanning thread frees it. */
+    c89atomic_store_explicit_ptr((volatile void**)&pRecord->hazards[index], NULL, c89atomic_memory_order_release);
+}
+
+static c89atomic_bool c89atomic_hazard_is_protected(c89atomic_hazard_domain* pDomain, void* pObject)
+{
+    c89atomic_uint32 iRecord;
+    c89atomic_uint32 iHazard;
+
+    /*
+    Every record is checked, even those not in use. A record can be released in between us loading
+    the in-use flag and loading the hazard pointers so the flag doesn't tell us anything useful.
+    Released records have their hazard pointers cleared anyway.
+    */
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_hazard_record* pRecord = &pDomain->pRecords[iRecord];
+
+        for (iHazard = 0; iHazard < C89ATOMIC_HAZARD_POINTER_COUNT; iHazard += 1) {
+            if (c89atomic_load_explicit_ptr((volatile void**)&pRecord->hazards[iHazard], c89atomic_memory_order_acquire) == pObject) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_uint32 c89atomic_hazard_reclaim(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord)
+{
+    c89atomic_uint32 iRetired;
+    c89atomic_uint32 keptCount = 0;
+
+    /* Pairs with the fence in c89atomic_hazard_protect(). The objects were unlinked before they were retired. */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+
+    /*
+    This is a simple scan of every hazard pointer for every retired object. It's cheap enough for the
+    small number of threads this is designed for, and since we only scan once the retire list is full
+    the cost is spread out over each retire.
+    */
+    for (iRetired = 0; iRetired < pRecord->retiredCount; iRetired += 1) {
+        void* pObject = pRecord->retired[iRetired];
+
+        if (c89atomic_hazard_is_protected(pDomain, pObject)) {
+            pRecord->retired[keptCount] = pObject;
+            keptCount += 1;
+        } else {
+            pDomain->onFree(pDomain->pUserData, pObject);
+        }
+    }
+
+    pRecord->retiredCount = keptCount;
+    return keptCount;
+}
+
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_retire(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord, void* pObject)
+{
+    if (pRecord->retiredCount == C89ATOMIC_HAZARD_RETIRE_CAPACITY) {
+        c89atomic_backoff backoff;
+        c89atomic_backoff_init(&backoff);
+
+        /* If everything is still protected we need to wait for the readers to move on. */
+        while (c89atomic_hazard_reclaim(pDomain, pRecord) == C89ATOMIC_HAZARD_RETIRE_CAPACITY) {
+            c89atomic_backoff_snooze(&backoff);
+        }
+    }
+
+    pRecord->retired[pRecord->retiredCount] = pObject;
+    pRecord->retiredCount += 1;
+}
+/* END c89atomic_hazard_pointers.c */
+
+#endif /* c89atomic_hazard_pointers_c */
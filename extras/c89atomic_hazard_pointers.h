@@ -0,0 +1,110 @@
+/*
+Hazard pointers. This implements "Michael, Hazard Pointers: Safe Memory Reclamation for Lock-Free Objects (IEEE TPDS 2004)".
+
+Lock-free data structures have a problem when it comes to freeing memory. A thread can unlink a node, but it can't free it
+straight away because another thread may have loaded a pointer to it just before it was unlinked and may still be reading from it.
+Hazard pointers solve this by having each reader publish the pointer it's about to read from. Unlinked nodes are retired rather than
+freed, and are only freed once no reader has published a pointer to them.
+
+Everything lives in a domain which is shared by all threads that access the data structure. Each thread that wants to access the
+data structure needs to acquire a record from the domain. A record holds C89ATOMIC_HAZARD_POINTER_COUNT hazard pointers and the list
+of objects that thread has retired. You need to supply the memory for the records when initializing the domain, which puts an upper
+limit on the number of threads that can use the domain at the same time:
+
+    c89atomic_hazard_record records[16];
+    c89atomic_hazard_domain domain;
+    c89atomic_hazard_domain_init(records, 16, my_free, pMyUserData, &domain);
+
+A thread then acquires a record for itself. This is just a compare-exchange on each record so you'll want to keep hold of it rather
+than acquiring one for each operation:
+
+    c89atomic_hazard_record* pRecord;
+    c89atomic_hazard_domain_acquire_record(&domain, &pRecord);
+
+To read from a node, protect it first. This loads the pointer, publishes it and then makes sure it's still the same. Once this
+returns, the node will not be freed until the hazard pointer is cleared or replaced:
+
+    my_node* pHead = (my_node*)c89atomic_hazard_protect(pRecord, 0, (volatile void**)&pList->pHead);
+    ... read from pHead ...
+    c89atomic_hazard_clear(pRecord, 0);
+
+Once a node has been unlinked, retire it. It'll be passed to the free callback once it's safe to do so:
+
+    c89atomic_hazard_retire(&domain, pRecord, pUnlinkedNode);
+
+Retired objects are held in the record until there are C89ATOMIC_HAZARD_RETIRE_CAPACITY of them, at which point the hazard pointers
+of every record are scanned and any object not referenced by one of them is freed. This means the cost of scanning is spread out
+over a lot of retires. If every retired object is still protected the retiring thread will wait for them to be released, which keeps
+memory usage bounded. For this to not wait forever the retire capacity must be larger than the total number of hazard pointers, that
+is the record count multiplied by C89ATOMIC_HAZARD_POINTER_COUNT, and c89atomic_hazard_domain_init() will return
+C89ATOMIC_HAZARD_INVALID_ARGS if it's not. Ideally it should be at least twice that.
+
+When a thread is finished with the domain it releases the record. Any objects it has retired that couldn't be freed yet stay with the
+record and are taken over by the next thread to acquire it. c89atomic_hazard_domain_uninit() frees every retired object, and must
+only be called once no other thread is using the domain.
+
+This does not do input parameter validation for null pointers except in c89atomic_hazard_domain_init().
+*/
+#ifndef c89atomic_hazard_pointers_h
+#define c89atomic_hazard_pointers_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_HAZARD_POINTERS_API
+#define C89ATOMIC_HAZARD_POINTERS_API
+#endif
+
+/* The number of hazard pointers each thread can have published at the same time. Most data structures need 1 or 2. */
+#ifndef C89ATOMIC_HAZARD_POINTER_COUNT
+#define C89ATOMIC_HAZARD_POINTER_COUNT      2
+#endif
+
+/* The number of retired objects a record can hold before it needs to scan. */
+#ifndef C89ATOMIC_HAZARD_RETIRE_CAPACITY
+#define C89ATOMIC_HAZARD_RETIRE_CAPACITY    128
+#endif
+
+typedef enum
+{
+    C89ATOMIC_HAZARD_SUCCESS = 0,
+    C89ATOMIC_HAZARD_INVALID_ARGS,
+    C89ATOMIC_HAZARD_OUT_OF_RECORDS     /* Can be returned when acquiring a record and every record is in use. */
+} c89atomic_hazard_result;
+
+typedef void (* c89atomic_hazard_free_proc)(void* pUserData, void* pObject);
+
+
+/* BEG c89atomic_hazard_pointers.h */
+typedef struct c89atomic_hazard_record
+{
+    /* Read by every thread when scanning. */
+    void* hazards[C89ATOMIC_HAZARD_POINTER_COUNT];
+    c89atomic_uint32 inUse;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE];
+
+    /* Only ever accessed by the thread that owns the record. */
+    c89atomic_uint32 retiredCount;
+    void* retired[C89ATOMIC_HAZARD_RETIRE_CAPACITY];
+} c89atomic_hazard_record;
+
+typedef struct c89atomic_hazard_domain
+{
+    c89atomic_hazard_record* pRecords;
+    c89atomic_uint32 recordCount;
+    c89atomic_hazard_free_proc onFree;
+    void* pUserData;
+} c89atomic_hazard_domain;
+
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_hazard_result c89atomic_hazard_domain_init(c89atomic_hazard_record* pRecords, c89atomic_uint32 recordCount, c89atomic_hazard_free_proc onFree, void* pUserData, c89atomic_hazard_domain* pDomain);
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_domain_uninit(c89atomic_hazard_domain* pDomain);
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_hazard_result c89atomic_hazard_domain_acquire_record(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record** ppRecord);
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_domain_release_record(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord);
+C89ATOMIC_HAZARD_POINTERS_API void* c89atomic_hazard_protect(c89atomic_hazard_record* pRecord, c89atomic_uint32 index, volatile void** ppSource);
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_set(c89atomic_hazard_record* pRecord, c89atomic_uint32 index, void* pObject);     /* Publishes without checking the source. Only use this for objects you know are already protected, such as by another hazard pointer. */
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_clear(c89atomic_hazard_record* pRecord, c89atomic_uint32 index);
+C89ATOMIC_HAZARD_POINTERS_API void c89atomic_hazard_retire(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord, void* pObject);
+C89ATOMIC_HAZARD_POINTERS_API c89atomic_uint32 c89atomic_hazard_reclaim(c89atomic_hazard_domain* pDomain, c89atomic_hazard_record* pRecord);   /* Scans straight away rather than waiting for the retire list to fill up. Returns the number of objects that are still waiting. */
+/* END c89atomic_hazard_pointers.h */
+
+#endif /* c89atomic_hazard_pointers_h */
@@ -0,0 +1,184 @@
+#ifndef c89atomic_mpmc_queue_c
+#define c89atomic_mpmc_queue_c
+
+#include "c89atomic_mpmc_queue.h"
+
+#include <string.h>
+
+#ifndef C89ATOMIC_MPMC_QUEUE_COPY_MEMORY
+#define C89ATOMIC_MPMC_QUEUE_COPY_MEMORY(dst, src, count) memcpy((dst), (src), (count))
+#endif
+
+/*
+Each slot is a 32-bit sequence number followed by the element. The element is placed 8 bytes in and
+its size is rounded up to 8 bytes so that 64-bit members of the element stay aligned.
+*/
+#define C89ATOMIC_MPMC_QUEUE_SLOT_HEADER_SIZE   8
+#define C89ATOMIC_MPMC_QUEUE_SLOT_SIZE(stride)  (C89ATOMIC_MPMC_QUEUE_SLOT_HEADER_SIZE + (((stride) + 7) & ~(c89atomic_uint32)7))
+#define C89ATOMIC_MPMC_QUEUE_GET_SLOT(pQueue, cursor)       ((c89atomic_uint8*)(pQueue)->pBuffer + (size_t)((cursor) & ((pQueue)->capacity - 1)) * (pQueue)->slotSize)
+#define C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(pSlot)            ((c89atomic_uint32*)(pSlot))
+#define C89ATOMIC_MPMC_QUEUE_GET_ELEMENT(pSlot)             ((pSlot) + C89ATOMIC_MPMC_QUEUE_SLOT_HEADER_SIZE)
+
+/* BEG c89atomic_mpmc_queue.c */
+C89ATOMIC_MPMC_QUEUE_API size_t c89atomic_mpmc_queue_get_buffer_size(c89atomic_uint32 capacity, c89atomic_uint32 stride)
+{
+    return (size_t)capacity * C89ATOMIC_MPMC_QUEUE_SLOT_SIZE(stride);
+}
+
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_init(c89atomic_uint32 capacity, c89atomic_uint32 stride, void* pBuffer, c89atomic_mpmc_queue* pQueue)
+{
+    c89atomic_uint32 iSlot;
+
+    if (pQueue == NULL || pBuffer == NULL || stride == 0) {
+        return C89ATOMIC_MPMC_QUEUE_INVALID_ARGS;
+    }
+
+    /*
+    The cursors are 32-bit and wrap around. Masking them only works across the wrap if the capacity
+    divides evenly into 2^32, which is why it needs to be a power of 2. The comparisons between the
+    cursors and sequence numbers are done on the signed difference, so it can't be more than 2^31.
+    */
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 || capacity > 0x80000000) {
+        return C89ATOMIC_MPMC_QUEUE_INVALID_ARGS;
+    }
+
+    /* Like the ring buffer, the size of the buffer is limited to 32 bits so it behaves the same on 32- and 64-bit builds. */
+    if (stride > 0xFFFFFFFF - 15 || capacity > (0xFFFFFFFF / C89ATOMIC_MPMC_QUEUE_SLOT_SIZE(stride))) {
+        return C89ATOMIC_MPMC_QUEUE_INVALID_ARGS;
+    }
+
+    pQueue->head     = 0;
+    pQueue->tail     = 0;
+    pQueue->capacity = capacity;
+    pQueue->stride   = stride;
+    pQueue->slotSize = C89ATOMIC_MPMC_QUEUE_SLOT_SIZE(stride);
+    pQueue->pBuffer  = pBuffer;
+
+    /* A slot is ready for a push when its sequence number is equal to the head. */
+    for (iSlot = 0; iSlot < capacity; iSlot += 1) {
+        *C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(C89ATOMIC_MPMC_QUEUE_GET_SLOT(pQueue, iSlot)) = iSlot;
+    }
+
+    /* Make sure other threads see the initialized slots if the queue is handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_MPMC_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_push(c89atomic_mpmc_queue* pQueue, const void* pElement)
+{
+    c89atomic_uint32 head = c89atomic_load_explicit_32(&pQueue->head, c89atomic_memory_order_relaxed);
+    c89atomic_uint8* pSlot;
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_uint32 sequence;
+        c89atomic_int32 diff;
+
+        pSlot = C89ATOMIC_MPMC_QUEUE_GET_SLOT(pQueue, head);
+
+        /* Acquire so that the consumer that last used this slot has finished reading from it before we overwrite it. */
+        sequence = c89atomic_load_explicit_32(C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(pSlot), c89atomic_memory_order_acquire);
+        diff = (c89atomic_int32)(sequence - head);
+
+        if (diff == 0) {
+            /* The slot is free. Try claiming it. If this fails the head is updated for the next attempt. */
+            if (c89atomic_compare_exchange_weak_explicit_32(&pQueue->head, &head, head + 1, c89atomic_memory_order_relaxed, c89atomic_memory_order_relaxed)) {
+                break;
+            }
+
+            c89atomic_backoff_spin(&backoff);
+        } else if (diff < 0) {
+            /* The slot still has the element from the previous lap. */
+            return C89ATOMIC_MPMC_QUEUE_FULL;
+        } else {
+            /* Another producer got here first. */
+            head = c89atomic_load_explicit_32(&pQueue->head, c89atomic_memory_order_relaxed);
+        }
+    }
+
+    C89ATOMIC_MPMC_QUEUE_COPY_MEMORY(C89ATOMIC_MPMC_QUEUE_GET_ELEMENT(pSlot), pElement, pQueue->stride);
+
+    /* Hand the slot over to the consumers. Release so they see the element. */
+    c89atomic_store_explicit_32(C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(pSlot), head + 1, c89atomic_memory_order_release);
+
+    return C89ATOMIC_MPMC_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_pop(c89atomic_mpmc_queue* pQueue, void* pElement)
+{
+    c89atomic_uint32 tail = c89atomic_load_explicit_32(&pQueue->tail, c89atomic_memory_order_relaxed);
+    c89atomic_uint8* pSlot;
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_uint32 sequence;
+        c89atomic_int32 diff;
+
+        pSlot = C89ATOMIC_MPMC_QUEUE_GET_SLOT(pQueue, tail);
+
+        /* Acquire so that we see the element written by the producer. */
+        sequence = c89atomic_load_explicit_32(C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(pSlot), c89atomic_memory_order_acquire);
+        diff = (c89atomic_int32)(sequence - (tail + 1));
+
+        if (diff == 0) {
+            if (c89atomic_compare_exchange_weak_explicit_32(&pQueue->tail, &tail, tail + 1, c89atomic_memory_order_relaxed, c89atomic_memory_order_relaxed)) {
+                break;
+            }
+
+            c89atomic_backoff_spin(&backoff);
+        } else if (diff < 0) {
+            /* Nothing has been pushed to this slot yet. */
+            return C89ATOMIC_MPMC_QUEUE_EMPTY;
+        } else {
+            /* Another consumer got here first. */
+            tail = c89atomic_load_explicit_32(&pQueue->tail, c89atomic_memory_order_relaxed);
+        }
+    }
+
+    C89ATOMIC_MPMC_QUEUE_COPY_MEMORY(pElement, C89ATOMIC_MPMC_QUEUE_GET_ELEMENT(pSlot), pQueue->stride);
+
+    /* Hand the slot back to the producers for the next lap. Release so we've finished reading before it's overwritten. */
+    c89atomic_store_explicit_32(C89ATOMIC_MPMC_QUEUE_GET_SEQUENCE(pSlot), tail + pQueue->capacity, c89atomic_memory_order_release);
+
+    return C89ATOMIC_MPMC_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MPMC_QUEUE_API c89atomic_uint32 c89atomic_mpmc_queue_length(const c89atomic_mpmc_queue* pQueue)
+{
+    c89atomic_uint32 head;
+    c89atomic_uint32 tail;
+    c89atomic_uint32 length;
+
+    if (pQueue == NULL) {
+        return 0;
+    }
+
+    /* The tail is loaded first. The head can only move forward so it'll never be behind it. */
+    tail = c89atomic_load_explicit_32(&pQueue->tail, c89atomic_memory_order_acquire);
+    head = c89atomic_load_explicit_32(&pQueue->head, c89atomic_memory_order_acquire);
+
+    /* Other threads can move both cursors along in between the two loads, so the head can end up more than a full queue ahead. */
+    length = head - tail;
+    if (length > pQueue->capacity) {
+        length = pQueue->capacity;
+    }
+
+    return length;
+}
+
+C89ATOMIC_MPMC_QUEUE_API c89atomic_uint32 c89atomic_mpmc_queue_capacity(const c89atomic_mpmc_queue* pQueue)
+{
+    if (pQueue == NULL) {
+        return 0;
+    }
+
+    return pQueue->capacity;
+}
+/* END c89atomic_mpmc_queue.c */
+
+#endif  /* c89atomic_mpmc_queue_c */
@@ -0,0 +1,81 @@
+/*
+A bounded multi-producer, multi-consumer queue. This implements Dmitry Vyukov's "Bounded MPMC queue" (1024cores.net).
+
+Any number of threads can push and pop at the same time. Each slot in the queue has a sequence number next to the element which
+tells producers and consumers whether or not the slot is ready for them. A push or pop is one compare-exchange on the head or tail
+cursor to claim a slot, a copy of the element and then a store to the slot's sequence number to hand it over. Producers and
+consumers never touch each other's cursor, and a slow thread in the middle of a push or pop only holds up the slot it claimed.
+
+The capacity must be a power of 2 and cannot be changed after initialization. You need to allocate the buffer yourself. Use
+c89atomic_mpmc_queue_get_buffer_size() to find out how big it needs to be. The buffer must be aligned to at least 8 bytes:
+
+    size_t bufferSize = c89atomic_mpmc_queue_get_buffer_size(1024, sizeof(my_job));
+    void* pBuffer = malloc(bufferSize);
+
+    c89atomic_mpmc_queue queue;
+    c89atomic_mpmc_queue_init(1024, sizeof(my_job), pBuffer, &queue);
+
+Elements are copied in and out of the queue:
+
+    my_job job;
+    ...
+    if (c89atomic_mpmc_queue_push(&queue, &job) == C89ATOMIC_MPMC_QUEUE_FULL) {
+        // The queue is full.
+    }
+
+    if (c89atomic_mpmc_queue_pop(&queue, &job) == C89ATOMIC_MPMC_QUEUE_EMPTY) {
+        // The queue is empty.
+    }
+
+Neither function blocks. It's up to you to decide what to do when the queue is full or empty.
+
+This will not validate function parameters except in c89atomic_mpmc_queue_init().
+*/
+#ifndef c89atomic_mpmc_queue_h
+#define c89atomic_mpmc_queue_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_MPMC_QUEUE_API
+#define C89ATOMIC_MPMC_QUEUE_API
+#endif
+
+#ifndef C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE
+#define C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE    C89ATOMIC_CACHE_LINE_SIZE
+#endif
+
+typedef enum
+{
+    C89ATOMIC_MPMC_QUEUE_SUCCESS = 0,
+    C89ATOMIC_MPMC_QUEUE_INVALID_ARGS,
+    C89ATOMIC_MPMC_QUEUE_FULL,      /* Can be returned when pushing. */
+    C89ATOMIC_MPMC_QUEUE_EMPTY      /* Can be returned when popping. */
+} c89atomic_mpmc_queue_result;
+
+/* BEG c89atomic_mpmc_queue.h */
+typedef struct c89atomic_mpmc_queue
+{
+    c89atomic_uint32 head;      /* Atomic. The next slot to push to. Only touched by producers. */
+    #if C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE > 4
+    c89atomic_uint8 pad0[C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE - 4];    /* Keeps producers and consumers from fighting over the same cache line. */
+    #endif
+    c89atomic_uint32 tail;      /* Atomic. The next slot to pop from. Only touched by consumers. */
+    #if C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE > 4
+    c89atomic_uint8 pad1[C89ATOMIC_MPMC_QUEUE_CACHE_LINE_SIZE - 4];
+    #endif
+    c89atomic_uint32 capacity;  /* Capacity of the queue, in elements. Always a power of 2. */
+    c89atomic_uint32 stride;    /* Size of an element in bytes. */
+    c89atomic_uint32 slotSize;  /* Size of a slot in bytes, including the sequence number. */
+    void* pBuffer;
+} c89atomic_mpmc_queue;
+
+C89ATOMIC_MPMC_QUEUE_API size_t c89atomic_mpmc_queue_get_buffer_size(c89atomic_uint32 capacity, c89atomic_uint32 stride);
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_init(c89atomic_uint32 capacity, c89atomic_uint32 stride, void* pBuffer, c89atomic_mpmc_queue* pQueue);  /* Capacity must be a power of 2. The buffer must be at least c89atomic_mpmc_queue_get_buffer_size() bytes. */
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_push(c89atomic_mpmc_queue* pQueue, const void* pElement);
+C89ATOMIC_MPMC_QUEUE_API c89atomic_mpmc_queue_result c89atomic_mpmc_queue_pop(c89atomic_mpmc_queue* pQueue, void* pElement);
+C89ATOMIC_MPMC_QUEUE_API c89atomic_uint32 c89atomic_mpmc_queue_length(const c89atomic_mpmc_queue* pQueue);       /* Approximate. It may be out of date by the time it returns. */
+C89ATOMIC_MPMC_QUEUE_API c89atomic_uint32 c89atomic_mpmc_queue_capacity(const c89atomic_mpmc_queue* pQueue);
+/* END c89atomic_mpmc_queue.h */
+
+#endif  /* c89atomic_mpmc_queue_h */
@@ -0,0 +1,98 @@
+#ifndef c89atomic_mpsc_queue_c
+#define c89atomic_mpsc_queue_c
+
+#include "c89atomic_mpsc_queue.h"
+
+/* BEG c89atomic_mpsc_queue.c */
+C89ATOMIC_MPSC_QUEUE_API void c89atomic_mpsc_queue_init(c89atomic_mpsc_queue* pQueue)
+{
+    if (pQueue == NULL) {
+        return;
+    }
+
+    pQueue->stub.pNext = NULL;
+    pQueue->pHead      = &pQueue->stub;
+    pQueue->pTail      = &pQueue->stub;
+
+    /* Make sure other threads see the initialized queue if it's handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+}
+
+C89ATOMIC_MPSC_QUEUE_API void c89atomic_mpsc_queue_push(c89atomic_mpsc_queue* pQueue, c89atomic_mpsc_queue_node* pNode)
+{
+    c89atomic_mpsc_queue_node* pPrev;
+
+    c89atomic_store_explicit_ptr((volatile void**)&pNode->pNext, NULL, c89atomic_memory_order_relaxed);
+
+    /*
+    Claiming our place in the queue is just a matter of swapping ourselves in as the head. The queue is
+    broken between here and the store below. The consumer won't be able to get past the previous node
+    until we've linked it to ours.
+    */
+    pPrev = (c89atomic_mpsc_queue_node*)c89atomic_exchange_explicit_ptr((volatile void**)&pQueue->pHead, pNode, c89atomic_memory_order_acq_rel);
+
+    /* Release so that the consumer sees the contents of the message once it sees the link. */
+    c89atomic_store_explicit_ptr((volatile void**)&pPrev->pNext, pNode, c89atomic_memory_order_release);
+}
+
+C89ATOMIC_MPSC_QUEUE_API c89atomic_mpsc_queue_node* c89atomic_mpsc_queue_pop(c89atomic_mpsc_queue* pQueue)
+{
+    c89atomic_mpsc_queue_node* pTail = pQueue->pTail;
+    c89atomic_mpsc_queue_node* pNext = (c89atomic_mpsc_queue_node*)c89atomic_load_explicit_ptr((volatile void**)&pTail->pNext, c89atomic_memory_order_acquire);
+    c89atomic_mpsc_queue_node* pHead;
+
+    /* The stub is never returned. Skip over it if it's in the way. */
+    if (pTail == &pQueue->stub) {
+        if (pNext == NULL) {
+            return NULL;    /* Empty. */
+        }
+
+        pQueue->pTail = pNext;
+        pTail = pNext;
+        pNext = (c89atomic_mpsc_queue_node*)c89atomic_load_explicit_ptr((volatile void**)&pTail->pNext, c89atomic_memory_order_acquire);
+    }
+
+    /* This is the normal case. There's another node after this one so it can be returned as is. */
+    if (pNext != NULL) {
+        pQueue->pTail = pNext;
+        return pTail;
+    }
+
+    /*
+    The tail looks like the last node. If it's not the head, a producer has swapped in a new head but
+    hasn't linked it to the tail yet. We can't get past it so we'll need to come back later.
+    */
+    pHead = (c89atomic_mpsc_queue_node*)c89atomic_load_explicit_ptr((volatile void**)&pQueue->pHead, c89atomic_memory_order_acquire);
+    if (pTail != pHead) {
+        return NULL;
+    }
+
+    /*
+    The tail is the last node, but we can't return it because the queue would have nothing left in it.
+    The stub is pushed back in so there's something to take its place.
+    */
+    c89atomic_mpsc_queue_push(pQueue, &pQueue->stub);
+
+    pNext = (c89atomic_mpsc_queue_node*)c89atomic_load_explicit_ptr((volatile void**)&pTail->pNext, c89atomic_memory_order_acquire);
+    if (pNext != NULL) {
+        pQueue->pTail = pNext;
+        return pTail;
+    }
+
+    /* Another producer got in before the stub and hasn't finished linking. */
+    return NULL;
+}
+
+C89ATOMIC_MPSC_QUEUE_API c89atomic_bool c89atomic_mpsc_queue_is_empty(c89atomic_mpsc_queue* pQueue)
+{
+    c89atomic_mpsc_queue_node* pTail = pQueue->pTail;
+
+    if (pTail != &pQueue->stub) {
+        return 0;
+    }
+
+    return c89atomic_load_explicit_ptr((volatile void**)&pTail->pNext, c89atomic_memory_order_acquire) == NULL;
+}
+/* END c89atomic_mpsc_queue.c */
+
+#endif  /* c89atomic_mpsc_queue_c */
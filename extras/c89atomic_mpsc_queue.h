@@ -0,0 +1,65 @@
+/*
+An intrusive multi-producer, single-consumer queue. This implements Dmitry Vyukov's "Intrusive MPSC node-based queue"
+(1024cores.net).
+
+This is intended for mailboxes, such as one per actor in an actor system, where lots of threads send messages to a single
+receiver. Any number of threads can push at the same time, but only one thread can pop. A push is a single exchange and a store.
+A pop is just loads and stores, except when it takes the last message in which case it needs one exchange to put the stub node
+back. Neither uses compare-exchange, and neither ever waits on another thread.
+
+Messages that go into the queue need to have a c89atomic_mpsc_queue_node somewhere inside them. The queue doesn't allocate or free
+anything. c89atomic_mpsc_queue_pop() returns a pointer to the node and it's up to you to get back to your message:
+
+    typedef struct
+    {
+        c89atomic_mpsc_queue_node node;
+        int type;
+        ...
+    } my_message;
+
+    c89atomic_mpsc_queue_push(&pActor->mailbox, &pMessage->node);
+    ...
+    my_message* pMessage = (my_message*)c89atomic_mpsc_queue_pop(&mailbox);  // Can do a cast like this because the node is the first member.
+
+The queue always contains a stub node which lives inside the queue itself. This means an empty queue doesn't need any extra memory,
+and a queue can be initialized without allocating. The head and tail are not padded onto separate cache lines. The idea is that you
+have lots of these, most of which are empty, so it's kept as small as possible.
+
+There's a short window in c89atomic_mpsc_queue_push() between a producer swapping itself in as the head and linking itself to the
+previous node. If the consumer gets to that node during that window, c89atomic_mpsc_queue_pop() will return NULL even though the
+queue isn't empty. The consumer should treat this the same as an empty queue and try again later. No messages are lost. This is the
+price of pushing and popping without any compare-exchanges. The same applies to c89atomic_mpsc_queue_is_empty().
+
+Initialize the queue with c89atomic_mpsc_queue_init(). The queue can't be copied or moved while it's in use because the head and
+tail can point to the stub node inside it.
+*/
+#ifndef c89atomic_mpsc_queue_h
+#define c89atomic_mpsc_queue_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_MPSC_QUEUE_API
+#define C89ATOMIC_MPSC_QUEUE_API
+#endif
+
+/* BEG c89atomic_mpsc_queue.h */
+typedef struct c89atomic_mpsc_queue_node
+{
+    struct c89atomic_mpsc_queue_node* pNext;
+} c89atomic_mpsc_queue_node;
+
+typedef struct c89atomic_mpsc_queue
+{
+    c89atomic_mpsc_queue_node* pHead;   /* Atomic. The most recently pushed node. Swapped by producers. */
+    c89atomic_mpsc_queue_node* pTail;   /* The next node to pop. Only touched by the consumer. */
+    c89atomic_mpsc_queue_node stub;
+} c89atomic_mpsc_queue;
+
+C89ATOMIC_MPSC_QUEUE_API void c89atomic_mpsc_queue_init(c89atomic_mpsc_queue* pQueue);
+C89ATOMIC_MPSC_QUEUE_API void c89atomic_mpsc_queue_push(c89atomic_mpsc_queue* pQueue, c89atomic_mpsc_queue_node* pNode);
+C89ATOMIC_MPSC_QUEUE_API c89atomic_mpsc_queue_node* c89atomic_mpsc_queue_pop(c89atomic_mpsc_queue* pQueue);   /* Consumer only. Returns NULL if the queue is empty, or if a push is partway through. */
+C89ATOMIC_MPSC_QUEUE_API c89atomic_bool c89atomic_mpsc_queue_is_empty(c89atomic_mpsc_queue* pQueue);           /* Consumer only. */
+/* END c89atomic_mpsc_queue.h */
+
+#endif  /* c89atomic_mpsc_queue_h */
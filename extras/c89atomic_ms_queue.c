@@ -0,0 +1,238 @@
+#ifndef c89atomic_ms_queue_c
+#define c89atomic_ms_queue_c
+
+#include "c89atomic_ms_queue.h"
+
+#include <string.h>
+#include <assert.h>
+
+#ifndef C89ATOMIC_MS_QUEUE_COPY_MEMORY
+#define C89ATOMIC_MS_QUEUE_COPY_MEMORY(dst, src, count) memcpy((dst), (src), (count))
+#endif
+
+/*
+Each node is a 64-bit link to the next node followed by the element. The element size is rounded up to
+8 bytes so that the links of every node stay aligned. The bitmap for the allocator sits in front of the
+nodes in the buffer.
+*/
+#define C89ATOMIC_MS_QUEUE_NODE_HEADER_SIZE     8
+#define C89ATOMIC_MS_QUEUE_NODE_SIZE(stride)    (C89ATOMIC_MS_QUEUE_NODE_HEADER_SIZE + (((stride) + 7) & ~(c89atomic_uint32)7))
+#define C89ATOMIC_MS_QUEUE_BITMAP_SIZE(nodeCount)   ((((size_t)(nodeCount) / 8) + 7) & ~(size_t)7)
+
+/* A link is an index in the low 32 bits and a tag in the high 32 bits. */
+#define C89ATOMIC_MS_QUEUE_NIL                  0xFFFFFFFF
+#define C89ATOMIC_MS_QUEUE_LINK_INDEX(link)     ((c89atomic_uint32)((link) & 0xFFFFFFFF))
+#define C89ATOMIC_MS_QUEUE_LINK_TAG(link)       ((c89atomic_uint32)((link) >> 32))
+#define C89ATOMIC_MS_QUEUE_MAKE_LINK(index, tag)    (((c89atomic_uint64)(tag) << 32) | (c89atomic_uint32)(index))
+
+static C89ATOMIC_INLINE c89atomic_uint8* c89atomic_ms_queue_get_node(c89atomic_ms_queue_pool* pPool, c89atomic_uint32 index)
+{
+    return (c89atomic_uint8*)pPool->pNodes + (size_t)index * pPool->nodeSize;
+}
+
+static C89ATOMIC_INLINE c89atomic_uint64* c89atomic_ms_queue_get_next(c89atomic_ms_queue_pool* pPool, c89atomic_uint32 index)
+{
+    return (c89atomic_uint64*)c89atomic_ms_queue_get_node(pPool, index);
+}
+
+static C89ATOMIC_INLINE void* c89atomic_ms_queue_get_element(c89atomic_ms_queue_pool* pPool, c89atomic_uint32 index)
+{
+    return c89atomic_ms_queue_get_node(pPool, index) + C89ATOMIC_MS_QUEUE_NODE_HEADER_SIZE;
+}
+
+static c89atomic_ms_queue_result c89atomic_ms_queue_alloc_node(c89atomic_ms_queue_pool* pPool, c89atomic_uint32* pIndex)
+{
+    size_t index;
+    c89atomic_uint64* pNext;
+
+    if (c89atomic_bitmap_allocator_alloc(&pPool->allocator, &index) != C89ATOMIC_BITMAP_ALLOCATOR_SUCCESS) {
+        return C89ATOMIC_MS_QUEUE_OUT_OF_MEMORY;
+    }
+
+    /*
+    The node might still be looked at by a thread that saw it before it was last popped. Its tag is kept
+    and only the index is cleared, which is enough to make that thread's compare-exchange fail.
+    */
+    pNext = c89atomic_ms_queue_get_next(pPool, (c89atomic_uint32)index);
+    c89atomic_store_explicit_64(pNext, C89ATOMIC_MS_QUEUE_MAKE_LINK(C89ATOMIC_MS_QUEUE_NIL, C89ATOMIC_MS_QUEUE_LINK_TAG(c89atomic_load_explicit_64(pNext, c89atomic_memory_order_relaxed))), c89atomic_memory_order_relaxed);
+
+    *pIndex = (c89atomic_uint32)index;
+    return C89ATOMIC_MS_QUEUE_SUCCESS;
+}
+
+
+/* BEG c89atomic_ms_queue.c */
+C89ATOMIC_MS_QUEUE_API size_t c89atomic_ms_queue_pool_get_buffer_size(c89atomic_uint32 nodeCount, c89atomic_uint32 stride)
+{
+    return C89ATOMIC_MS_QUEUE_BITMAP_SIZE(nodeCount) + (size_t)nodeCount * C89ATOMIC_MS_QUEUE_NODE_SIZE(stride);
+}
+
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_pool_init(c89atomic_uint32 nodeCount, c89atomic_uint32 stride, void* pBuffer, c89atomic_ms_queue_pool* pPool)
+{
+    c89atomic_uint32 iNode;
+
+    if (pPool == NULL || pBuffer == NULL || stride == 0) {
+        return C89ATOMIC_MS_QUEUE_INVALID_ARGS;
+    }
+
+    /* The bitmap allocator needs whole 32-bit words. This also means an index can never be the same as the nil link. */
+    if (nodeCount == 0 || (nodeCount & 31) != 0 || stride > 0xFFFFFFFF - 15) {
+        return C89ATOMIC_MS_QUEUE_INVALID_ARGS;
+    }
+
+    if (c89atomic_bitmap_allocator_init(pBuffer, nodeCount, &pPool->allocator) != C89ATOMIC_BITMAP_ALLOCATOR_SUCCESS) {
+        return C89ATOMIC_MS_QUEUE_INVALID_ARGS;
+    }
+
+    pPool->pNodes    = (c89atomic_uint8*)pBuffer + C89ATOMIC_MS_QUEUE_BITMAP_SIZE(nodeCount);
+    pPool->nodeCount = nodeCount;
+    pPool->stride    = stride;
+    pPool->nodeSize  = C89ATOMIC_MS_QUEUE_NODE_SIZE(stride);
+
+    for (iNode = 0; iNode < nodeCount; iNode += 1) {
+        *c89atomic_ms_queue_get_next(pPool, iNode) = C89ATOMIC_MS_QUEUE_MAKE_LINK(C89ATOMIC_MS_QUEUE_NIL, 0);
+    }
+
+    /* Make sure other threads see the initialized nodes if the pool is handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_MS_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_init(c89atomic_ms_queue_pool* pPool, c89atomic_ms_queue* pQueue)
+{
+    c89atomic_ms_queue_result result;
+    c89atomic_uint32 dummy;
+
+    if (pQueue == NULL || pPool == NULL) {
+        return C89ATOMIC_MS_QUEUE_INVALID_ARGS;
+    }
+
+    /* The head always points to a dummy node. The first element is the one after it. */
+    result = c89atomic_ms_queue_alloc_node(pPool, &dummy);
+    if (result != C89ATOMIC_MS_QUEUE_SUCCESS) {
+        return result;
+    }
+
+    c89atomic_store_explicit_64(&pQueue->head, C89ATOMIC_MS_QUEUE_MAKE_LINK(dummy, 0), c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_64(&pQueue->tail, C89ATOMIC_MS_QUEUE_MAKE_LINK(dummy, 0), c89atomic_memory_order_relaxed);
+    pQueue->pPool = pPool;
+
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_MS_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MS_QUEUE_API void c89atomic_ms_queue_uninit(c89atomic_ms_queue* pQueue)
+{
+    c89atomic_uint32 index = C89ATOMIC_MS_QUEUE_LINK_INDEX(c89atomic_load_explicit_64(&pQueue->head, c89atomic_memory_order_acquire));
+
+    /* Nobody else is using the queue at this point so we can just walk the list, starting with the dummy. */
+    while (index != C89ATOMIC_MS_QUEUE_NIL) {
+        c89atomic_uint32 next = C89ATOMIC_MS_QUEUE_LINK_INDEX(c89atomic_load_explicit_64(c89atomic_ms_queue_get_next(pQueue->pPool, index), c89atomic_memory_order_relaxed));
+        c89atomic_bitmap_allocator_free(&pQueue->pPool->allocator, index);
+        index = next;
+    }
+}
+
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_push(c89atomic_ms_queue* pQueue, const void* pElement)
+{
+    c89atomic_ms_queue_pool* pPool = pQueue->pPool;
+    c89atomic_ms_queue_result result;
+    c89atomic_uint32 node;
+    c89atomic_uint64 tail;
+    c89atomic_backoff backoff;
+
+    result = c89atomic_ms_queue_alloc_node(pPool, &node);
+    if (result != C89ATOMIC_MS_QUEUE_SUCCESS) {
+        return result;
+    }
+
+    C89ATOMIC_MS_QUEUE_COPY_MEMORY(c89atomic_ms_queue_get_element(pPool, node), pElement, pPool->stride);
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_uint64* pTailNext;
+        c89atomic_uint64 next;
+
+        tail      = c89atomic_load_explicit_64(&pQueue->tail, c89atomic_memory_order_acquire);
+        pTailNext = c89atomic_ms_queue_get_next(pPool, C89ATOMIC_MS_QUEUE_LINK_INDEX(tail));
+        next      = c89atomic_load_explicit_64(pTailNext, c89atomic_memory_order_acquire);
+
+        /* If the tail has moved, the node we loaded `next` from might have been popped and reused. */
+        if (tail != c89atomic_load_explicit_64(&pQueue->tail, c89atomic_memory_order_acquire)) {
+            continue;
+        }
+
+        if (C89ATOMIC_MS_QUEUE_LINK_INDEX(next) == C89ATOMIC_MS_QUEUE_NIL) {
+            /* The tail really is the last node. Link ours after it. Release so that consumers see the element. */
+            if (c89atomic_compare_exchange_weak_explicit_64(pTailNext, &next, C89ATOMIC_MS_QUEUE_MAKE_LINK(node, C89ATOMIC_MS_QUEUE_LINK_TAG(next) + 1), c89atomic_memory_order_release, c89atomic_memory_order_relaxed)) {
+                break;
+            }
+
+            c89atomic_backoff_spin(&backoff);
+        } else {
+            /* Another producer has linked a node but hasn't moved the tail yet. Help it along. */
+            c89atomic_compare_exchange_weak_explicit_64(&pQueue->tail, &tail, C89ATOMIC_MS_QUEUE_MAKE_LINK(C89ATOMIC_MS_QUEUE_LINK_INDEX(next), C89ATOMIC_MS_QUEUE_LINK_TAG(tail) + 1), c89atomic_memory_order_release, c89atomic_memory_order_relaxed);
+        }
+    }
+
+    /* Move the tail to our node. If this fails someone else has already done it for us. */
+    c89atomic_compare_exchange_strong_explicit_64(&pQueue->tail, &tail, C89ATOMIC_MS_QUEUE_MAKE_LINK(node, C89ATOMIC_MS_QUEUE_LINK_TAG(tail) + 1), c89atomic_memory_order_release, c89atomic_memory_order_relaxed);
+
+    return C89ATOMIC_MS_QUEUE_SUCCESS;
+}
+
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_pop(c89atomic_ms_queue* pQueue, void* pElement)
+{
+    c89atomic_ms_queue_pool* pPool = pQueue->pPool;
+    c89atomic_uint64 head;
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_uint64 tail;
+        c89atomic_uint64 next;
+
+        head = c89atomic_load_explicit_64(&pQueue->head, c89atomic_memory_order_acquire);
+        tail = c89atomic_load_explicit_64(&pQueue->tail, c89atomic_memory_order_acquire);
+        next = c89atomic_load_explicit_64(c89atomic_ms_queue_get_next(pPool, C89ATOMIC_MS_QUEUE_LINK_INDEX(head)), c89atomic_memory_order_acquire);
+
+        /* If the head has moved, `next` could have come from a node that's been reused. */
+        if (head != c89atomic_load_explicit_64(&pQueue->head, c89atomic_memory_order_acquire)) {
+            continue;
+        }
+
+        if (C89ATOMIC_MS_QUEUE_LINK_INDEX(head) == C89ATOMIC_MS_QUEUE_LINK_INDEX(tail)) {
+            if (C89ATOMIC_MS_QUEUE_LINK_INDEX(next) == C89ATOMIC_MS_QUEUE_NIL) {
+                return C89ATOMIC_MS_QUEUE_EMPTY;
+            }
+
+            /* The tail is behind. Help the producer that hasn't moved it yet. */
+            c89atomic_compare_exchange_weak_explicit_64(&pQueue->tail, &tail, C89ATOMIC_MS_QUEUE_MAKE_LINK(C89ATOMIC_MS_QUEUE_LINK_INDEX(next), C89ATOMIC_MS_QUEUE_LINK_TAG(tail) + 1), c89atomic_memory_order_release, c89atomic_memory_order_relaxed);
+        } else {
+            /*
+            The element needs to be read before moving the head. Once the head has moved, the next node becomes
+            the dummy and another consumer could pop it and give it back to the pool. If that happens while we're
+            copying we'll get garbage, but the compare-exchange will fail and we'll copy it again.
+            */
+            C89ATOMIC_MS_QUEUE_COPY_MEMORY(pElement, c89atomic_ms_queue_get_element(pPool, C89ATOMIC_MS_QUEUE_LINK_INDEX(next)), pPool->stride);
+
+            if (c89atomic_compare_exchange_weak_explicit_64(&pQueue->head, &head, C89ATOMIC_MS_QUEUE_MAKE_LINK(C89ATOMIC_MS_QUEUE_LINK_INDEX(next), C89ATOMIC_MS_QUEUE_LINK_TAG(head) + 1), c89atomic_memory_order_acq_rel, c89atomic_memory_order_relaxed)) {
+                break;
+            }
+
+            c89atomic_backoff_spin(&backoff);
+        }
+    }
+
+    /* The old dummy is ours now. The node we just read from is the new dummy. */
+    c89atomic_bitmap_allocator_free(&pPool->allocator, C89ATOMIC_MS_QUEUE_LINK_INDEX(head));
+
+    return C89ATOMIC_MS_QUEUE_SUCCESS;
+}
+/* END c89atomic_ms_queue.c */
+
+#endif  /* c89atomic_ms_queue_c */
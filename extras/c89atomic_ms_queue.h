@@ -0,0 +1,95 @@
+/*
+An unbounded multi-producer, multi-consumer queue. This implements "Michael and Scott, Simple, Fast, and Practical Non-Blocking and
+Blocking Concurrent Queue Algorithms (PODC 1996)".
+
+Any number of threads can push and pop at the same time. Unlike c89atomic_mpmc_queue and c89atomic_ring_buffer, the queue is a
+linked list and doesn't have a capacity of its own. Nodes are taken from a pool when pushing and given back when popping. The pool
+is a fixed size slab of nodes managed by a c89atomic_bitmap_allocator so nothing is allocated once it's been set up. A pool can be
+shared between any number of queues, so rather than sizing each queue for its worst case burst, you size the pool for the total
+backlog across all of them.
+
+You need to allocate the pool's memory yourself. Use c89atomic_ms_queue_pool_get_buffer_size() to find out how big it needs to be.
+The node count must be a multiple of 32 and the buffer must be aligned to at least 8 bytes. Every queue keeps one node for itself
+so the pool needs at least one node per queue on top of the number of elements you want to hold:
+
+    size_t bufferSize = c89atomic_ms_queue_pool_get_buffer_size(1024, sizeof(my_message));
+    void* pBuffer = malloc(bufferSize);
+
+    c89atomic_ms_queue_pool pool;
+    c89atomic_ms_queue_pool_init(1024, sizeof(my_message), pBuffer, &pool);
+
+    c89atomic_ms_queue queue;
+    c89atomic_ms_queue_init(&pool, &queue);
+
+Elements are copied in and out of the queue. c89atomic_ms_queue_push() returns C89ATOMIC_MS_QUEUE_OUT_OF_MEMORY when the pool has
+run out of nodes, and c89atomic_ms_queue_pop() returns C89ATOMIC_MS_QUEUE_EMPTY when there's nothing in the queue. Neither function
+blocks.
+
+Nodes are referred to by their index in the pool rather than by pointer. The links between nodes and the head and tail of the queue
+are 64-bit values made up of a 32-bit index and a 32-bit tag which is incremented every time the link changes. This is what stops
+a thread from being fooled by a node that was popped and then reused while it was looking at it (the ABA problem). Because the
+nodes are never actually freed, it's safe for a thread to read from a node that has just been popped by someone else. The
+compare-exchange will fail and it'll try again.
+
+c89atomic_ms_queue_uninit() gives every node in the queue back to the pool. It must only be called when no other thread is using
+the queue.
+
+This depends on c89atomic_bitmap_allocator so you'll need to compile c89atomic_bitmap_allocator.c as well.
+
+This will not validate function parameters except in the init functions.
+*/
+#ifndef c89atomic_ms_queue_h
+#define c89atomic_ms_queue_h
+
+#include "../c89atomic.h"
+#include "c89atomic_bitmap_allocator.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_MS_QUEUE_API
+#define C89ATOMIC_MS_QUEUE_API
+#endif
+
+#ifndef C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE
+#define C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE  C89ATOMIC_CACHE_LINE_SIZE
+#endif
+
+typedef enum
+{
+    C89ATOMIC_MS_QUEUE_SUCCESS = 0,
+    C89ATOMIC_MS_QUEUE_INVALID_ARGS,
+    C89ATOMIC_MS_QUEUE_OUT_OF_MEMORY,   /* Can be returned when pushing and the pool has run out of nodes. */
+    C89ATOMIC_MS_QUEUE_EMPTY            /* Can be returned when popping. */
+} c89atomic_ms_queue_result;
+
+/* BEG c89atomic_ms_queue.h */
+typedef struct c89atomic_ms_queue_pool
+{
+    c89atomic_bitmap_allocator allocator;
+    void* pNodes;
+    c89atomic_uint32 nodeCount;
+    c89atomic_uint32 stride;    /* Size of an element in bytes. */
+    c89atomic_uint32 nodeSize;  /* Size of a node in bytes, including the link. */
+} c89atomic_ms_queue_pool;
+
+typedef struct c89atomic_ms_queue
+{
+    c89atomic_uint64 head;      /* Atomic. Index of the dummy node in the low 32 bits, tag in the high 32 bits. Only touched by consumers. */
+    #if C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE > 8
+    c89atomic_uint8 pad0[C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE - 8];
+    #endif
+    c89atomic_uint64 tail;      /* Atomic. Index of the last node, or close to it. Mostly touched by producers. */
+    #if C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE > 8
+    c89atomic_uint8 pad1[C89ATOMIC_MS_QUEUE_CACHE_LINE_SIZE - 8];
+    #endif
+    c89atomic_ms_queue_pool* pPool;
+} c89atomic_ms_queue;
+
+C89ATOMIC_MS_QUEUE_API size_t c89atomic_ms_queue_pool_get_buffer_size(c89atomic_uint32 nodeCount, c89atomic_uint32 stride);
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_pool_init(c89atomic_uint32 nodeCount, c89atomic_uint32 stride, void* pBuffer, c89atomic_ms_queue_pool* pPool);   /* Node count must be a multiple of 32. The buffer must be at least c89atomic_ms_queue_pool_get_buffer_size() bytes. */
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_init(c89atomic_ms_queue_pool* pPool, c89atomic_ms_queue* pQueue);    /* Takes one node from the pool. */
+C89ATOMIC_MS_QUEUE_API void c89atomic_ms_queue_uninit(c89atomic_ms_queue* pQueue);
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_push(c89atomic_ms_queue* pQueue, const void* pElement);
+C89ATOMIC_MS_QUEUE_API c89atomic_ms_queue_result c89atomic_ms_queue_pop(c89atomic_ms_queue* pQueue, void* pElement);
+/* END c89atomic_ms_queue.h */
+
+#endif  /* c89atomic_ms_queue_h */
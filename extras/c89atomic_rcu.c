@@ -0,0 +1,243 @@
+#ifndef c89atomic_rcu_c
+#define c89atomic_rcu_c
+
+#include "c89atomic_rcu.h"
+
+#include <assert.h>
+
+/* Grace periods wrap around so they need to be compared by their difference. */
+#define C89ATOMIC_RCU_HAS_REACHED(gracePeriod, target)  ((c89atomic_int32)((gracePeriod) - (target)) >= 0)
+
+/* BEG c89atomic_rcu.c */
+C89ATOMIC_RCU_API c89atomic_rcu_result c89atomic_rcu_domain_init(c89atomic_rcu_record* pRecords, c89atomic_uint32 recordCount, c89atomic_rcu_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+
+    if (pDomain == NULL || pRecords == NULL || recordCount == 0) {
+        return C89ATOMIC_RCU_INVALID_ARGS;
+    }
+
+    for (iRecord = 0; iRecord < recordCount; iRecord += 1) {
+        pRecords[iRecord].gracePeriod  = 0;
+        pRecords[iRecord].inUse        = 0;
+        pRecords[iRecord].pPendingHead = NULL;
+        pRecords[iRecord].pPendingTail = NULL;
+        pRecords[iRecord].pendingCount = 0;
+    }
+
+    pDomain->gracePeriod = 1;
+    pDomain->pRecords    = pRecords;
+    pDomain->recordCount = recordCount;
+
+    /* Make sure other threads see the initialized records if the domain is handed over with a relaxed store. */
+    c89atomic_thread_fence(c89atomic_memory_order_release);
+
+    return C89ATOMIC_RCU_SUCCESS;
+}
+
+static void c89atomic_rcu_run_callbacks(c89atomic_rcu_record* pRecord, c89atomic_uint32 completedGracePeriod, c89atomic_bool runAll)
+{
+    /* Callbacks are queued in grace period order so we can stop at the first one that isn't ready. */
+    while (pRecord->pPendingHead != NULL) {
+        c89atomic_rcu_head* pHead = pRecord->pPendingHead;
+
+        if (!runAll && !C89ATOMIC_RCU_HAS_REACHED(completedGracePeriod, pHead->gracePeriod)) {
+            break;
+        }
+
+        pRecord->pPendingHead  = pHead->pNext;
+        pRecord->pendingCount -= 1;
+        pHead->callback(pHead);
+    }
+
+    if (pRecord->pPendingHead == NULL) {
+        pRecord->pPendingTail = NULL;
+    }
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_domain_uninit(c89atomic_rcu_domain* pDomain)
+{
+    c89atomic_uint32 iRecord;
+
+    /* Nobody else is using the domain at this point so everything can be run. */
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_rcu_run_callbacks(&pDomain->pRecords[iRecord], 0, 1);
+    }
+}
+
+C89ATOMIC_RCU_API c89atomic_rcu_result c89atomic_rcu_domain_acquire_record(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record** ppRecord)
+{
+    c89atomic_uint32 iRecord;
+
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_rcu_record* pRecord = &pDomain->pRecords[iRecord];
+        c89atomic_uint32 expected = 0;
+
+        if (c89atomic_load_explicit_32(&pRecord->inUse, c89atomic_memory_order_relaxed) != 0) {
+            continue;
+        }
+
+        /* Acquire so we see the callbacks left behind by the previous owner. */
+        if (c89atomic_compare_exchange_strong_explicit_32(&pRecord->inUse, &expected, 1, c89atomic_memory_order_acquire, c89atomic_memory_order_relaxed)) {
+            c89atomic_rcu_thread_online(pDomain, pRecord);
+
+            *ppRecord = pRecord;
+            return C89ATOMIC_RCU_SUCCESS;
+        }
+    }
+
+    *ppRecord = NULL;
+    return C89ATOMIC_RCU_OUT_OF_RECORDS;
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_domain_release_record(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    c89atomic_rcu_thread_offline(pDomain, pRecord);
+
+    /* Try to clean up while we're here. Anything left over will be picked up by the next owner. */
+    c89atomic_rcu_poll(pDomain, pRecord);
+
+    c89atomic_store_explicit_32(&pRecord->inUse, 0, c89atomic_memory_order_release);
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_quiescent_state(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    /*
+    The acquire pairs with the increment in c89atomic_rcu_start_grace_period(). If we see the new grace
+    period we'll also see any pointer that was swapped before it started, so we can't go on to load an
+    old pointer after telling the writer we're done with them. The release makes sure we've finished
+    reading from the old objects before the writer sees that we've moved on.
+
+    Going offline and back online has a fence in it, but this doesn't need one. If we load an older
+    grace period the writer will just wait for our next quiescent state.
+    */
+    c89atomic_uint32 gracePeriod = c89atomic_load_explicit_32(&pDomain->gracePeriod, c89atomic_memory_order_acquire);
+    c89atomic_store_explicit_32(&pRecord->gracePeriod, gracePeriod, c89atomic_memory_order_release);
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_thread_online(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    c89atomic_rcu_quiescent_state(pDomain, pRecord);
+
+    /*
+    A writer could have skipped us while we were offline, so we need to make sure it sees that we're
+    online before we read anything. This pairs with the fence in c89atomic_rcu_start_grace_period().
+    */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_thread_offline(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    (void)pDomain;
+    c89atomic_store_explicit_32(&pRecord->gracePeriod, 0, c89atomic_memory_order_release);
+}
+
+static c89atomic_uint32 c89atomic_rcu_start_grace_period(c89atomic_rcu_domain* pDomain)
+{
+    c89atomic_uint32 gracePeriod = c89atomic_fetch_add_explicit_32(&pDomain->gracePeriod, 2, c89atomic_memory_order_seq_cst) + 2;
+
+    /* Pairs with the fence in c89atomic_rcu_thread_online(). */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+
+    return gracePeriod;
+}
+
+/*
+Returns the oldest grace period seen by an online thread other than the caller. If there are none,
+everything up to and including `current` is complete.
+*/
+static c89atomic_uint32 c89atomic_rcu_get_completed_grace_period(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord, c89atomic_uint32 current)
+{
+    c89atomic_uint32 completed = current;
+    c89atomic_uint32 iRecord;
+
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_uint32 gracePeriod;
+
+        if (&pDomain->pRecords[iRecord] == pRecord) {
+            continue;   /* The caller is in a quiescent state. */
+        }
+
+        gracePeriod = c89atomic_load_explicit_32(&pDomain->pRecords[iRecord].gracePeriod, c89atomic_memory_order_acquire);
+        if (gracePeriod != 0 && !C89ATOMIC_RCU_HAS_REACHED(gracePeriod, completed)) {
+            completed = gracePeriod;
+        }
+    }
+
+    return completed;
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_synchronize(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    c89atomic_uint32 target = c89atomic_rcu_start_grace_period(pDomain);
+    c89atomic_uint32 iRecord;
+
+    if (pRecord != NULL) {
+        c89atomic_rcu_quiescent_state(pDomain, pRecord);
+    }
+
+    for (iRecord = 0; iRecord < pDomain->recordCount; iRecord += 1) {
+        c89atomic_backoff backoff;
+        c89atomic_backoff_init(&backoff);
+
+        if (&pDomain->pRecords[iRecord] == pRecord) {
+            continue;
+        }
+
+        for (;;) {
+            c89atomic_uint32 gracePeriod = c89atomic_load_explicit_32(&pDomain->pRecords[iRecord].gracePeriod, c89atomic_memory_order_acquire);
+            if (gracePeriod == 0 || C89ATOMIC_RCU_HAS_REACHED(gracePeriod, target)) {
+                break;
+            }
+
+            c89atomic_backoff_snooze(&backoff);
+        }
+    }
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_call(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord, c89atomic_rcu_head* pHead, c89atomic_rcu_callback callback)
+{
+    pHead->pNext       = NULL;
+    pHead->callback    = callback;
+    pHead->gracePeriod = c89atomic_rcu_start_grace_period(pDomain);
+
+    if (pRecord->pPendingTail != NULL) {
+        pRecord->pPendingTail->pNext = pHead;
+    } else {
+        pRecord->pPendingHead = pHead;
+    }
+
+    pRecord->pPendingTail  = pHead;
+    pRecord->pendingCount += 1;
+
+    /* Writers are expected to be rare so we can afford to check for finished callbacks every time. */
+    c89atomic_rcu_poll(pDomain, pRecord);
+}
+
+C89ATOMIC_RCU_API c89atomic_uint32 c89atomic_rcu_poll(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    c89atomic_uint32 current;
+
+    if (pRecord->pPendingHead == NULL) {
+        return 0;
+    }
+
+    current = c89atomic_load_explicit_32(&pDomain->gracePeriod, c89atomic_memory_order_acquire);
+    c89atomic_rcu_run_callbacks(pRecord, c89atomic_rcu_get_completed_grace_period(pDomain, pRecord, current), 0);
+
+    return pRecord->pendingCount;
+}
+
+C89ATOMIC_RCU_API void c89atomic_rcu_barrier(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord)
+{
+    /* Every pending callback was queued before this grace period so once it's done they can all be run. */
+    if (pRecord->pPendingHead == NULL) {
+        return;
+    }
+
+    c89atomic_rcu_synchronize(pDomain, pRecord);
+    c89atomic_rcu_run_callbacks(pRecord, 0, 1);
+}
+/* END c89atomic_rcu.c */
+
+#endif /* c89atomic_rcu_c */
@@ -0,0 +1,133 @@
+/*
+Read-copy-update (RCU) with quiescent-state-based reclamation (QSBR). This is the same idea as the QSBR flavour of liburcu.
+
+This is for data that is read very often and replaced occasionally, such as a configuration or routing table. A writer never
+modifies the data in place. Instead it makes a copy, modifies the copy and then publishes it by swapping a pointer. The old copy
+can only be freed once every reader that might have loaded the old pointer has moved on.
+
+Readers don't do anything to mark the start and end of a read. Instead, each reader thread periodically announces a quiescent
+state, which is a point where it's not holding on to any pointers it got from c89atomic_rcu_dereference(). This is usually done
+once per iteration of a thread's main loop. Announcing a quiescent state is a load and a store so the read side has no
+read-modify-write operations or fences. Once every reader has announced a quiescent state after the pointer was swapped, the old
+copy can be freed. The cost is that a reader that never announces a quiescent state will stop anything from being freed, and
+reader threads need to be taken offline when they block for a long time.
+
+Everything lives in a domain, and each thread that reads needs to acquire a record from the domain. You need to supply the memory
+for the records. Acquiring a record puts the thread online:
+
+    c89atomic_rcu_record records[16];
+    c89atomic_rcu_domain domain;
+    c89atomic_rcu_domain_init(records, 16, &domain);
+
+    c89atomic_rcu_record* pRecord;
+    c89atomic_rcu_domain_acquire_record(&domain, &pRecord);
+
+A reader looks like this:
+
+    for (;;) {
+        my_config* pConfig = (my_config*)c89atomic_rcu_dereference((volatile void**)&g_pConfig);
+        ... use pConfig ...
+
+        // Don't touch pConfig after this point.
+        c89atomic_rcu_quiescent_state(&domain, pRecord);
+    }
+
+If a reader is going to block, such as when waiting on I/O, it should go offline first with c89atomic_rcu_thread_offline() and come
+back with c89atomic_rcu_thread_online(). An offline thread can't read anything, but it won't hold up writers either.
+
+A writer publishes a new copy with c89atomic_rcu_assign_ptr(). It can then either wait for the readers to move on with
+c89atomic_rcu_synchronize() and free the old copy itself, or it can have it freed later with c89atomic_rcu_call():
+
+    my_config* pOld = (my_config*)c89atomic_exchange_explicit_ptr((volatile void**)&g_pConfig, pNew, c89atomic_memory_order_acq_rel);
+    c89atomic_rcu_synchronize(&domain, pRecord);
+    free(pOld);
+
+Objects passed to c89atomic_rcu_call() need to have a c89atomic_rcu_head somewhere inside them. The callback is given a pointer
+to it. Pending callbacks are run whenever the same record calls c89atomic_rcu_call() or c89atomic_rcu_poll() and enough readers
+have moved on. c89atomic_rcu_barrier() waits for all of the record's pending callbacks to run.
+
+The writer's record is optional and can be NULL if the writer isn't also a reader. If it's not NULL, the calling thread is
+treated as being in a quiescent state. Never call c89atomic_rcu_synchronize() or c89atomic_rcu_barrier() from a thread that is
+holding on to a pointer from c89atomic_rcu_dereference().
+
+When a thread is finished with the domain it releases the record, which also takes it offline. Any pending callbacks stay with the
+record and are taken over by the next thread to acquire it. c89atomic_rcu_domain_uninit() runs every pending callback, and must
+only be called once no other thread is using the domain.
+
+This does not do input parameter validation for null pointers except in c89atomic_rcu_domain_init().
+*/
+#ifndef c89atomic_rcu_h
+#define c89atomic_rcu_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_RCU_API
+#define C89ATOMIC_RCU_API
+#endif
+
+typedef enum
+{
+    C89ATOMIC_RCU_SUCCESS = 0,
+    C89ATOMIC_RCU_INVALID_ARGS,
+    C89ATOMIC_RCU_OUT_OF_RECORDS    /* Can be returned when acquiring a record and every record is in use. */
+} c89atomic_rcu_result;
+
+
+/* BEG c89atomic_rcu.h */
+typedef struct c89atomic_rcu_head c89atomic_rcu_head;
+typedef void (* c89atomic_rcu_callback)(c89atomic_rcu_head* pHead);
+
+struct c89atomic_rcu_head
+{
+    c89atomic_rcu_head* pNext;
+    c89atomic_rcu_callback callback;
+    c89atomic_uint32 gracePeriod;   /* The callback can be run once every reader has seen this grace period. */
+};
+
+typedef struct c89atomic_rcu_record
+{
+    /* Read by writers. */
+    c89atomic_uint32 gracePeriod;   /* The last grace period seen by this thread, or 0 when offline. */
+    c89atomic_uint32 inUse;
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE];
+
+    /* Only ever accessed by the thread that owns the record. */
+    c89atomic_rcu_head* pPendingHead;
+    c89atomic_rcu_head* pPendingTail;
+    c89atomic_uint32 pendingCount;
+} c89atomic_rcu_record;
+
+typedef struct c89atomic_rcu_domain
+{
+    c89atomic_uint32 gracePeriod;   /* Always odd so that it's never confused with an offline thread. */
+    c89atomic_uint8 pad[C89ATOMIC_CACHE_LINE_SIZE];
+    c89atomic_rcu_record* pRecords;
+    c89atomic_uint32 recordCount;
+} c89atomic_rcu_domain;
+
+static C89ATOMIC_INLINE void c89atomic_rcu_assign_ptr(volatile void** ppDst, void* pSrc)
+{
+    /* Release so that the contents of the new object are visible to anybody who sees the pointer. */
+    c89atomic_store_explicit_ptr(ppDst, pSrc, c89atomic_memory_order_release);
+}
+
+static C89ATOMIC_INLINE void* c89atomic_rcu_dereference(volatile void** ppSrc)
+{
+    return c89atomic_load_explicit_ptr(ppSrc, c89atomic_memory_order_consume);
+}
+
+C89ATOMIC_RCU_API c89atomic_rcu_result c89atomic_rcu_domain_init(c89atomic_rcu_record* pRecords, c89atomic_uint32 recordCount, c89atomic_rcu_domain* pDomain);
+C89ATOMIC_RCU_API void c89atomic_rcu_domain_uninit(c89atomic_rcu_domain* pDomain);
+C89ATOMIC_RCU_API c89atomic_rcu_result c89atomic_rcu_domain_acquire_record(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record** ppRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_domain_release_record(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_quiescent_state(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_thread_online(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_thread_offline(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_synchronize(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+C89ATOMIC_RCU_API void c89atomic_rcu_call(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord, c89atomic_rcu_head* pHead, c89atomic_rcu_callback callback);
+C89ATOMIC_RCU_API c89atomic_uint32 c89atomic_rcu_poll(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);     /* Runs the callbacks that are ready. Returns the number that are still waiting. */
+C89ATOMIC_RCU_API void c89atomic_rcu_barrier(c89atomic_rcu_domain* pDomain, c89atomic_rcu_record* pRecord);
+/* END c89atomic_rcu.h */
+
+#endif /* c89atomic_rcu_h */
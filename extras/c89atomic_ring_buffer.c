@@ -25,6 +25,7 @@ C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_init(c89atomic_uint32 capac
 
     c89atomic_store_explicit_32(&pRingBuffer->head, 0, c89atomic_memory_order_relaxed);
     c89atomic_store_explicit_32(&pRingBuffer->tail, 0, c89atomic_memory_order_relaxed);
+    c89atomic_store_explicit_32(&pRingBuffer->reserve, 0, c89atomic_memory_order_relaxed);
     pRingBuffer->capacity = 0;
     pRingBuffer->stride   = 0;
     pRingBuffer->flags    = 0;
@@ -97,6 +98,29 @@ static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_ring_buffer_calculate_remaini
     return capacity - c89atomic_ring_buffer_calculate_length(head, tail, capacity);
 }
 
+/*
+In multi-producer mode the reserve cursor is a count of every element that's ever been reserved rather than an index
+with a loop flag. The loop flag repeats every `capacity * 2` elements, so a producer that stalls between loading the
+cursor and doing its compare-exchange could succeed after the other producers had gone right around the buffer and
+landed back on the same value. The count instead wraps at the largest multiple of `capacity * 2` that fits in 32 bits
+so that it can always be converted back to a cursor the head and tail can be compared against.
+*/
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_ring_buffer_reserve_wrap(c89atomic_uint32 capacity)
+{
+    return (0xFFFFFFFF / (capacity * 2)) * (capacity * 2);
+}
+
+static C89ATOMIC_INLINE c89atomic_uint32 c89atomic_ring_buffer_reserve_to_cursor(c89atomic_uint32 reserve, c89atomic_uint32 capacity)
+{
+    reserve = reserve % (capacity * 2);
+
+    if (reserve >= capacity) {
+        return (reserve - capacity) | 0x80000000;
+    } else {
+        return reserve;
+    }
+}
+
 C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_produce(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer)
 {
     c89atomic_uint32 head;
@@ -180,6 +204,105 @@ C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_unmap_produce(c89atomic_rin
     c89atomic_store_explicit_32(&pRingBuffer->head, head, c89atomic_memory_order_release);
 }
 
+C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_produce_mp(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer)
+{
+    c89atomic_uint32 reserve;
+    c89atomic_uint32 reserveWrap;
+    c89atomic_uint32 newReserve;
+    c89atomic_uint32 cursor;
+    c89atomic_uint32 tail;
+    c89atomic_uint32 remaining;
+
+    if (ppMappedBuffer == NULL) {
+        return 0;
+    }
+
+    *ppMappedBuffer = NULL;
+
+    if (pRingBuffer == NULL) {
+        return 0;
+    }
+
+    reserveWrap = c89atomic_ring_buffer_reserve_wrap(pRingBuffer->capacity);
+    reserve = c89atomic_load_explicit_32(&pRingBuffer->reserve, c89atomic_memory_order_relaxed);
+
+    for (;;) {
+        c89atomic_uint32 reserveCount;
+
+        /*
+        This is the same as the single producer case, except the reserve cursor is used instead of the head. Data
+        between the head and the reserve cursor has been mapped by other producers but not yet unmapped. The tail
+        is acquired for the same reason as in the single producer case. It needs to be loaded again each time the
+        compare-exchange fails because the consumer may have made more room in the meantime.
+        */
+        tail   = c89atomic_load_explicit_32(&pRingBuffer->tail, c89atomic_memory_order_acquire);
+        cursor = c89atomic_ring_buffer_reserve_to_cursor(reserve, pRingBuffer->capacity);
+
+        remaining = c89atomic_ring_buffer_calculate_remaining(cursor, tail, pRingBuffer->capacity);
+
+        reserveCount = count;
+        if (reserveCount > remaining) {
+            reserveCount = remaining;
+        }
+
+        if (reserveCount == 0) {
+            return 0;
+        }
+
+        /* Written this way so it can't overflow when the wrap point is close to 0xFFFFFFFF. */
+        if (reserveCount >= reserveWrap - reserve) {
+            newReserve = reserveCount - (reserveWrap - reserve);
+        } else {
+            newReserve = reserve + reserveCount;
+        }
+
+        /* Relaxed is fine here. The data is published by the store to the head when unmapping. */
+        if (c89atomic_compare_exchange_weak_explicit_32(&pRingBuffer->reserve, &reserve, newReserve, c89atomic_memory_order_relaxed, c89atomic_memory_order_relaxed)) {
+            *ppMappedBuffer = C89ATOMIC_RING_BUFFER_OFFSET_PTR(pRingBuffer->pBuffer, (cursor & 0x7FFFFFFF) * pRingBuffer->stride);
+            return reserveCount;
+        }
+    }
+}
+
+C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_unmap_produce_mp(c89atomic_ring_buffer* pRingBuffer, void* pMappedBuffer, c89atomic_uint32 count)
+{
+    c89atomic_uint32 index;
+    c89atomic_uint32 head;
+    c89atomic_backoff backoff;
+
+    if (pRingBuffer == NULL || pMappedBuffer == NULL || count == 0) {
+        return;
+    }
+
+    C89ATOMIC_RING_BUFFER_ASSERT(count <= pRingBuffer->capacity);
+
+    /* The position of our region, without the loop flag, is where the mapped pointer sits in the buffer. */
+    index = (c89atomic_uint32)(((char*)pMappedBuffer - (char*)pRingBuffer->pBuffer) / pRingBuffer->stride);
+    C89ATOMIC_RING_BUFFER_ASSERT(index < pRingBuffer->capacity);
+
+    /*
+    Regions need to be committed in the order they were mapped so we need to wait for the head to reach the
+    start of ours. We only need to compare the index. The head can't be sitting on the same index on an earlier
+    loop because there can never be more than `capacity` elements between the tail and the reserve cursor.
+
+    This needs to be acquire so that the copy below is ordered after the previous producer's copy when the
+    buffer is not mirrored.
+    */
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        head = c89atomic_load_explicit_32(&pRingBuffer->head, c89atomic_memory_order_acquire);
+        if ((head & 0x7FFFFFFF) == index) {
+            break;
+        }
+
+        c89atomic_backoff_snooze(&backoff);
+    }
+
+    /* We now own the head. From here on it's the same as the single producer case. */
+    c89atomic_ring_buffer_unmap_produce(pRingBuffer, count);
+}
+
 C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_consume(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer)
 {
     c89atomic_uint32 head;
@@ -9,21 +9,16 @@
 #endif
 
 #ifndef C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE
-    #if defined(__powerpc64__) || defined(__ppc64__) || defined(_ARCH_PPC64)
-    #define C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE   128
-    #elif defined(__APPLE__) && (defined(__aarch64__) || defined(__arm64__)) && defined(__ENVIRONMENT_MAC_OS_X_VERSION_MIN_REQUIRED)
-    #define C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE   128
-    #else
-    #define C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE   64
-    #endif
+#define C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE   C89ATOMIC_CACHE_LINE_SIZE
 #endif
 
 /*
 Ring Buffer
 ===========
 The ring buffer is single producer, single consumer and lock-free. It is thread-safe so long as the
-single producer, single consumer requirement is met. If you want multiple producers or consumers
-you need to use a different data structure or do your own mutual exclusion.
+single producer, single consumer requirement is met. There is also a multi-producer mode, which is
+explained further down. If you want multiple consumers you need to use a different data structure
+or do your own mutual exclusion.
 
 To initialize the ring buffer, use `c89atomic_ring_buffer_init()`. You need to supply the capacity
 of the buffer in elements, the size of an element in bytes (the `stride`) and a pointer to a buffer
@@ -105,6 +100,30 @@ by the time it returns. You should therefore be careful with how you use this fu
 multithreaded scenario. In addition, the result is not well defined if you call it from a thread
 other than the producer or consumer thread so therefore you should avoid calling this function from
 a third thread.
+
+Multiple Producers
+------------------
+If you have many threads producing data for a single consumer, use `c89atomic_ring_buffer_map_produce_mp()`
+and `c89atomic_ring_buffer_unmap_produce_mp()` instead of the single producer versions. The consumer
+side is unchanged:
+
+    void* pMappedBuffer;
+    c89atomic_uint32 mappedCount = c89atomic_ring_buffer_map_produce_mp(&rb, count, &pMappedBuffer);
+
+    // Copy your data.
+    memcpy(pMappedBuffer, pDataToWrite, mappedCount * sizeof(my_element));
+
+    // Unmap. You need to pass in the pointer that was returned when mapping.
+    c89atomic_ring_buffer_unmap_produce_mp(&rb, pMappedBuffer, mappedCount);
+
+Mapping reserves space in the buffer with a compare-exchange on a separate reserve cursor so that
+producers can write into their own regions at the same time. The data is committed in the order it
+was mapped. When unmapping, a producer will wait for every producer that mapped before it to unmap
+first. This means a producer should keep the time between mapping and unmapping short, and must
+not wait on the consumer or another producer while it has something mapped. Unlike the single
+producer version, you must unmap exactly the number of elements that were mapped.
+
+Don't mix the single and multi-producer functions on the same ring buffer.
 */
 
 /* BEG c89atomic_ring_buffer.h */
@@ -120,6 +139,10 @@ typedef struct c89atomic_ring_buffer
     #if C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE > 4
     c89atomic_uint8 pad1[C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE - 4];
     #endif
+    c89atomic_uint32 reserve;   /* Atomic. Only used in multi-producer mode. The number of elements that have been mapped, which tells the next producer where to map from. The head lags behind this until producers unmap. There is no loop flag. */
+    #if C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE > 4
+    c89atomic_uint8 pad2[C89ATOMIC_RING_BUFFER_CACHE_LINE_SIZE - 4];   /* Producers hammer the reserve cursor. Keep it away from the head so the consumer isn't slowed down by it. */
+    #endif
     c89atomic_uint32 capacity;  /* Capacity of the buffer, in elements. */
     c89atomic_uint32 stride;    /* Size of an element in bytes. */
     c89atomic_uint32 flags;
@@ -129,6 +152,8 @@ typedef struct c89atomic_ring_buffer
 C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_init(c89atomic_uint32 capacity, c89atomic_uint32 stride, c89atomic_uint32 flags, void* pBuffer, c89atomic_ring_buffer* pRingBuffer);   /* Buffer must be `2 * capacity * stride`. That is twice the capacity. You can use a mirrored buffer, in which case specify the C89ATOMIC_RING_BUFFER_FLAG_MIRRORED flag. */
 C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_produce(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer);    /* Returns the number of elements actually mapped. */
 C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_unmap_produce(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count);
+C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_produce_mp(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer); /* Multi-producer version of map_produce(). Returns the number of elements actually mapped. */
+C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_unmap_produce_mp(c89atomic_ring_buffer* pRingBuffer, void* pMappedBuffer, c89atomic_uint32 count);      /* `count` must be the number returned by map_produce_mp(). Waits for earlier producers to unmap. */
 C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_map_consume(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count, void** ppMappedBuffer);    /* Returns the number of elements actually mapped. */
 C89ATOMIC_RING_BUFFER_API void c89atomic_ring_buffer_unmap_consume(c89atomic_ring_buffer* pRingBuffer, c89atomic_uint32 count);
 C89ATOMIC_RING_BUFFER_API c89atomic_uint32 c89atomic_ring_buffer_length(const c89atomic_ring_buffer* pRingBuffer);      /* Returns the number of elements currently in the ring buffer. Should only be called from the producer or consumer thread. If something is in the middle of producing or consuming data on the ring buffer than the returned value may already be out of date. */
@@ -0,0 +1,389 @@
+#ifndef c89atomic_skiplist_c
+#define c89atomic_skiplist_c
+
+#include "c89atomic_skiplist.h"
+
+/* The low bit of a next pointer is set when the node it belongs to has been removed. */
+#define C89ATOMIC_SKIPLIST_IS_MARKED(pNode)     (((c89atomic_uintptr)(pNode) & 1) != 0)
+#define C89ATOMIC_SKIPLIST_MARK(pNode)          ((c89atomic_skiplist_node*)((c89atomic_uintptr)(pNode) | 1))
+#define C89ATOMIC_SKIPLIST_UNMARK(pNode)        ((c89atomic_skiplist_node*)((c89atomic_uintptr)(pNode) & ~(c89atomic_uintptr)1))
+
+static C89ATOMIC_INLINE c89atomic_skiplist_node* c89atomic_skiplist_load_next(c89atomic_skiplist_node* pNode, c89atomic_uint32 level)
+{
+    return (c89atomic_skiplist_node*)c89atomic_load_explicit_ptr((volatile void**)&pNode->pNext[level], c89atomic_memory_order_acquire);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_skiplist_compare_exchange_next(c89atomic_skiplist_node* pNode, c89atomic_uint32 level, c89atomic_skiplist_node** ppExpected, c89atomic_skiplist_node* pDesired)
+{
+    return c89atomic_compare_exchange_strong_explicit_ptr((volatile void**)&pNode->pNext[level], (void**)ppExpected, pDesired, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire);
+}
+
+static c89atomic_uint32 c89atomic_skiplist_pick_height(c89atomic_uint64 key, c89atomic_skiplist_node* pNode)
+{
+    /*
+    This is the finalizer from SplitMix64. The address is mixed in so that a key that's removed and
+    inserted again doesn't always get the same height. Every 2 bits gives a 1 in 4 chance of going up
+    a level.
+    */
+    c89atomic_uint64 hash = key ^ (c89atomic_uint64)(c89atomic_uintptr)pNode;
+    c89atomic_uint32 height = 1;
+
+    hash ^= hash >> 30;
+    hash *= ((c89atomic_uint64)0xBF58476D << 32) | 0x1CE4E5B9;
+    hash ^= hash >> 27;
+    hash *= ((c89atomic_uint64)0x94D049BB << 32) | 0x133111EB;
+    hash ^= hash >> 31;
+
+    while (height < C89ATOMIC_SKIPLIST_MAX_HEIGHT && (hash & 3) == 0) {
+        height += 1;
+        hash  >>= 2;
+    }
+
+    return height;
+}
+
+/*
+Fills out the nodes either side of the key on every level and returns whether or not the key is in the
+list. Any removed nodes that are found along the way are unlinked. If one of those fails because the
+node before it has been removed as well, it starts again from the top.
+*/
+static c89atomic_bool c89atomic_skiplist_search(c89atomic_skiplist* pList, c89atomic_uint64 key, c89atomic_skiplist_node** ppPreds, c89atomic_skiplist_node** ppSuccs)
+{
+    for (;;) {
+        c89atomic_skiplist_node* pPred = &pList->head;
+        c89atomic_skiplist_node* pCurr = NULL;
+        c89atomic_uint32 level = C89ATOMIC_SKIPLIST_MAX_HEIGHT;
+        c89atomic_bool restart = 0;
+
+        while (level > 0 && !restart) {
+            level -= 1;
+
+            pCurr = C89ATOMIC_SKIPLIST_UNMARK(c89atomic_skiplist_load_next(pPred, level));
+
+            while (pCurr != NULL) {
+                c89atomic_skiplist_node* pSucc = c89atomic_skiplist_load_next(pCurr, level);
+
+                if (C89ATOMIC_SKIPLIST_IS_MARKED(pSucc)) {
+                    c89atomic_skiplist_node* pExpected = pCurr;
+
+                    if (!c89atomic_skiplist_compare_exchange_next(pPred, level, &pExpected, C89ATOMIC_SKIPLIST_UNMARK(pSucc))) {
+                        restart = 1;
+                        break;
+                    }
+
+                    pCurr = C89ATOMIC_SKIPLIST_UNMARK(pSucc);
+                    continue;
+                }
+
+                if (pCurr->key >= key) {
+                    break;
+                }
+
+                pPred = pCurr;
+                pCurr = pSucc;
+            }
+
+            ppPreds[level] = pPred;
+            ppSuccs[level] = pCurr;
+        }
+
+        if (!restart) {
+            return pCurr != NULL && pCurr->key == key;
+        }
+    }
+}
+
+/*
+Unlinks a removed node from every level. This can't just search for the node's key and rely on that to
+unlink it on the way, because an insert of the same key can link its new node in front of the removed
+one on an upper level. The search stops at the new node and would never get to the removed one. This
+keeps going past nodes with the same key instead, so everything that's been removed with that key is
+unlinked, including this one.
+
+The node to start from on the next level down is kept separately so that it's always before every node
+with the key. Nodes with the same key can be in a different order on different levels.
+*/
+static void c89atomic_skiplist_unlink(c89atomic_skiplist* pList, c89atomic_skiplist_node* pNode)
+{
+    c89atomic_uint64 key = pNode->key;
+
+    for (;;) {
+        c89atomic_skiplist_node* pStart = &pList->head;     /* The last node before the key. */
+        c89atomic_uint32 level = C89ATOMIC_SKIPLIST_MAX_HEIGHT;
+        c89atomic_bool restart = 0;
+
+        while (level > 0 && !restart) {
+            c89atomic_skiplist_node* pPred;
+            c89atomic_skiplist_node* pCurr;
+
+            level -= 1;
+
+            pPred = pStart;
+            pCurr = C89ATOMIC_SKIPLIST_UNMARK(c89atomic_skiplist_load_next(pPred, level));
+
+            while (pCurr != NULL) {
+                c89atomic_skiplist_node* pSucc = c89atomic_skiplist_load_next(pCurr, level);
+
+                if (C89ATOMIC_SKIPLIST_IS_MARKED(pSucc)) {
+                    c89atomic_skiplist_node* pExpected = pCurr;
+
+                    if (!c89atomic_skiplist_compare_exchange_next(pPred, level, &pExpected, C89ATOMIC_SKIPLIST_UNMARK(pSucc))) {
+                        restart = 1;
+                        break;
+                    }
+
+                    pCurr = C89ATOMIC_SKIPLIST_UNMARK(pSucc);
+                    continue;
+                }
+
+                if (pCurr->key > key) {
+                    break;
+                }
+
+                if (pCurr->key < key) {
+                    pStart = pCurr;
+                }
+
+                pPred = pCurr;
+                pCurr = pSucc;
+            }
+        }
+
+        if (!restart) {
+            return;
+        }
+    }
+}
+
+/* Same as c89atomic_skiplist_search(), except removed nodes are skipped rather than unlinked so nothing is written. */
+static c89atomic_skiplist_node* c89atomic_skiplist_find_lower_bound(c89atomic_skiplist* pList, c89atomic_uint64 key)
+{
+    c89atomic_skiplist_node* pPred = &pList->head;
+    c89atomic_skiplist_node* pCurr = NULL;
+    c89atomic_uint32 level = C89ATOMIC_SKIPLIST_MAX_HEIGHT;
+
+    while (level > 0) {
+        level -= 1;
+
+        pCurr = C89ATOMIC_SKIPLIST_UNMARK(c89atomic_skiplist_load_next(pPred, level));
+
+        while (pCurr != NULL) {
+            c89atomic_skiplist_node* pSucc = c89atomic_skiplist_load_next(pCurr, level);
+
+            if (C89ATOMIC_SKIPLIST_IS_MARKED(pSucc)) {
+                pCurr = C89ATOMIC_SKIPLIST_UNMARK(pSucc);
+                continue;
+            }
+
+            if (pCurr->key >= key) {
+                break;
+            }
+
+            pPred = pCurr;
+            pCurr = pSucc;
+        }
+    }
+
+    return pCurr;
+}
+
+static void c89atomic_skiplist_release_node(c89atomic_skiplist* pList, c89atomic_skiplist_node* pNode)
+{
+    if (c89atomic_fetch_sub_explicit_32(&pNode->refs, 1, c89atomic_memory_order_acq_rel) == 1) {
+        if (pList->onRetire != NULL) {
+            pList->onRetire(pList->pUserData, pNode);
+        }
+    }
+}
+
+
+/* BEG c89atomic_skiplist.c */
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_init(c89atomic_skiplist_retire_proc onRetire, void* pUserData, c89atomic_skiplist* pList)
+{
+    c89atomic_uint32 level;
+
+    if (pList == NULL) {
+        return C89ATOMIC_SKIPLIST_INVALID_ARGS;
+    }
+
+    pList->head.key    = 0;
+    pList->head.height = C89ATOMIC_SKIPLIST_MAX_HEIGHT;
+    pList->head.refs   = 1;
+
+    for (level = 0; level < C89ATOMIC_SKIPLIST_MAX_HEIGHT; level += 1) {
+        pList->head.pNext[level] = NULL;
+    }
+
+    pList->onRetire  = onRetire;
+    pList->pUserData = pUserData;
+
+    return C89ATOMIC_SKIPLIST_SUCCESS;
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_insert(c89atomic_skiplist* pList, c89atomic_uint64 key, c89atomic_skiplist_node* pNode)
+{
+    c89atomic_skiplist_node* pPreds[C89ATOMIC_SKIPLIST_MAX_HEIGHT];
+    c89atomic_skiplist_node* pSuccs[C89ATOMIC_SKIPLIST_MAX_HEIGHT];
+    c89atomic_uint32 height = c89atomic_skiplist_pick_height(key, pNode);
+    c89atomic_uint32 level;
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    /* Linking into the bottom level is what puts the node in the list. */
+    for (;;) {
+        c89atomic_skiplist_node* pExpected;
+
+        if (c89atomic_skiplist_search(pList, key, pPreds, pSuccs)) {
+            return C89ATOMIC_SKIPLIST_ALREADY_EXISTS;
+        }
+
+        /* Nobody else can see the node yet so these don't need to be atomic. The release below publishes them. */
+        pNode->key    = key;
+        pNode->height = height;
+        pNode->refs   = 2;
+
+        for (level = 0; level < height; level += 1) {
+            pNode->pNext[level] = pSuccs[level];
+        }
+
+        pExpected = pSuccs[0];
+        if (c89atomic_skiplist_compare_exchange_next(pPreds[0], 0, &pExpected, pNode)) {
+            break;
+        }
+
+        c89atomic_backoff_spin(&backoff);
+    }
+
+    /*
+    Now the rest of the levels. Another thread can remove the node while we're doing this. When that
+    happens the next pointers we haven't got to yet will be marked and we stop.
+    */
+    for (level = 1; level < height; level += 1) {
+        c89atomic_bool stop = 0;
+
+        for (;;) {
+            c89atomic_skiplist_node* pSucc = pSuccs[level];
+            c89atomic_skiplist_node* pNext = c89atomic_skiplist_load_next(pNode, level);
+            c89atomic_skiplist_node* pExpected;
+
+            /* We're the only one that sets an unmarked next pointer, so if this fails it's because it's been marked. */
+            if (C89ATOMIC_SKIPLIST_IS_MARKED(pNext) || (pNext != pSucc && !c89atomic_skiplist_compare_exchange_next(pNode, level, &pNext, pSucc))) {
+                stop = 1;
+                break;
+            }
+
+            pExpected = pSucc;
+            if (c89atomic_skiplist_compare_exchange_next(pPreds[level], level, &pExpected, pNode)) {
+                break;
+            }
+
+            /* Something changed around us. If the search doesn't find our node it's been removed. */
+            if (!c89atomic_skiplist_search(pList, key, pPreds, pSuccs) || pSuccs[0] != pNode) {
+                stop = 1;
+                break;
+            }
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+
+    /*
+    If the node was removed while we were linking it in, we might have linked a level after the thread
+    that removed it went through to unlink it. Going through again will unlink it from anything we missed.
+    */
+    if (C89ATOMIC_SKIPLIST_IS_MARKED(c89atomic_skiplist_load_next(pNode, 0))) {
+        c89atomic_skiplist_unlink(pList, pNode);
+    }
+
+    c89atomic_skiplist_release_node(pList, pNode);
+
+    return C89ATOMIC_SKIPLIST_SUCCESS;
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_remove(c89atomic_skiplist* pList, c89atomic_uint64 key)
+{
+    c89atomic_skiplist_node* pPreds[C89ATOMIC_SKIPLIST_MAX_HEIGHT];
+    c89atomic_skiplist_node* pSuccs[C89ATOMIC_SKIPLIST_MAX_HEIGHT];
+    c89atomic_skiplist_node* pNode;
+    c89atomic_skiplist_node* pNext;
+    c89atomic_uint32 level;
+
+    if (!c89atomic_skiplist_search(pList, key, pPreds, pSuccs)) {
+        return C89ATOMIC_SKIPLIST_NOT_FOUND;
+    }
+
+    pNode = pSuccs[0];
+
+    /* Mark the upper levels first. It doesn't matter who marks these. */
+    for (level = pNode->height - 1; level > 0; level -= 1) {
+        pNext = c89atomic_skiplist_load_next(pNode, level);
+
+        while (!C89ATOMIC_SKIPLIST_IS_MARKED(pNext)) {
+            c89atomic_skiplist_compare_exchange_next(pNode, level, &pNext, C89ATOMIC_SKIPLIST_MARK(pNext));
+        }
+    }
+
+    /* Whoever marks the bottom level is the one that removed it. */
+    pNext = c89atomic_skiplist_load_next(pNode, 0);
+    for (;;) {
+        if (C89ATOMIC_SKIPLIST_IS_MARKED(pNext)) {
+            return C89ATOMIC_SKIPLIST_NOT_FOUND;    /* Someone else got there first. */
+        }
+
+        if (c89atomic_skiplist_compare_exchange_next(pNode, 0, &pNext, C89ATOMIC_SKIPLIST_MARK(pNext))) {
+            break;
+        }
+    }
+
+    c89atomic_skiplist_unlink(pList, pNode);
+
+    c89atomic_skiplist_release_node(pList, pNode);
+
+    return C89ATOMIC_SKIPLIST_SUCCESS;
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_find(c89atomic_skiplist* pList, c89atomic_uint64 key)
+{
+    c89atomic_skiplist_node* pNode = c89atomic_skiplist_find_lower_bound(pList, key);
+
+    if (pNode == NULL || pNode->key != key) {
+        return NULL;
+    }
+
+    return pNode;
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_lower_bound(c89atomic_skiplist* pList, c89atomic_uint64 key)
+{
+    return c89atomic_skiplist_find_lower_bound(pList, key);
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_first(c89atomic_skiplist* pList)
+{
+    return c89atomic_skiplist_next(pList, &pList->head);
+}
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_next(c89atomic_skiplist* pList, c89atomic_skiplist_node* pNode)
+{
+    c89atomic_skiplist_node* pCurr = C89ATOMIC_SKIPLIST_UNMARK(c89atomic_skiplist_load_next(pNode, 0));
+
+    (void)pList;
+
+    /* Removed nodes are still linked until someone gets around to unlinking them so they need to be skipped. */
+    while (pCurr != NULL) {
+        c89atomic_skiplist_node* pSucc = c89atomic_skiplist_load_next(pCurr, 0);
+        if (!C89ATOMIC_SKIPLIST_IS_MARKED(pSucc)) {
+            break;
+        }
+
+        pCurr = C89ATOMIC_SKIPLIST_UNMARK(pSucc);
+    }
+
+    return pCurr;
+}
+/* END c89atomic_skiplist.c */
+
+#endif /* c89atomic_skiplist_c */
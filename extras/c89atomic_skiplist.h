@@ -0,0 +1,111 @@
+/*
+A lock-free skip list, used as an ordered map with 64-bit keys. This implements the lock-free skip list from "Fraser, Practical
+Lock-Freedom (University of Cambridge, 2004)", in the form given in "Herlihy and Shavit, The Art of Multiprocessor Programming".
+
+This is for when you need things kept in order and lots of threads need to get at them at the same time, such as timer deadlines or
+price levels in an order book. Any number of threads can insert, remove, find and iterate at the same time. Finding and iterating
+never write to the list.
+
+Objects that go into the list need to have a c89atomic_skiplist_node somewhere inside them. The list doesn't allocate or free
+anything. Each key can only be in the list once. Lookups return a pointer to the node and it's up to you to get back to your object:
+
+    typedef struct
+    {
+        c89atomic_skiplist_node node;
+        my_timer_callback callback;
+        ...
+    } my_timer;
+
+    c89atomic_skiplist_insert(&timers, deadline, &pTimer->node);
+    ...
+    my_timer* pTimer = (my_timer*)c89atomic_skiplist_find(&timers, deadline);  // Can do a cast like this because the node is the first member.
+
+Iterating over a range looks like this. Nodes that are removed while you're iterating are skipped, and nodes that are inserted
+might or might not be seen:
+
+    c89atomic_skiplist_node* pNode;
+    for (pNode = c89atomic_skiplist_lower_bound(&list, lo); pNode != NULL && pNode->key < hi; pNode = c89atomic_skiplist_next(&list, pNode)) {
+        ...
+    }
+
+A node is removed by first marking it, which is done by setting the low bit of each of its next pointers, starting from the top.
+Once the bottom level has been marked the node is no longer in the list as far as everybody else is concerned. After that it's
+unlinked from each level, either by the thread that removed it or by any other thread that comes across it. Nodes therefore need to
+be at least 2-byte aligned.
+
+Other threads might still be looking at a node after it's been removed, so you can't free or reuse a node straight away. Instead,
+when a node has been unlinked from every level the list calls the retire callback that was passed in to c89atomic_skiplist_init().
+This is where you hand it over to your reclamation scheme. Epoch-based reclamation (c89atomic_epoch.h) or RCU (c89atomic_rcu.h) are
+the best fit because a skip list visits lots of nodes in a single operation. Every call into the list needs to be inside a critical
+section, and so does anything you do with the nodes it returns:
+
+    static void my_retire(void* pUserData, c89atomic_skiplist_node* pNode)
+    {
+        my_timer* pTimer = (my_timer*)pNode;
+        c89atomic_epoch_retire(&domain, my_get_epoch_record(), &pTimer->epochNode);
+    }
+
+The retire callback is called exactly once for each removed node, from whichever thread was last to touch it. That's usually the
+thread that removed it, but it might be a thread that's in the middle of inserting it. If the retire callback is NULL, nothing is
+done and you can't free or reuse any removed node until nobody is using the list.
+
+The height of each node is picked from a hash of its key and address. The maximum height is C89ATOMIC_SKIPLIST_MAX_HEIGHT which
+determines how big each node is. Each level has a quarter of the nodes of the level below it, so the default of 16 is enough for
+billions of nodes.
+
+Initialize the list with c89atomic_skiplist_init(). The head of the list is a node that lives inside the list itself, so the list
+can't be copied or moved while it's in use.
+
+This will not validate function parameters for null pointers except in c89atomic_skiplist_init().
+*/
+#ifndef c89atomic_skiplist_h
+#define c89atomic_skiplist_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_SKIPLIST_API
+#define C89ATOMIC_SKIPLIST_API
+#endif
+
+/* The maximum number of levels a node can be linked into. Each node has a next pointer for each one. */
+#ifndef C89ATOMIC_SKIPLIST_MAX_HEIGHT
+#define C89ATOMIC_SKIPLIST_MAX_HEIGHT   16
+#endif
+
+typedef enum
+{
+    C89ATOMIC_SKIPLIST_SUCCESS = 0,
+    C89ATOMIC_SKIPLIST_INVALID_ARGS,
+    C89ATOMIC_SKIPLIST_ALREADY_EXISTS,  /* Can be returned when inserting and the key is already in the list. */
+    C89ATOMIC_SKIPLIST_NOT_FOUND        /* Can be returned when removing. */
+} c89atomic_skiplist_result;
+
+/* BEG c89atomic_skiplist.h */
+typedef struct c89atomic_skiplist_node
+{
+    c89atomic_uint64 key;
+    c89atomic_uint32 height;
+    c89atomic_uint32 refs;      /* Atomic. One for the list and one for the inserting thread. The node is retired when both are gone. */
+    struct c89atomic_skiplist_node* pNext[C89ATOMIC_SKIPLIST_MAX_HEIGHT];     /* Atomic. The low bit is set once the node has been removed. */
+} c89atomic_skiplist_node;
+
+typedef void (* c89atomic_skiplist_retire_proc)(void* pUserData, c89atomic_skiplist_node* pNode);
+
+typedef struct c89atomic_skiplist
+{
+    c89atomic_skiplist_node head;   /* Only the next pointers are used. */
+    c89atomic_skiplist_retire_proc onRetire;
+    void* pUserData;
+} c89atomic_skiplist;
+
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_init(c89atomic_skiplist_retire_proc onRetire, void* pUserData, c89atomic_skiplist* pList);
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_insert(c89atomic_skiplist* pList, c89atomic_uint64 key, c89atomic_skiplist_node* pNode);   /* Sets the key of the node. Returns C89ATOMIC_SKIPLIST_ALREADY_EXISTS if the key is already in the list, in which case the node can be reused straight away. */
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_result c89atomic_skiplist_remove(c89atomic_skiplist* pList, c89atomic_uint64 key);
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_find(c89atomic_skiplist* pList, c89atomic_uint64 key);          /* Returns NULL if the key is not in the list. */
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_lower_bound(c89atomic_skiplist* pList, c89atomic_uint64 key);   /* Returns the first node with a key greater than or equal to the given key, or NULL if there isn't one. */
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_first(c89atomic_skiplist* pList);                               /* Returns NULL if the list is empty. */
+C89ATOMIC_SKIPLIST_API c89atomic_skiplist_node* c89atomic_skiplist_next(c89atomic_skiplist* pList, c89atomic_skiplist_node* pNode); /* Returns NULL at the end of the list. The node can be one that has since been removed. */
+/* END c89atomic_skiplist.h */
+
+#endif  /* c89atomic_skiplist_h */
@@ -0,0 +1,143 @@
+#ifndef c89atomic_stack_c
+#define c89atomic_stack_c
+
+#include "c89atomic_stack.h"
+
+/*
+These hide the difference between the 64-bit build, where the head is a tagged pointer, and the
+32-bit build, where the pointer and tag are packed into a 64-bit integer.
+*/
+#if defined(C89ATOMIC_64BIT)
+typedef c89atomic_tagged_ptr c89atomic_stack_head;
+
+static C89ATOMIC_INLINE c89atomic_stack_node* c89atomic_stack_head_get_node(c89atomic_stack_head head)
+{
+    return (c89atomic_stack_node*)c89atomic_tagged_ptr_get_ptr(head);
+}
+
+static C89ATOMIC_INLINE c89atomic_stack_head c89atomic_stack_head_load(c89atomic_stack* pStack, c89atomic_memory_order order)
+{
+    return c89atomic_tagged_ptr_load_explicit(&pStack->head, order);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_stack_head_compare_exchange(c89atomic_stack* pStack, c89atomic_stack_head* pExpected, c89atomic_stack_node* pNode, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    /* This increments the tag for us. */
+    return c89atomic_tagged_ptr_compare_exchange_weak_explicit(&pStack->head, pExpected, pNode, successOrder, failureOrder);
+}
+#else
+typedef c89atomic_uint64 c89atomic_stack_head;
+
+static C89ATOMIC_INLINE c89atomic_stack_node* c89atomic_stack_head_get_node(c89atomic_stack_head head)
+{
+    return (c89atomic_stack_node*)(c89atomic_uintptr)(head & 0xFFFFFFFF);
+}
+
+static C89ATOMIC_INLINE c89atomic_stack_head c89atomic_stack_head_load(c89atomic_stack* pStack, c89atomic_memory_order order)
+{
+    return c89atomic_load_explicit_64(&pStack->head, order);
+}
+
+static C89ATOMIC_INLINE c89atomic_bool c89atomic_stack_head_compare_exchange(c89atomic_stack* pStack, c89atomic_stack_head* pExpected, c89atomic_stack_node* pNode, c89atomic_memory_order successOrder, c89atomic_memory_order failureOrder)
+{
+    c89atomic_uint32 tag = (c89atomic_uint32)(*pExpected >> 32) + 1;
+    c89atomic_stack_head desired = ((c89atomic_uint64)tag << 32) | (c89atomic_uint32)(c89atomic_uintptr)pNode;
+
+    return c89atomic_compare_exchange_weak_explicit_64(&pStack->head, pExpected, desired, successOrder, failureOrder);
+}
+#endif
+
+
+/* BEG c89atomic_stack.c */
+C89ATOMIC_STACK_API void c89atomic_stack_init(c89atomic_stack* pStack)
+{
+    if (pStack == NULL) {
+        return;
+    }
+
+    pStack->head = 0;
+}
+
+C89ATOMIC_STACK_API void c89atomic_stack_push(c89atomic_stack* pStack, c89atomic_stack_node* pNode)
+{
+    c89atomic_stack_push_list(pStack, pNode, pNode);
+}
+
+C89ATOMIC_STACK_API void c89atomic_stack_push_list(c89atomic_stack* pStack, c89atomic_stack_node* pFirst, c89atomic_stack_node* pLast)
+{
+    c89atomic_stack_head head = c89atomic_stack_head_load(pStack, c89atomic_memory_order_relaxed);
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        /* This is racing with the load in c89atomic_stack_pop() when the node has just been popped by another thread. */
+        c89atomic_store_explicit_ptr((volatile void**)&pLast->pNext, c89atomic_stack_head_get_node(head), c89atomic_memory_order_relaxed);
+
+        /* Release so that whoever pops these nodes sees what was written to them, including pNext. */
+        if (c89atomic_stack_head_compare_exchange(pStack, &head, pFirst, c89atomic_memory_order_release, c89atomic_memory_order_relaxed)) {
+            break;
+        }
+
+        c89atomic_backoff_spin(&backoff);
+    }
+}
+
+C89ATOMIC_STACK_API c89atomic_stack_node* c89atomic_stack_pop(c89atomic_stack* pStack)
+{
+    c89atomic_stack_head head = c89atomic_stack_head_load(pStack, c89atomic_memory_order_acquire);
+    c89atomic_backoff backoff;
+
+    c89atomic_backoff_init(&backoff);
+
+    for (;;) {
+        c89atomic_stack_node* pNode = c89atomic_stack_head_get_node(head);
+        c89atomic_stack_node* pNext;
+
+        if (pNode == NULL) {
+            return NULL;
+        }
+
+        /*
+        Another thread might pop this node and change pNext before we get to the compare-exchange, in which
+        case we'll read a garbage pNext. That's fine because the tag will have changed and the compare-exchange
+        will fail. The load needs to be atomic though, because it's racing with that other thread.
+        */
+        pNext = (c89atomic_stack_node*)c89atomic_load_explicit_ptr((volatile void**)&pNode->pNext, c89atomic_memory_order_relaxed);
+
+        if (c89atomic_stack_head_compare_exchange(pStack, &head, pNext, c89atomic_memory_order_acquire, c89atomic_memory_order_acquire)) {
+            return pNode;
+        }
+
+        c89atomic_backoff_spin(&backoff);
+    }
+}
+
+C89ATOMIC_STACK_API c89atomic_stack_node* c89atomic_stack_pop_all(c89atomic_stack* pStack)
+{
+    c89atomic_stack_head head = c89atomic_stack_head_load(pStack, c89atomic_memory_order_acquire);
+
+    /*
+    This could be a single exchange, but that would reset the tag which would let a concurrent pop get
+    fooled by an old head. In practice this will almost always succeed first time.
+    */
+    for (;;) {
+        c89atomic_stack_node* pNode = c89atomic_stack_head_get_node(head);
+
+        if (pNode == NULL) {
+            return NULL;
+        }
+
+        if (c89atomic_stack_head_compare_exchange(pStack, &head, NULL, c89atomic_memory_order_acquire, c89atomic_memory_order_acquire)) {
+            return pNode;
+        }
+    }
+}
+
+C89ATOMIC_STACK_API c89atomic_bool c89atomic_stack_is_empty(c89atomic_stack* pStack)
+{
+    return c89atomic_stack_head_get_node(c89atomic_stack_head_load(pStack, c89atomic_memory_order_relaxed)) == NULL;
+}
+/* END c89atomic_stack.c */
+
+#endif /* c89atomic_stack_c */
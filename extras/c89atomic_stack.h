@@ -0,0 +1,68 @@
+/*
+An intrusive lock-free stack (LIFO). This implements "Treiber, Systems Programming: Coping with Parallelism (IBM RJ 5118, 1986)".
+
+This is most useful as a free list for recycling fixed size objects, such as buffers, between threads. Any number of threads can
+push and pop at the same time.
+
+Objects that go into the stack need to have a c89atomic_stack_node somewhere inside them. The stack doesn't allocate or free
+anything. c89atomic_stack_pop() returns a pointer to the node and it's up to you to get back to your object:
+
+    typedef struct
+    {
+        c89atomic_stack_node node;
+        char data[1024];
+    } my_buffer;
+
+    c89atomic_stack_push(&freeList, &pBuffer->node);
+    ...
+    my_buffer* pBuffer = (my_buffer*)c89atomic_stack_pop(&freeList);  // Can do a cast like this because the node is the first member.
+
+c89atomic_stack_pop_all() detaches every node at once and returns them as a list linked through `pNext`, with the most recently
+pushed node first. c89atomic_stack_push_list() does the reverse and pushes a whole list at once.
+
+To stop a pop from being fooled when a node is popped and pushed back by another thread while it's in the middle of popping (the ABA
+problem), the head of the stack contains a tag that is incremented on every change. On 64-bit builds this is a c89atomic_tagged_ptr,
+and on 32-bit builds the pointer and a 32-bit tag are packed into a 64-bit integer. On 32-bit builds the stack should be 8-byte
+aligned for best performance. On 64-bit architectures other than x86-64 and AArch64 the tag lives in the low bits of the pointer
+which means nodes need to be aligned to `1 << C89ATOMIC_TAGGED_PTR_LOW_BITS`.
+
+A pop will read the `pNext` member of a node that another thread might have just popped. This is fine when the stack is used as a
+free list because the memory is still valid, but it means you must not free the memory of a node while other threads might be
+popping from the same stack. If you need to do that, use hazard pointers (see c89atomic_hazard_pointers.h).
+
+Initialize the stack with c89atomic_stack_init(), or by zeroing it.
+*/
+#ifndef c89atomic_stack_h
+#define c89atomic_stack_h
+
+#include "../c89atomic.h"
+#include <stddef.h>
+
+#ifndef C89ATOMIC_STACK_API
+#define C89ATOMIC_STACK_API
+#endif
+
+/* BEG c89atomic_stack.h */
+typedef struct c89atomic_stack_node
+{
+    struct c89atomic_stack_node* pNext;
+} c89atomic_stack_node;
+
+typedef struct c89atomic_stack
+{
+    #if defined(C89ATOMIC_64BIT)
+    c89atomic_tagged_ptr head;
+    #else
+    c89atomic_uint64 head;      /* Low 32 bits are the pointer, high 32 bits are the tag. */
+    #endif
+} c89atomic_stack;
+
+C89ATOMIC_STACK_API void c89atomic_stack_init(c89atomic_stack* pStack);
+C89ATOMIC_STACK_API void c89atomic_stack_push(c89atomic_stack* pStack, c89atomic_stack_node* pNode);
+C89ATOMIC_STACK_API void c89atomic_stack_push_list(c89atomic_stack* pStack, c89atomic_stack_node* pFirst, c89atomic_stack_node* pLast);     /* pFirst to pLast must already be linked through pNext. pFirst will be the new top. */
+C89ATOMIC_STACK_API c89atomic_stack_node* c89atomic_stack_pop(c89atomic_stack* pStack);       /* Returns NULL if the stack is empty. */
+C89ATOMIC_STACK_API c89atomic_stack_node* c89atomic_stack_pop_all(c89atomic_stack* pStack);   /* Returns NULL if the stack is empty. */
+C89ATOMIC_STACK_API c89atomic_bool c89atomic_stack_is_empty(c89atomic_stack* pStack);
+/* END c89atomic_stack.h */
+
+#endif /* c89atomic_stack_h */
@@ -3,6 +3,16 @@ Tests basic logic of all atomic functions. Does not test atomicity.
 */
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+
+/* Threads in the tests often outnumber cores, so waiting threads need to actually give up their time slice. */
+#if defined(_WIN32)
+    #include <windows.h>
+    #define C89ATOMIC_YIELD()   Sleep(0)
+#else
+    #include <sched.h>
+    #define C89ATOMIC_YIELD()   sched_yield()
+#endif
 
 /*#define C89ATOMIC_MODERN_GCC*/
 /*#define C89ATOMIC_LEGACY_GCC*/
@@ -15,6 +25,15 @@ Tests basic logic of all atomic functions. Does not test atomicity.
 #include "../extras/c89atomic_deque.c"
 #include "../extras/c89atomic_bitmap_allocator.c"
 #include "../extras/c89atomic_ring_buffer.c"
+#include "../extras/c89atomic_hazard_pointers.c"
+#include "../extras/c89atomic_epoch.c"
+#include "../extras/c89atomic_rcu.c"
+#include "../extras/c89atomic_stack.c"
+#include "../extras/c89atomic_mpmc_queue.c"
+#include "../extras/c89atomic_ms_queue.c"
+#include "../extras/c89atomic_mpsc_queue.c"
+#include "../extras/c89atomic_hashmap.c"
+#include "../extras/c89atomic_skiplist.c"
 
 #include "../external/c89thread/c89thread.c"
 
@@ -656,6 +675,45 @@ static int c89atomic_ring_buffer_producer_thread(void* arg)
     return 0;
 }
 
+/* Data structure for the multi-producer ring buffer test. Each value is the producer index in the top 8 bits and a counter in the rest. */
+#define C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT   4
+
+typedef struct
+{
+    c89atomic_ring_buffer* pRingBuffer;
+    c89atomic_uint32 totalToProduce;    /* Per producer. */
+    c89atomic_uint32 nextProducer;
+} c89atomic_ring_buffer_mp_producer_data;
+
+static int c89atomic_ring_buffer_mp_producer_thread(void* arg)
+{
+    c89atomic_ring_buffer_mp_producer_data* pData = (c89atomic_ring_buffer_mp_producer_data*)arg;
+    c89atomic_uint32 producer = c89atomic_fetch_add_32(&pData->nextProducer, 1);
+    c89atomic_uint32 produced = 0;
+
+    while (produced < pData->totalToProduce) {
+        void* pMapped;
+        c89atomic_uint32 mapped;
+
+        /* Odd sizes so that regions straddle the loop point. */
+        mapped = c89atomic_ring_buffer_map_produce_mp(pData->pRingBuffer, 3, &pMapped);
+        if (mapped > 0 && pMapped != NULL) {
+            c89atomic_uint32 i;
+
+            for (i = 0; i < mapped; i += 1) {
+                ((c89atomic_uint32*)pMapped)[i] = (producer << 24) | produced;
+                produced += 1;
+            }
+
+            c89atomic_ring_buffer_unmap_produce_mp(pData->pRingBuffer, pMapped, mapped);
+        } else {
+            c89thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
 static void c89atomic_test__ring_buffer(void)
 {
     c89atomic_ring_buffer rb;
@@ -875,172 +933,3681 @@ static void c89atomic_test__ring_buffer(void)
         }
     }
 
-    printf("\n");
-}
+    /* Same again, but with multiple producers. Each producer's data needs to come out in the order it went in. */
+    printf("    %-*s", PRINT_WIDTH, "Thread safety (4 producers)");
+    {
+        c89thrd_t producerThreads[C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT];
+        c89atomic_uint32 expectedValues[C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT];
+        c89atomic_uint32 totalProduced = 50000;
+        c89atomic_uint32 consumed = 0;
+        int threadCount = 0;
+        int passed = 1;
+        int i;
+        c89atomic_ring_buffer_mp_producer_data producerData;
 
+        c89atomic_ring_buffer_init(capacity, stride, 0, buffer, &rb);
 
-int main(int argc, char** argv)
-{
-    enable_colored_output();
+        producerData.pRingBuffer = &rb;
+        producerData.totalToProduce = totalProduced;
+        producerData.nextProducer = 0;
 
-    /* The size of basic types must be valid. If not, the architecture/compiler/platform is not supported. */
-    c89atomic_test__basic__sizeof();
-    if (g_ErrorCount > 0) {
-        printf("Tests cannot continue because the size of one or more basic types are not valid.\n");
-        return 1;
-    }
+        for (i = 0; i < C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT; i += 1) {
+            expectedValues[i] = 0;
 
-    c89atomic_test__basic__flag_test_and_set();
-    c89atomic_test__basic__flag_clear();
-    c89atomic_test__basic__flag_load();
-    c89atomic_test__basic__load();
-    c89atomic_test__basic__store();
-    c89atomic_test__basic__exchange();
-    c89atomic_test__basic__compare_exchange_strong();
-    c89atomic_test__basic__compare_exchange_weak();
-    c89atomic_test__basic__fetch_add();
-    c89atomic_test__basic__fetch_sub();
-    c89atomic_test__basic__fetch_or();
-    c89atomic_test__basic__fetch_xor();
-    c89atomic_test__basic__fetch_and();
-    c89atomic_test__basic__compare_and_swap();
+            if (c89thrd_create(&producerThreads[threadCount], c89atomic_ring_buffer_mp_producer_thread, &producerData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
 
-    printf("c89atomic_is_lock_free_8  = %s\n", c89atomic_is_lock_free_8(NULL)  ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
-    printf("c89atomic_is_lock_free_16 = %s\n", c89atomic_is_lock_free_16(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
-    printf("c89atomic_is_lock_free_32 = %s\n", c89atomic_is_lock_free_32(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
-    printf("c89atomic_is_lock_free_64 = %s\n", c89atomic_is_lock_free_64(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
+        if (threadCount != C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT) {
+            passed = 0;
+        }
 
-    /* Putting these functions here for testing that they compile. */
-    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
-    c89atomic_signal_fence(c89atomic_memory_order_seq_cst);
+        /* Keep consuming after a failure. Otherwise the producers will never finish and we'll get stuck joining them. */
+        while (consumed < totalProduced * threadCount) {
+            mappedCount = c89atomic_ring_buffer_map_consume(&rb, 5, &pMappedBuffer);
+            if (mappedCount > 0 && pMappedBuffer != NULL) {
+                c89atomic_uint32 j;
 
-    /* Testing cases where the return value is not used. */
-    {
-        void* dst = NULL;
-        void* src = NULL;
-        c89atomic_exchange_ptr(&dst, src);
-        c89atomic_compare_exchange_strong_ptr(&dst, &dst, src);
+                for (j = 0; j < mappedCount; j += 1) {
+                    c89atomic_uint32 value = ((c89atomic_uint32*)pMappedBuffer)[j];
+                    c89atomic_uint32 producer = value >> 24;
+
+                    if (producer >= C89ATOMIC_RING_BUFFER_TEST_PRODUCER_COUNT || (value & 0xFFFFFF) != expectedValues[producer]) {
+                        passed = 0;
+                    } else {
+                        expectedValues[producer] += 1;
+                    }
+
+                    consumed += 1;
+                }
+
+                c89atomic_ring_buffer_unmap_consume(&rb, mappedCount);
+            } else {
+                c89thrd_yield();
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(producerThreads[i], NULL);
+        }
+
+        if (passed) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
     }
 
+    /*
+    The multi-producer reserve cursor is a count that wraps at a multiple of twice the capacity. A capacity of 6 doesn't
+    divide into 2^32 so start just before the wrap point and make sure mapping carries on from the right place.
+    */
+    printf("    %-*s", PRINT_WIDTH, "Multi-producer reserve wrap-around");
     {
-        c89atomic_uint64 dst = 0;
-        c89atomic_uint64 src = 1;
-        c89atomic_exchange_64(&dst, src);
+        c89atomic_uint32 reserveWrap = (0xFFFFFFFF / 12) * 12;
+        c89atomic_uint32 expectedValue = 0;
+        c89atomic_uint32 producedValue = 0;
+        int passed = 1;
+        int i;
+
+        c89atomic_ring_buffer_init(6, stride, 0, buffer, &rb);
+
+        /* reserveWrap - 4 is 4 short of a multiple of 12 which is index 2 on an odd loop. */
+        rb.reserve = reserveWrap - 4;
+        rb.head    = 0x80000002;
+        rb.tail    = 0x80000002;
+
+        for (i = 0; i < 10; i += 1) {
+            c89atomic_uint32 j;
+
+            mappedCount = c89atomic_ring_buffer_map_produce_mp(&rb, 5, &pMappedBuffer);
+            if (mappedCount != 5 || pMappedBuffer == NULL) {
+                passed = 0;
+                break;
+            }
+
+            for (j = 0; j < mappedCount; j += 1) {
+                ((c89atomic_uint32*)pMappedBuffer)[j] = producedValue;
+                producedValue += 1;
+            }
+
+            c89atomic_ring_buffer_unmap_produce_mp(&rb, pMappedBuffer, (c89atomic_uint32)mappedCount);
+
+            mappedCount = c89atomic_ring_buffer_map_consume(&rb, 5, &pMappedBuffer);
+            if (mappedCount != 5 || pMappedBuffer == NULL) {
+                passed = 0;
+                break;
+            }
+
+            for (j = 0; j < mappedCount; j += 1) {
+                if (((c89atomic_uint32*)pMappedBuffer)[j] != expectedValue) {
+                    passed = 0;
+                }
+
+                expectedValue += 1;
+            }
+
+            c89atomic_ring_buffer_unmap_consume(&rb, mappedCount);
+        }
+
+        /* 50 elements were reserved, 4 of which were before the wrap point. */
+        if (rb.reserve != 46) {
+            passed = 0;
+        }
+
+        if (passed) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
     }
 
-    /* Testing that some basic integer versions are working without compilation errors. */
-    {
-        int dst = 0;
-        int src = 1;
-        int res = c89atomic_exchange_i32(&dst, src);
-        (void)res;
+    printf("\n");
+}
+
+
+/* Data structure for the lock contention tests. Each test only uses one of the locks. */
+typedef struct
+{
+    c89atomic_spinlock lock;
+    c89atomic_ticket_lock ticketLock;
+    c89atomic_mcs_lock mcsLock;
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 counter;   /* Not atomic. Protected by the lock. */
+} c89atomic_spinlock_test_data;
+
+static int c89atomic_spinlock_test_thread(void* arg)
+{
+    c89atomic_spinlock_test_data* pData = (c89atomic_spinlock_test_data*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_spinlock_lock(&pData->lock);
+        {
+            pData->counter += 1;
+        }
+        c89atomic_spinlock_unlock(&pData->lock);
     }
 
-    /* Basic floating point tests. */
-    {
-        float dst = 1.0f;
-        float src = 2.0f;
-        float res = c89atomic_exchange_f32(&dst, src);
-        (void)res;
+    return 0;
+}
 
-        res = c89atomic_load_f32(&dst);
-        (void)res;
+static int c89atomic_ticket_lock_test_thread(void* arg)
+{
+    c89atomic_spinlock_test_data* pData = (c89atomic_spinlock_test_data*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_ticket_lock_lock(&pData->ticketLock);
+        {
+            pData->counter += 1;
+        }
+        c89atomic_ticket_lock_unlock(&pData->ticketLock);
     }
 
-    {
-        double dst = 1.0f;
-        double src = 2.0f;
-        double res = c89atomic_exchange_f64(&dst, src);
-        (void)res;
+    return 0;
+}
 
-        res = c89atomic_load_f64(&dst);
-        (void)res;
+static int c89atomic_mcs_lock_test_thread(void* arg)
+{
+    c89atomic_spinlock_test_data* pData = (c89atomic_spinlock_test_data*)arg;
+    c89atomic_mcs_node node;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        /* Alternate with trylock to make sure both paths interact correctly. */
+        if ((i & 1) == 0 || !c89atomic_mcs_lock_trylock(&pData->mcsLock, &node)) {
+            c89atomic_mcs_lock_lock(&pData->mcsLock, &node);
+        }
+        {
+            pData->counter += 1;
+        }
+        c89atomic_mcs_lock_unlock(&pData->mcsLock, &node);
     }
 
+    return 0;
+}
 
-    /* Basic deque tests. Not currently testing for multi-threaded correctness. */
-    {
-        c89atomic_deque_result result;
-        c89atomic_deque deque;
-        void* pValue = (void*)123456;
+static c89atomic_bool c89atomic_test__lock_contention(c89thrd_start_t threadProc)
+{
+    c89thrd_t threads[4];
+    c89atomic_spinlock_test_data data;
+    int threadCount = 0;
+    int i;
 
-        c89atomic_deque_init(&deque);
+    memset(&data, 0, sizeof(data));
+    data.iterations = 100000;
 
-        /* First thing to test is to take from the tail while the deque is empty. Want to test for wrap around bugs due to 1 being subtracted from 0. */
-        printf("\n");
-        printf("Deque Take Tail (Empty): ");
-        result = c89atomic_deque_take_tail(&deque, &pValue);
-        if (result == C89ATOMIC_DEQUE_NO_DATA_AVAILABLE) {
-            c89atomic_test_passed();
-        } else {
-            c89atomic_test_failed();
+    for (i = 0; i < 4; i += 1) {
+        if (c89thrd_create(&threads[i], threadProc, &data) == c89thrd_success) {
+            threadCount += 1;
         }
+    }
 
-        printf("Deque Take Head (Empty): ");
-        result = c89atomic_deque_take_head(&deque, &pValue);
-        if (result == C89ATOMIC_DEQUE_NO_DATA_AVAILABLE) {
-            c89atomic_test_passed();
-        } else {
-            c89atomic_test_failed();
+    for (i = 0; i < threadCount; i += 1) {
+        c89thrd_join(threads[i], NULL);
+    }
+
+    return threadCount == 4 && data.counter == data.iterations * 4;
+}
+
+static void c89atomic_test__spinlock(void)
+{
+    printf("Spinlock:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Backoff");
+    {
+        c89atomic_backoff backoff;
+        c89atomic_uint32 i;
+
+        c89atomic_backoff_init(&backoff);
+        for (i = 0; i < C89ATOMIC_BACKOFF_SPIN_LIMIT + 4; i += 1) {
+            c89atomic_backoff_spin(&backoff);
         }
 
-        printf("Deque Push Tail:         ");
-        result = c89atomic_deque_push_tail(&deque, (void*)1);
-        if (result == C89ATOMIC_DEQUE_SUCCESS) {
-            result = c89atomic_deque_push_tail(&deque, (void*)2);
-            if (result == C89ATOMIC_DEQUE_SUCCESS) {
-                result = c89atomic_deque_push_tail(&deque, (void*)3);
-                if (result == C89ATOMIC_DEQUE_SUCCESS) {
-                    c89atomic_test_passed();
-                } else {
-                    c89atomic_test_failed();
-                }
+        if (backoff.step == C89ATOMIC_BACKOFF_SPIN_LIMIT) {
+            c89atomic_backoff_init(&backoff);
+            for (i = 0; i < C89ATOMIC_BACKOFF_SPIN_LIMIT + 4; i += 1) {
+                c89atomic_backoff_snooze(&backoff);
+            }
+
+            if (backoff.step == C89ATOMIC_BACKOFF_SPIN_LIMIT + 1) {
+                c89atomic_test_passed();
             } else {
                 c89atomic_test_failed();
             }
         } else {
             c89atomic_test_failed();
         }
-        
+    }
 
-        /* Take from the tail. Expecting "3". */
-        printf("Deque Take Tail:         ");
-        result = c89atomic_deque_take_tail(&deque, &pValue);
-        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)3) {
+    printf("    %-*s", PRINT_WIDTH, "Address lock selection");
+    {
+        c89atomic_uint8 buffer[256];
+        c89atomic_uint64* pValue = (c89atomic_uint64*)(((c89atomic_uintptr)buffer + 127) & ~(c89atomic_uintptr)127);
+        c89atomic_uint32* pHalves = (c89atomic_uint32*)pValue;
+        c89atomic_bool success = 1;
+
+        /* Overlapping objects must always be protected by the same lock. */
+        if (c89atomic_get_address_lock(pValue) != c89atomic_get_address_lock(&pHalves[0]) ||
+            c89atomic_get_address_lock(&pHalves[0]) != c89atomic_get_address_lock(&pHalves[1])) {
+            success = 0;
+        }
+
+        #if !defined(C89ATOMIC_USE_GLOBAL_LOCK)
+        /* Neighbouring 64 byte blocks must not share a lock, and each lock must be on its own cache line. */
+        if (c89atomic_get_address_lock(pValue) == c89atomic_get_address_lock((c89atomic_uint8*)pValue + 64)) {
+            success = 0;
+        }
+
+        if (((c89atomic_uintptr)c89atomic_get_address_lock(pValue) & (C89ATOMIC_CACHE_LINE_SIZE - 1)) != 0 ||
+            ((c89atomic_uintptr)c89atomic_get_address_lock((c89atomic_uint8*)pValue + 64) & (C89ATOMIC_CACHE_LINE_SIZE - 1)) != 0) {
+            success = 0;
+        }
+        #endif
+
+        if (success) {
             c89atomic_test_passed();
         } else {
             c89atomic_test_failed();
         }
+    }
 
-        /* Steal from the head. Expecting "1". */
-        printf("Deque Take Head:         ");
-        result = c89atomic_deque_take_head(&deque, &pValue);
-        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)1) {
+    printf("    %-*s", PRINT_WIDTH, "Mutual exclusion (4 threads)");
+    {
+        if (c89atomic_test__lock_contention(c89atomic_spinlock_test_thread)) {
             c89atomic_test_passed();
         } else {
             c89atomic_test_failed();
         }
+    }
 
-        /* Take last item. */
-        printf("Deque Take Tail (Last):  ");
-        result = c89atomic_deque_take_tail(&deque, &pValue);
-        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)2) {
+    printf("    %-*s", PRINT_WIDTH, "Trylock");
+    {
+        c89atomic_spinlock lock = 0;
+        c89atomic_ticket_lock ticketLock;
+        c89atomic_mcs_lock mcsLock;
+        c89atomic_mcs_node node0;
+        c89atomic_mcs_node node1;
+        c89atomic_bool success = 1;
+
+        memset(&ticketLock, 0, sizeof(ticketLock));
+        memset(&mcsLock, 0, sizeof(mcsLock));
+
+        if (!c89atomic_spinlock_trylock(&lock)) success = 0;
+        if ( c89atomic_spinlock_trylock(&lock)) success = 0;
+        c89atomic_spinlock_unlock(&lock);
+        if (!c89atomic_spinlock_trylock(&lock)) success = 0;
+        c89atomic_spinlock_unlock(&lock);
+
+        if (!c89atomic_ticket_lock_trylock(&ticketLock)) success = 0;
+        if ( c89atomic_ticket_lock_trylock(&ticketLock)) success = 0;
+        c89atomic_ticket_lock_unlock(&ticketLock);
+        if (!c89atomic_ticket_lock_trylock(&ticketLock)) success = 0;
+        c89atomic_ticket_lock_unlock(&ticketLock);
+
+        if (!c89atomic_mcs_lock_trylock(&mcsLock, &node0)) success = 0;
+        if ( c89atomic_mcs_lock_trylock(&mcsLock, &node1)) success = 0;
+        c89atomic_mcs_lock_unlock(&mcsLock, &node0);
+        if (!c89atomic_mcs_lock_trylock(&mcsLock, &node1)) success = 0;
+        c89atomic_mcs_lock_unlock(&mcsLock, &node1);
+        if (mcsLock.pTail != NULL) success = 0;
+
+        if (success) {
             c89atomic_test_passed();
         } else {
             c89atomic_test_failed();
         }
+    }
 
-        /* Now the deque should be empty. */
-        printf("Deque Empty:             ");
-        if (deque.head == deque.tail) {
+    printf("    %-*s", PRINT_WIDTH, "Ticket lock (4 threads)");
+    {
+        if (c89atomic_test__lock_contention(c89atomic_ticket_lock_test_thread)) {
             c89atomic_test_passed();
         } else {
             c89atomic_test_failed();
         }
+    }
 
-        /* Now we're going to take the last item from the head. We'll need to push a fresh item. */
-        printf("Deque Take Head (Last):  ");
-        result = c89atomic_deque_push_tail(&deque, (void*)4);
+    printf("    %-*s", PRINT_WIDTH, "MCS lock (4 threads)");
+    {
+        if (c89atomic_test__lock_contention(c89atomic_mcs_lock_test_thread)) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the wait/notify ping-pong test. */
+typedef struct
+{
+    c89atomic_uint32 turn;
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 errors;
+} c89atomic_wait_ping_pong_data;
+
+static int c89atomic_wait_ping_pong_thread(void* arg)
+{
+    c89atomic_wait_ping_pong_data* pData = (c89atomic_wait_ping_pong_data*)arg;
+    c89atomic_uint32 i;
+
+    /* This thread owns odd turns. */
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_uint32 turn = i*2 + 1;
+
+        c89atomic_wait_explicit_32(&pData->turn, turn - 1, c89atomic_memory_order_acquire);
+        if (c89atomic_load_explicit_32(&pData->turn, c89atomic_memory_order_acquire) != turn) {
+            pData->errors += 1;
+        }
+
+        c89atomic_store_explicit_32(&pData->turn, turn + 1, c89atomic_memory_order_release);
+        c89atomic_notify_one_32(&pData->turn);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__wait(void)
+{
+    printf("Wait/Notify:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Wait returns when value differs");
+    {
+        c89atomic_uint32 value = 1;
+        c89atomic_wait_32(&value, 0);
+        c89atomic_test_passed();
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Notify with no waiters");
+    {
+        c89atomic_uint32 value = 0;
+        c89atomic_notify_one_32(&value);
+        c89atomic_notify_all_32(&value);
+        c89atomic_test_passed();
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Ping-pong between threads");
+    {
+        c89thrd_t thread;
+        c89atomic_wait_ping_pong_data data;
+        c89atomic_uint32 i;
+
+        data.turn = 0;
+        data.iterations = 10000;
+        data.errors = 0;
+
+        if (c89thrd_create(&thread, c89atomic_wait_ping_pong_thread, &data) != c89thrd_success) {
+            c89atomic_test_failed();
+        } else {
+            /* The main thread owns even turns. */
+            for (i = 0; i < data.iterations; i += 1) {
+                c89atomic_uint32 turn = i*2;
+
+                if (turn > 0) {
+                    c89atomic_wait_explicit_32(&data.turn, turn - 1, c89atomic_memory_order_acquire);
+                }
+
+                c89atomic_store_explicit_32(&data.turn, turn + 1, c89atomic_memory_order_release);
+                c89atomic_notify_one_32(&data.turn);
+            }
+
+            c89thrd_join(thread, NULL);
+
+            if (data.errors == 0 && c89atomic_load_32(&data.turn) == data.iterations*2) {
+                c89atomic_test_passed();
+            } else {
+                c89atomic_test_failed();
+            }
+        }
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the 128-bit contention test. Both halves are incremented together. */
+typedef struct
+{
+    c89atomic_uint128 value;
+    c89atomic_uint32 iterations;
+} c89atomic_128_test_data;
+
+static int c89atomic_128_test_thread(void* arg)
+{
+    c89atomic_128_test_data* pData = (c89atomic_128_test_data*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_uint128 oldValue = c89atomic_load_explicit_128(&pData->value, c89atomic_memory_order_relaxed);
+        c89atomic_uint128 newValue;
+
+        do {
+            newValue.lo = oldValue.lo + 1;
+            newValue.hi = oldValue.hi + 1;
+        } while (!c89atomic_compare_exchange_weak_128(&pData->value, &oldValue, newValue));
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__128(void)
+{
+    printf("128-bit:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Lock-free");
+    {
+        c89atomic_uint128 value;
+        printf("%s\n", c89atomic_is_lock_free_128(&value) ? "YES" : "NO");
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Load");
+    {
+        c89atomic_uint128 value;
+        c89atomic_uint128 result;
+
+        value.lo = C89ATOMIC_ULL(0x0123456789ABCDEF);
+        value.hi = C89ATOMIC_ULL(0xFEDCBA9876543210);
+        result = c89atomic_load_128(&value);
+
+        if (result.lo == value.lo && result.hi == value.hi) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Compare exchange");
+    {
+        c89atomic_uint128 value;
+        c89atomic_uint128 expected;
+        c89atomic_uint128 replacement;
+        c89atomic_bool success = 1;
+
+        value.lo       = 1;
+        value.hi       = 2;
+        replacement.lo = 3;
+        replacement.hi = 4;
+
+        /* Only one half matches so this must fail and give us back the current value. */
+        expected.lo = 1;
+        expected.hi = 5;
+        if (c89atomic_compare_exchange_strong_128(&value, &expected, replacement)) {
+            success = 0;
+        }
+        if (expected.lo != 1 || expected.hi != 2 || value.lo != 1 || value.hi != 2) {
+            success = 0;
+        }
+
+        /* expected now holds the current value so this must succeed. */
+        if (!c89atomic_compare_exchange_strong_128(&value, &expected, replacement)) {
+            success = 0;
+        }
+        if (value.lo != 3 || value.hi != 4) {
+            success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Contention (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_128_test_data data;
+        int threadCount = 0;
+        int i;
+
+        data.value.lo = 0;
+        data.value.hi = C89ATOMIC_ULL(0xFFFFFFFFFFFF0000);    /* Make the high half wrap to test that both halves are independent. */
+        data.iterations = 100000;
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_128_test_thread, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 4 && data.value.lo == data.iterations * 4 && data.value.hi == (c89atomic_uint64)(C89ATOMIC_ULL(0xFFFFFFFFFFFF0000) + data.iterations * 4)) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the floating point contention test. */
+typedef struct
+{
+    float sum32;
+    double sum64;
+    double accumulated;
+    c89atomic_uint32 iterations;
+} c89atomic_float_test_data;
+
+static int c89atomic_float_test_thread(void* arg)
+{
+    c89atomic_float_test_data* pData = (c89atomic_float_test_data*)arg;
+    c89atomic_uint32 i;
+
+    /* Adding 1 is exact for both types at these magnitudes so the totals can be compared exactly. */
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_fetch_add_f32(&pData->sum32, 1.0f);
+        c89atomic_fetch_add_f64(&pData->sum64, 1.0);
+        c89atomic_accumulate_f64(&pData->accumulated, 0.5);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__float(void)
+{
+    printf("Floating Point:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Add and subtract");
+    {
+        float  a = 1.5f;
+        double b = 1.5;
+        float  prevA;
+        double prevB;
+
+        /* An integer add on the bit pattern would not give these results. */
+        prevA = c89atomic_fetch_add_f32(&a, 2.25f);
+        prevB = c89atomic_fetch_add_f64(&b, 2.25);
+        if (prevA == 1.5f && a == 3.75f && prevB == 1.5 && b == 3.75) {
+            prevA = c89atomic_fetch_sub_f32(&a, 4.0f);
+            prevB = c89atomic_fetch_sub_f64(&b, 4.0);
+            if (prevA == 3.75f && a == -0.25f && prevB == 3.75 && b == -0.25) {
+                c89atomic_test_passed();
+            } else {
+                c89atomic_test_failed();
+            }
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Min and max");
+    {
+        float  a = 2.0f;
+        double b = 2.0;
+        c89atomic_bool success = 1;
+
+        if (c89atomic_fetch_min_f32(&a, 3.0f) != 2.0f || a != 2.0f) success = 0;
+        if (c89atomic_fetch_min_f32(&a, -1.0f) != 2.0f || a != -1.0f) success = 0;
+        if (c89atomic_fetch_max_f32(&a, 5.0f) != -1.0f || a != 5.0f) success = 0;
+        if (c89atomic_fetch_max_f32(&a, 4.0f) != 5.0f || a != 5.0f) success = 0;
+
+        if (c89atomic_fetch_min_f64(&b, 3.0) != 2.0 || b != 2.0) success = 0;
+        if (c89atomic_fetch_min_f64(&b, -1.0) != 2.0 || b != -1.0) success = 0;
+        if (c89atomic_fetch_max_f64(&b, 5.0) != -1.0 || b != 5.0) success = 0;
+        if (c89atomic_fetch_max_f64(&b, 4.0) != 5.0 || b != 5.0) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Contention (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_float_test_data data;
+        int threadCount = 0;
+        int i;
+
+        data.sum32 = 0;
+        data.sum64 = 0;
+        data.accumulated = 0;
+        data.iterations = 100000;
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_float_test_thread, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 4 && data.sum32 == 400000.0f && data.sum64 == 400000.0 && data.accumulated == 200000.0) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the min/max contention test. Each thread reports a range of values. */
+typedef struct
+{
+    c89atomic_uint32 highWaterMark;
+    c89atomic_int64 lowWaterMark;
+    c89atomic_uint32 nextThreadIndex;
+    c89atomic_uint32 iterations;
+} c89atomic_minmax_test_data;
+
+static int c89atomic_minmax_test_thread(void* arg)
+{
+    c89atomic_minmax_test_data* pData = (c89atomic_minmax_test_data*)arg;
+    c89atomic_uint32 threadIndex = c89atomic_fetch_add_32(&pData->nextThreadIndex, 1);
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_uint32 value = (i * 4) + threadIndex;
+        c89atomic_fetch_max_explicit_32(&pData->highWaterMark, value, c89atomic_memory_order_relaxed);
+        c89atomic_fetch_min_explicit_i64(&pData->lowWaterMark, -(c89atomic_int64)value, c89atomic_memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+#define c89atomic_test__minmax_n(sizeInBits, lo, hi) \
+    { \
+        c89atomic_uint##sizeInBits u = (c89atomic_uint##sizeInBits)(hi); \
+        c89atomic_int##sizeInBits  i = 0; \
+        \
+        if (c89atomic_fetch_min_##sizeInBits(&u, (c89atomic_uint##sizeInBits)(lo)) != (c89atomic_uint##sizeInBits)(hi) || u != (c89atomic_uint##sizeInBits)(lo)) success = 0; \
+        if (c89atomic_fetch_min_##sizeInBits(&u, (c89atomic_uint##sizeInBits)(hi)) != (c89atomic_uint##sizeInBits)(lo) || u != (c89atomic_uint##sizeInBits)(lo)) success = 0; \
+        if (c89atomic_fetch_max_##sizeInBits(&u, (c89atomic_uint##sizeInBits)(hi)) != (c89atomic_uint##sizeInBits)(lo) || u != (c89atomic_uint##sizeInBits)(hi)) success = 0; \
+        if (c89atomic_fetch_max_##sizeInBits(&u, (c89atomic_uint##sizeInBits)(lo)) != (c89atomic_uint##sizeInBits)(hi) || u != (c89atomic_uint##sizeInBits)(hi)) success = 0; \
+        \
+        /* A negative number must compare as less than zero for the signed versions. */ \
+        if (c89atomic_fetch_min_i##sizeInBits(&i, -1) != 0 || i != -1) success = 0; \
+        if (c89atomic_fetch_max_i##sizeInBits(&i, 1) != -1 || i != 1) success = 0; \
+        if (c89atomic_fetch_max_i##sizeInBits(&i, -5) != 1 || i != 1) success = 0; \
+    }
+
+static void c89atomic_test__minmax(void)
+{
+    printf("Min/Max:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "All sizes");
+    {
+        c89atomic_bool success = 1;
+
+        c89atomic_test__minmax_n(8,  1, 200);
+        c89atomic_test__minmax_n(16, 1, 60000);
+        c89atomic_test__minmax_n(32, 1, 4000000000U);
+        c89atomic_test__minmax_n(64, 1, C89ATOMIC_ULL(18000000000000000000));
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "High water mark (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_minmax_test_data data;
+        int threadCount = 0;
+        int i;
+
+        data.highWaterMark = 0;
+        data.lowWaterMark = 0;
+        data.nextThreadIndex = 0;
+        data.iterations = 100000;
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_minmax_test_thread, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 4 && data.highWaterMark == data.iterations*4 - 1 && data.lowWaterMark == -(c89atomic_int64)(data.iterations*4 - 1)) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+#define c89atomic_test__rmw_n(sizeInBits) \
+    { \
+        c89atomic_uint##sizeInBits x = 0x0F; \
+        c89atomic_int##sizeInBits  y = 0; \
+        \
+        c89atomic_add_##sizeInBits(&x, 0x10);  if (x != 0x1F) success = 0; \
+        c89atomic_sub_##sizeInBits(&x, 0x02);  if (x != 0x1D) success = 0; \
+        c89atomic_or_##sizeInBits (&x, 0x40);  if (x != 0x5D) success = 0; \
+        c89atomic_xor_##sizeInBits(&x, 0x0F);  if (x != 0x52) success = 0; \
+        c89atomic_and_##sizeInBits(&x, 0x70);  if (x != 0x50) success = 0; \
+        \
+        if (c89atomic_add_fetch_##sizeInBits(&x, 0x0F) != 0x5F || x != 0x5F) success = 0; \
+        if (c89atomic_sub_fetch_##sizeInBits(&x, 0x0E) != 0x51 || x != 0x51) success = 0; \
+        if (c89atomic_or_fetch_##sizeInBits (&x, 0x06) != 0x57 || x != 0x57) success = 0; \
+        if (c89atomic_xor_fetch_##sizeInBits(&x, 0x50) != 0x07 || x != 0x07) success = 0; \
+        if (c89atomic_and_fetch_##sizeInBits(&x, 0x05) != 0x05 || x != 0x05) success = 0; \
+        \
+        /* Wrapping must happen at the size of the object. */ \
+        if (c89atomic_sub_fetch_##sizeInBits(&x, 0x06) != (c89atomic_uint##sizeInBits)~(c89atomic_uint##sizeInBits)0) success = 0; \
+        \
+        c89atomic_sub_i##sizeInBits(&y, 3); \
+        if (y != -3 || c89atomic_add_fetch_i##sizeInBits(&y, 1) != -2) success = 0; \
+    }
+
+static void c89atomic_test__rmw(void)
+{
+    printf("Read-Modify-Write:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "No-return and op_fetch");
+    {
+        c89atomic_bool success = 1;
+
+        c89atomic_test__rmw_n(8);
+        c89atomic_test__rmw_n(16);
+        c89atomic_test__rmw_n(32);
+        c89atomic_test__rmw_n(64);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the bit test contention test. Each thread owns one bit of a shared word. */
+typedef struct
+{
+    c89atomic_uint32 word;
+    c89atomic_uint64 word64;
+    c89atomic_uint32 nextBitIndex;
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 errors;
+} c89atomic_bit_test_data;
+
+static int c89atomic_bit_test_thread(void* arg)
+{
+    c89atomic_bit_test_data* pData = (c89atomic_bit_test_data*)arg;
+    c89atomic_uint32 bitIndex = c89atomic_fetch_add_32(&pData->nextBitIndex, 1);
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        if (c89atomic_bit_test_and_set_32(&pData->word, bitIndex) != 0 || c89atomic_bit_test_and_reset_32(&pData->word, bitIndex) != 1) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        if (c89atomic_bit_test_and_complement_64(&pData->word64, bitIndex + 32) != 0 || c89atomic_bit_test_and_complement_64(&pData->word64, bitIndex + 32) != 1) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__bit(void)
+{
+    printf("Bit Test:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Set, reset and complement");
+    {
+        c89atomic_uint32 word   = 0;
+        c89atomic_uint64 word64 = 0;
+        c89atomic_bool success = 1;
+
+        if (c89atomic_bit_test_and_set_32(&word, 5) != 0 || word != 0x20) success = 0;
+        if (c89atomic_bit_test_and_set_32(&word, 5) != 1 || word != 0x20) success = 0;
+        if (c89atomic_bit_test_and_reset_32(&word, 5) != 1 || word != 0) success = 0;
+        if (c89atomic_bit_test_and_reset_32(&word, 5) != 0 || word != 0) success = 0;
+        if (c89atomic_bit_test_and_complement_32(&word, 31) != 0 || word != 0x80000000) success = 0;
+        if (c89atomic_bit_test_and_complement_32(&word, 31) != 1 || word != 0) success = 0;
+
+        if (c89atomic_bit_test_and_set_64(&word64, 63) != 0 || word64 != C89ATOMIC_ULL(0x8000000000000000)) success = 0;
+        if (c89atomic_bit_test_and_complement_64(&word64, 0) != 0 || word64 != C89ATOMIC_ULL(0x8000000000000001)) success = 0;
+        if (c89atomic_bit_test_and_reset_64(&word64, 63) != 1 || word64 != 1) success = 0;
+
+        /* The index wraps at the size of the object. */
+        if (c89atomic_bit_test_and_set_32(&word, 33) != 0 || word != 0x02) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Shared word (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_bit_test_data data;
+        int threadCount = 0;
+        int i;
+
+        data.word = 0;
+        data.word64 = 0;
+        data.nextBitIndex = 0;
+        data.iterations = 100000;
+        data.errors = 0;
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_bit_test_thread, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 4 && data.errors == 0 && data.word == 0 && data.word64 == 0) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the memory ordering test. The producer writes a payload with a relaxed store and
+then publishes it with a release store. The consumer must always see the payload once it has seen the
+published sequence number with an acquire load.
+*/
+typedef struct
+{
+    c89atomic_uint32 payload;
+    c89atomic_uint32 sequence;
+    c89atomic_uint32 ack;
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 errors;
+} c89atomic_ordering_test_data;
+
+static int c89atomic_ordering_test_consumer(void* arg)
+{
+    c89atomic_ordering_test_data* pData = (c89atomic_ordering_test_data*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 1; i <= pData->iterations; i += 1) {
+        while (c89atomic_load_explicit_32(&pData->sequence, c89atomic_memory_order_acquire) != i) {
+            c89thrd_yield();
+        }
+
+        if (c89atomic_load_explicit_32(&pData->payload, c89atomic_memory_order_relaxed) != i * 3) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        c89atomic_store_explicit_32(&pData->ack, i, c89atomic_memory_order_release);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__ordering(void)
+{
+    printf("Memory Ordering:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Fences");
+    {
+        /* Not much we can check here beyond all orders compiling and not crashing. */
+        c89atomic_thread_fence(c89atomic_memory_order_relaxed);
+        c89atomic_thread_fence(c89atomic_memory_order_acquire);
+        c89atomic_thread_fence(c89atomic_memory_order_release);
+        c89atomic_thread_fence(c89atomic_memory_order_acq_rel);
+        c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+        c89atomic_test_passed();
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Loads and stores");
+    {
+        c89atomic_uint8  value8  = 0;
+        c89atomic_uint16 value16 = 0;
+        c89atomic_uint32 value32 = 0;
+        c89atomic_uint64 value64 = 0;
+        c89atomic_flag   flag    = 0;
+        c89atomic_bool success = 1;
+
+        c89atomic_store_explicit_8 (&value8,  1, c89atomic_memory_order_relaxed);
+        c89atomic_store_explicit_16(&value16, 2, c89atomic_memory_order_release);
+        c89atomic_store_explicit_32(&value32, 3, c89atomic_memory_order_seq_cst);
+        c89atomic_store_explicit_64(&value64, 4, c89atomic_memory_order_release);
+        if (c89atomic_load_explicit_8 (&value8,  c89atomic_memory_order_relaxed) != 1) success = 0;
+        if (c89atomic_load_explicit_16(&value16, c89atomic_memory_order_acquire) != 2) success = 0;
+        if (c89atomic_load_explicit_32(&value32, c89atomic_memory_order_seq_cst) != 3) success = 0;
+        if (c89atomic_load_explicit_64(&value64, c89atomic_memory_order_acquire) != 4) success = 0;
+
+        /* Seq-cst stores must not clobber the value being stored. */
+        value32 = 0x12345678;
+        c89atomic_store_explicit_32(&value32, value32 + 1, c89atomic_memory_order_seq_cst);
+        if (value32 != 0x12345679) success = 0;
+
+        c89atomic_flag_test_and_set(&flag);
+        if (c89atomic_flag_load_explicit(&flag, c89atomic_memory_order_acquire) != 1) success = 0;
+        c89atomic_flag_clear_explicit(&flag, c89atomic_memory_order_release);
+        if (c89atomic_flag_load_explicit(&flag, c89atomic_memory_order_relaxed) != 0) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Message passing");
+    {
+        c89thrd_t thread;
+        c89atomic_ordering_test_data data;
+        c89atomic_uint32 i;
+
+        data.payload    = 0;
+        data.sequence   = 0;
+        data.ack        = 0;
+        data.iterations = 10000;
+        data.errors     = 0;
+
+        if (c89thrd_create(&thread, c89atomic_ordering_test_consumer, &data) == c89thrd_success) {
+            for (i = 1; i <= data.iterations; i += 1) {
+                c89atomic_store_explicit_32(&data.payload, i * 3, c89atomic_memory_order_relaxed);
+                c89atomic_store_explicit_32(&data.sequence, i, c89atomic_memory_order_release);
+
+                while (c89atomic_load_explicit_32(&data.ack, c89atomic_memory_order_acquire) != i) {
+                    c89thrd_yield();
+                }
+            }
+
+            c89thrd_join(thread, NULL);
+
+            if (data.errors == 0) {
+                c89atomic_test_passed();
+            } else {
+                c89atomic_test_failed();
+            }
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+static void c89atomic_test__backend_info(void)
+{
+    c89atomic_backend_info info = c89atomic_get_backend_info();
+
+    printf("Backend Info:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Always lock-free constants");
+    {
+        c89atomic_bool success = 1;
+
+        /* These need to be usable in preprocessor expressions. */
+        #if C89ATOMIC_ALWAYS_LOCK_FREE_8 && !C89ATOMIC_ALWAYS_LOCK_FREE_PTR
+        if (!info.isLockFree8) success = 0;
+        #endif
+
+        /* If something is always lock-free at compile time it must also be lock-free at run time. */
+        if (C89ATOMIC_ALWAYS_LOCK_FREE_8   && !info.isLockFree8)   success = 0;
+        if (C89ATOMIC_ALWAYS_LOCK_FREE_16  && !info.isLockFree16)  success = 0;
+        if (C89ATOMIC_ALWAYS_LOCK_FREE_32  && !info.isLockFree32)  success = 0;
+        if (C89ATOMIC_ALWAYS_LOCK_FREE_64  && !info.isLockFree64)  success = 0;
+        if (C89ATOMIC_ALWAYS_LOCK_FREE_PTR && !info.isLockFreePtr) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Info");
+    {
+        if (info.pCodePath != NULL && info.pArchitecture != NULL && info.cacheLineSize == C89ATOMIC_CACHE_LINE_SIZE && info.lockCount > 0) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %s on %s. Lock-free:%s%s%s%s%s. Cache line: %u.\n",
+        info.pCodePath, info.pArchitecture,
+        info.isLockFree8   ? " 8"   : "",
+        info.isLockFree16  ? " 16"  : "",
+        info.isLockFree32  ? " 32"  : "",
+        info.isLockFree64  ? " 64"  : "",
+        info.isLockFree128 ? " 128" : "",
+        (unsigned int)info.cacheLineSize);
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the seqlock test. The writer keeps the two halves of the snapshot in sync and the
+readers check that they never observe a torn snapshot.
+*/
+typedef struct
+{
+    c89atomic_seqlock lock;
+    c89atomic_uint32 a;
+    c89atomic_uint32 b;             /* Always equal to ~a. */
+    c89atomic_uint64 value64;       /* High and low halves are always equal. */
+    c89atomic_uint32 done;
+    c89atomic_uint32 reads;
+    c89atomic_uint32 errors;
+} c89atomic_seqlock_test_data;
+
+static int c89atomic_seqlock_test_reader(void* arg)
+{
+    c89atomic_seqlock_test_data* pData = (c89atomic_seqlock_test_data*)arg;
+
+    while (c89atomic_load_explicit_32(&pData->done, c89atomic_memory_order_acquire) == 0) {
+        c89atomic_uint32 sequence;
+        c89atomic_uint32 a;
+        c89atomic_uint32 b;
+        c89atomic_uint64 value64;
+
+        do {
+            sequence = c89atomic_seqlock_read_begin(&pData->lock);
+            a = c89atomic_load_explicit_32(&pData->a, c89atomic_memory_order_relaxed);
+            b = c89atomic_load_explicit_32(&pData->b, c89atomic_memory_order_relaxed);
+        } while (c89atomic_seqlock_read_retry(&pData->lock, sequence));
+
+        if (a != ~b) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        value64 = c89atomic_load_explicit_64(&pData->value64, c89atomic_memory_order_acquire);
+        if ((c89atomic_uint32)(value64 >> 32) != (c89atomic_uint32)value64) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        c89atomic_fetch_add_explicit_32(&pData->reads, 1, c89atomic_memory_order_relaxed);
+        c89thrd_yield();
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__seqlock(void)
+{
+    printf("Seqlock:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Read and write");
+    {
+        c89atomic_seqlock lock;
+        c89atomic_uint32 sequence;
+        c89atomic_bool success = 1;
+
+        memset(&lock, 0, sizeof(lock));
+
+        sequence = c89atomic_seqlock_read_begin(&lock);
+        if (c89atomic_seqlock_read_retry(&lock, sequence)) success = 0;
+
+        /* A write in between must force a retry. */
+        sequence = c89atomic_seqlock_read_begin(&lock);
+        c89atomic_seqlock_write_lock(&lock);
+        c89atomic_seqlock_write_unlock(&lock);
+        if (!c89atomic_seqlock_read_retry(&lock, sequence)) success = 0;
+
+        if (c89atomic_seqlock_read_begin(&lock) != 2) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Snapshots (1 writer, 3 readers)");
+    {
+        c89thrd_t threads[3];
+        c89atomic_seqlock_test_data data;
+        int threadCount = 0;
+        c89atomic_uint32 i;
+
+        memset(&data, 0, sizeof(data));
+        data.b = ~data.a;
+
+        for (i = 0; i < 3; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_seqlock_test_reader, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 1; i <= 100000; i += 1) {
+            c89atomic_seqlock_write_lock(&data.lock);
+            {
+                data.a = i;
+                data.b = ~i;
+            }
+            c89atomic_seqlock_write_unlock(&data.lock);
+
+            c89atomic_store_explicit_64(&data.value64, ((c89atomic_uint64)i << 32) | i, c89atomic_memory_order_release);
+
+            if ((i & 1023) == 0) {
+                c89thrd_yield();
+            }
+        }
+
+        c89atomic_store_explicit_32(&data.done, 1, c89atomic_memory_order_release);
+
+        for (i = 0; i < (c89atomic_uint32)threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 3 && data.errors == 0) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the reader-writer lock test. Writers keep a and b equal and readers check that
+they never see them differ.
+*/
+typedef struct
+{
+    c89atomic_rwlock lock;
+    c89atomic_uint32 a;
+    c89atomic_uint32 b;
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 writes;
+    c89atomic_uint32 errors;
+} c89atomic_rwlock_test_data;
+
+static int c89atomic_rwlock_test_thread(void* arg)
+{
+    c89atomic_rwlock_test_data* pData = (c89atomic_rwlock_test_data*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        if ((i & 7) == 0) {
+            c89atomic_uint32 slot;
+
+            c89atomic_rwlock_write_lock(&pData->lock);
+            {
+                pData->a += 1;
+                pData->b += 1;
+                pData->writes += 1;
+            }
+            slot = c89atomic_rwlock_downgrade(&pData->lock);
+            {
+                if (pData->a != pData->b) {
+                    c89atomic_fetch_add_32(&pData->errors, 1);
+                }
+            }
+            c89atomic_rwlock_read_unlock(&pData->lock, slot);
+        } else {
+            c89atomic_uint32 slot = c89atomic_rwlock_read_lock(&pData->lock);
+            {
+                if (pData->a != pData->b) {
+                    c89atomic_fetch_add_32(&pData->errors, 1);
+                }
+            }
+
+            if ((i & 7) == 1 && c89atomic_rwlock_try_upgrade(&pData->lock, slot)) {
+                pData->a += 1;
+                pData->b += 1;
+                pData->writes += 1;
+                c89atomic_rwlock_write_unlock(&pData->lock);
+            } else {
+                c89atomic_rwlock_read_unlock(&pData->lock, slot);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__rwlock(void)
+{
+    printf("Reader-writer lock:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Read, write and trylock");
+    {
+        c89atomic_rwlock lock;
+        c89atomic_uint32 slot0;
+        c89atomic_uint32 slot1;
+        c89atomic_bool success = 1;
+
+        memset(&lock, 0, sizeof(lock));
+
+        /* Readers can share the lock, but keep writers out. */
+        slot0 = c89atomic_rwlock_read_lock(&lock);
+        slot1 = c89atomic_rwlock_read_lock(&lock);
+        if (c89atomic_rwlock_write_trylock(&lock)) success = 0;
+        c89atomic_rwlock_read_unlock(&lock, slot1);
+        if (c89atomic_rwlock_write_trylock(&lock)) success = 0;
+        c89atomic_rwlock_read_unlock(&lock, slot0);
+
+        if (!c89atomic_rwlock_write_trylock(&lock)) success = 0;
+        if ( c89atomic_rwlock_write_trylock(&lock)) success = 0;
+        c89atomic_rwlock_write_unlock(&lock);
+
+        c89atomic_rwlock_write_lock(&lock);
+        c89atomic_rwlock_write_unlock(&lock);
+        if (!c89atomic_rwlock_write_trylock(&lock)) success = 0;
+        c89atomic_rwlock_write_unlock(&lock);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Upgrade and downgrade");
+    {
+        c89atomic_rwlock lock;
+        c89atomic_uint32 slot0;
+        c89atomic_uint32 slot1;
+        c89atomic_uint32 i;
+        c89atomic_bool success = 1;
+
+        memset(&lock, 0, sizeof(lock));
+
+        /* The only reader can always upgrade. */
+        slot0 = c89atomic_rwlock_read_lock(&lock);
+        if (!c89atomic_rwlock_try_upgrade(&lock, slot0)) success = 0;
+        if (c89atomic_rwlock_write_trylock(&lock)) success = 0;
+
+        /* After downgrading, other readers are let in but writers are not. */
+        slot0 = c89atomic_rwlock_downgrade(&lock);
+        slot1 = c89atomic_rwlock_read_lock(&lock);
+        if (c89atomic_rwlock_write_trylock(&lock)) success = 0;
+
+        c89atomic_rwlock_read_unlock(&lock, slot1);
+
+        /* Upgrading must fail while another writer holds the lock, and the read lock must be kept. */
+        c89atomic_store_32(&lock.writer, 1);
+        if (c89atomic_rwlock_try_upgrade(&lock, slot0)) success = 0;
+        if (lock.slots[slot0].readers != 1) success = 0;
+        c89atomic_rwlock_write_unlock(&lock);
+
+        if (!c89atomic_rwlock_try_upgrade(&lock, slot0)) success = 0;
+        c89atomic_rwlock_write_unlock(&lock);
+
+        /* Everything must be back to zero. */
+        if (lock.writer != 0) success = 0;
+        for (i = 0; i < C89ATOMIC_RWLOCK_SLOT_COUNT; i += 1) {
+            if (lock.slots[i].readers != 0) success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Readers and writers (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_rwlock_test_data data;
+        int threadCount = 0;
+        int i;
+
+        memset(&data, 0, sizeof(data));
+        data.iterations = 100000;
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_rwlock_test_thread, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount == 4 && data.errors == 0 && data.a == data.writes && data.b == data.writes && data.writes >= (data.iterations / 8) * 4) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+static int c89atomic_counter_test_thread(void* arg)
+{
+    c89atomic_counter* pCounter = (c89atomic_counter*)arg;
+    c89atomic_uint32 i;
+
+    for (i = 0; i < 100000; i += 1) {
+        c89atomic_counter_increment(pCounter);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__counter(void)
+{
+    printf("Counter:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Add, read and reset");
+    {
+        c89atomic_counter counter;
+        c89atomic_bool success = 1;
+
+        memset(&counter, 0, sizeof(counter));
+
+        c89atomic_counter_increment(&counter);
+        c89atomic_counter_add(&counter, C89ATOMIC_ULL(0x100000000));
+        if (c89atomic_counter_read(&counter) != C89ATOMIC_ULL(0x100000001)) success = 0;
+        if (c89atomic_counter_reset_and_read(&counter) != C89ATOMIC_ULL(0x100000001)) success = 0;
+        if (c89atomic_counter_read(&counter) != 0) success = 0;
+        if (c89atomic_counter_reset_and_read(&counter) != 0) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Increments (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_counter counter;
+        c89atomic_uint64 total = 0;
+        int threadCount = 0;
+        int i;
+
+        memset(&counter, 0, sizeof(counter));
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_counter_test_thread, &counter) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        /* Reset while the threads are running to make sure no increments are lost. */
+        for (i = 0; i < 100; i += 1) {
+            total += c89atomic_counter_reset_and_read(&counter);
+            c89thrd_yield();
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        total += c89atomic_counter_reset_and_read(&counter);
+
+        if (threadCount == 4 && total == 400000 && c89atomic_counter_read(&counter) == 0) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+static void c89atomic_test__tagged_ptr(void)
+{
+    printf("Pointers:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Fetch add/sub");
+    {
+        c89atomic_uint32 array[4];
+        void* ptr = &array[0];
+        c89atomic_bool success = 1;
+
+        if (c89atomic_fetch_add_explicit_ptr((volatile void**)&ptr, sizeof(array[0]) * 3, c89atomic_memory_order_relaxed) != &array[0]) success = 0;
+        if (ptr != &array[3]) success = 0;
+        if (c89atomic_fetch_sub_ptr(&ptr, sizeof(array[0]) * 2) != &array[3]) success = 0;
+        if (ptr != &array[1]) success = 0;
+        if (c89atomic_fetch_add_ptr(&ptr, -(c89atomic_intptr)sizeof(array[0])) != &array[1]) success = 0;
+        if (ptr != &array[0]) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Tagged pointer packing");
+    {
+        c89atomic_uint64 node;  /* 8 byte aligned for the low bits case. */
+        c89atomic_uintptr maxTag = ((c89atomic_uintptr)1 << C89ATOMIC_TAGGED_PTR_TAG_BITS) - 1;
+        c89atomic_tagged_ptr tagged;
+        c89atomic_bool success = 1;
+
+        tagged = c89atomic_tagged_ptr_make(&node, maxTag);
+        if (c89atomic_tagged_ptr_get_ptr(tagged) != &node) success = 0;
+        if (c89atomic_tagged_ptr_get_tag(tagged) != maxTag) success = 0;
+
+        /* The tag wraps around without touching the pointer. */
+        tagged = c89atomic_tagged_ptr_make(&node, maxTag + 1);
+        if (c89atomic_tagged_ptr_get_ptr(tagged) != &node) success = 0;
+        if (c89atomic_tagged_ptr_get_tag(tagged) != 0) success = 0;
+
+        tagged = c89atomic_tagged_ptr_make(NULL, 1);
+        if (c89atomic_tagged_ptr_get_ptr(tagged) != NULL) success = 0;
+        if (c89atomic_tagged_ptr_get_tag(tagged) != 1) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Tagged pointer compare-exchange");
+    {
+        c89atomic_uint64 nodeA;
+        c89atomic_uint64 nodeB;
+        c89atomic_tagged_ptr head;
+        c89atomic_tagged_ptr expected;
+        c89atomic_tagged_ptr stale;
+        c89atomic_bool success = 1;
+
+        c89atomic_tagged_ptr_store_explicit(&head, c89atomic_tagged_ptr_make(&nodeA, 0), c89atomic_memory_order_relaxed);
+
+        /* A successful exchange bumps the tag. */
+        expected = c89atomic_tagged_ptr_load_explicit(&head, c89atomic_memory_order_relaxed);
+        stale    = expected;
+        if (!c89atomic_tagged_ptr_compare_exchange_strong_explicit(&head, &expected, &nodeB, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) success = 0;
+        if (c89atomic_tagged_ptr_get_ptr(head) != &nodeB || c89atomic_tagged_ptr_get_tag(head) != 1) success = 0;
+
+        /* Put A back. The pointer is the same as before, but the tag is not, so the stale exchange must fail. */
+        expected = c89atomic_tagged_ptr_load_explicit(&head, c89atomic_memory_order_relaxed);
+        if (!c89atomic_tagged_ptr_compare_exchange_strong_explicit(&head, &expected, &nodeA, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) success = 0;
+        if (c89atomic_tagged_ptr_compare_exchange_strong_explicit(&head, &stale, &nodeB, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) success = 0;
+
+        /* The failed exchange must give us the current value. */
+        if (stale != head || c89atomic_tagged_ptr_get_ptr(stale) != &nodeA || c89atomic_tagged_ptr_get_tag(stale) != 2) success = 0;
+
+        while (!c89atomic_tagged_ptr_compare_exchange_weak_explicit(&head, &stale, &nodeB, c89atomic_memory_order_acq_rel, c89atomic_memory_order_acquire)) {
+        }
+        if (c89atomic_tagged_ptr_get_ptr(head) != &nodeB || c89atomic_tagged_ptr_get_tag(head) != 3) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the hazard pointer test. A writer keeps replacing the shared node and retiring the
+old one while readers protect the current node and check that it hasn't been freed.
+*/
+#define C89ATOMIC_HAZARD_TEST_NODE_COUNT    20000
+
+typedef struct
+{
+    c89atomic_uint32 value;
+    c89atomic_uint32 freed;
+} c89atomic_hazard_test_node;
+
+typedef struct
+{
+    c89atomic_hazard_domain domain;
+    c89atomic_hazard_record records[4];
+    c89atomic_hazard_test_node nodes[C89ATOMIC_HAZARD_TEST_NODE_COUNT];
+    c89atomic_hazard_test_node* pCurrent;
+    c89atomic_uint32 freeCount;
+    c89atomic_uint32 done;
+    c89atomic_uint32 errors;
+} c89atomic_hazard_test_data;
+
+static void c89atomic_hazard_test_free(void* pUserData, void* pObject)
+{
+    c89atomic_hazard_test_data* pData = (c89atomic_hazard_test_data*)pUserData;
+    c89atomic_hazard_test_node* pNode = (c89atomic_hazard_test_node*)pObject;
+
+    /* Don't actually free it so readers can check whether or not they're looking at a freed node. */
+    if (c89atomic_exchange_32(&pNode->freed, 1) != 0) {
+        c89atomic_fetch_add_32(&pData->errors, 1);   /* Double free. */
+    }
+
+    c89atomic_fetch_add_32(&pData->freeCount, 1);
+}
+
+static int c89atomic_hazard_test_reader(void* arg)
+{
+    c89atomic_hazard_test_data* pData = (c89atomic_hazard_test_data*)arg;
+    c89atomic_hazard_record* pRecord;
+
+    if (c89atomic_hazard_domain_acquire_record(&pData->domain, &pRecord) != C89ATOMIC_HAZARD_SUCCESS) {
+        c89atomic_fetch_add_32(&pData->errors, 1);
+        return 0;
+    }
+
+    while (c89atomic_load_explicit_32(&pData->done, c89atomic_memory_order_acquire) == 0) {
+        c89atomic_uint32 i;
+        c89atomic_hazard_test_node* pNode = (c89atomic_hazard_test_node*)c89atomic_hazard_protect(pRecord, 0, (volatile void**)&pData->pCurrent);
+
+        /* Stay on the node for a bit to give the writer a chance to retire it. */
+        for (i = 0; i < 16; i += 1) {
+            if (c89atomic_load_explicit_32(&pNode->freed, c89atomic_memory_order_relaxed) != 0 || pNode->value != (c89atomic_uint32)(pNode - pData->nodes)) {
+                c89atomic_fetch_add_32(&pData->errors, 1);
+                break;
+            }
+        }
+
+        c89atomic_hazard_clear(pRecord, 0);
+
+        if ((pNode->value & 15) == 0) {
+            c89thrd_yield();
+        }
+    }
+
+    c89atomic_hazard_domain_release_record(&pData->domain, pRecord);
+    return 0;
+}
+
+static void c89atomic_test__hazard_pointers(void)
+{
+    printf("Hazard pointers:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Protect and retire");
+    {
+        c89atomic_hazard_record records[2];
+        c89atomic_hazard_domain domain;
+        c89atomic_hazard_record* pRecord0;
+        c89atomic_hazard_record* pRecord1;
+        c89atomic_hazard_record* pRecord2;
+        c89atomic_hazard_test_data* pData = (c89atomic_hazard_test_data*)calloc(1, sizeof(*pData));
+        void* pSource;
+        c89atomic_bool success = 1;
+
+        /* More hazard pointers than the retire capacity. This is rejected before the records are touched. */
+        if (c89atomic_hazard_domain_init(records, C89ATOMIC_HAZARD_RETIRE_CAPACITY, c89atomic_hazard_test_free, pData, &domain) != C89ATOMIC_HAZARD_INVALID_ARGS) success = 0;
+
+        if (c89atomic_hazard_domain_init(records, 2, c89atomic_hazard_test_free, pData, &domain) != C89ATOMIC_HAZARD_SUCCESS) success = 0;
+        if (c89atomic_hazard_domain_acquire_record(&domain, &pRecord0) != C89ATOMIC_HAZARD_SUCCESS) success = 0;
+        if (c89atomic_hazard_domain_acquire_record(&domain, &pRecord1) != C89ATOMIC_HAZARD_SUCCESS) success = 0;
+        if (c89atomic_hazard_domain_acquire_record(&domain, &pRecord2) != C89ATOMIC_HAZARD_OUT_OF_RECORDS) success = 0;
+
+        if (success) {
+            pSource = &pData->nodes[0];
+            if (c89atomic_hazard_protect(pRecord1, 1, (volatile void**)&pSource) != &pData->nodes[0]) success = 0;
+
+            /* Protected objects must stay around. Everything else must be freed. */
+            c89atomic_hazard_retire(&domain, pRecord0, &pData->nodes[0]);
+            c89atomic_hazard_retire(&domain, pRecord0, &pData->nodes[1]);
+            if (c89atomic_hazard_reclaim(&domain, pRecord0) != 1) success = 0;
+            if (pData->nodes[0].freed != 0 || pData->nodes[1].freed != 1) success = 0;
+
+            c89atomic_hazard_clear(pRecord1, 1);
+            if (c89atomic_hazard_reclaim(&domain, pRecord0) != 0) success = 0;
+            if (pData->nodes[0].freed != 1) success = 0;
+
+            /* Objects left behind in a released record are freed when the domain is uninitialized. */
+            c89atomic_hazard_set(pRecord1, 0, &pData->nodes[2]);
+            c89atomic_hazard_retire(&domain, pRecord0, &pData->nodes[2]);
+            c89atomic_hazard_domain_release_record(&domain, pRecord0);
+            c89atomic_hazard_domain_release_record(&domain, pRecord1);
+            if (pData->nodes[2].freed != 0) success = 0;
+            c89atomic_hazard_domain_uninit(&domain);
+            if (pData->nodes[2].freed != 1 || pData->freeCount != 3 || pData->errors != 0) success = 0;
+        }
+
+        free(pData);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Reclamation (1 writer, 3 readers)");
+    {
+        c89thrd_t threads[3];
+        c89atomic_hazard_test_data* pData = (c89atomic_hazard_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_hazard_record* pRecord;
+        int threadCount = 0;
+        c89atomic_uint32 i;
+
+        for (i = 0; i < C89ATOMIC_HAZARD_TEST_NODE_COUNT; i += 1) {
+            pData->nodes[i].value = i;
+        }
+
+        pData->pCurrent = &pData->nodes[0];
+        c89atomic_hazard_domain_init(pData->records, 4, c89atomic_hazard_test_free, pData, &pData->domain);
+        c89atomic_hazard_domain_acquire_record(&pData->domain, &pRecord);
+
+        for (i = 0; i < 3; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_hazard_test_reader, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 1; i < C89ATOMIC_HAZARD_TEST_NODE_COUNT; i += 1) {
+            void* pOld = c89atomic_exchange_explicit_ptr((volatile void**)&pData->pCurrent, &pData->nodes[i], c89atomic_memory_order_acq_rel);
+            c89atomic_hazard_retire(&pData->domain, pRecord, pOld);
+
+            if ((i & 255) == 0) {
+                c89thrd_yield();
+            }
+        }
+
+        c89atomic_store_explicit_32(&pData->done, 1, c89atomic_memory_order_release);
+
+        for (i = 0; i < (c89atomic_uint32)threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        /* Memory usage must have stayed bounded. */
+        if (pData->freeCount < C89ATOMIC_HAZARD_TEST_NODE_COUNT - 1 - C89ATOMIC_HAZARD_RETIRE_CAPACITY) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        c89atomic_hazard_domain_release_record(&pData->domain, pRecord);
+        c89atomic_hazard_domain_uninit(&pData->domain);
+
+        if (threadCount == 3 && pData->errors == 0 && pData->freeCount == C89ATOMIC_HAZARD_TEST_NODE_COUNT - 1) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the epoch test. This works the same way as the hazard pointer test except readers
+use critical sections instead of protecting the node.
+*/
+#define C89ATOMIC_EPOCH_TEST_NODE_COUNT     20000
+
+typedef struct
+{
+    c89atomic_epoch_node epochNode;
+    c89atomic_uint32 value;
+    c89atomic_uint32 freed;
+} c89atomic_epoch_test_node;
+
+typedef struct
+{
+    c89atomic_epoch_domain domain;
+    c89atomic_epoch_record records[4];
+    c89atomic_epoch_test_node nodes[C89ATOMIC_EPOCH_TEST_NODE_COUNT];
+    c89atomic_epoch_test_node* pCurrent;
+    c89atomic_uint32 freeCount;
+    c89atomic_uint32 done;
+    c89atomic_uint32 errors;
+} c89atomic_epoch_test_data;
+
+static void c89atomic_epoch_test_free(void* pUserData, c89atomic_epoch_node* pEpochNode)
+{
+    c89atomic_epoch_test_data* pData = (c89atomic_epoch_test_data*)pUserData;
+    c89atomic_epoch_test_node* pNode = (c89atomic_epoch_test_node*)pEpochNode;   /* The epoch node is the first member. */
+
+    if (c89atomic_exchange_32(&pNode->freed, 1) != 0) {
+        c89atomic_fetch_add_32(&pData->errors, 1);   /* Double free. */
+    }
+
+    c89atomic_fetch_add_32(&pData->freeCount, 1);
+}
+
+static int c89atomic_epoch_test_reader(void* arg)
+{
+    c89atomic_epoch_test_data* pData = (c89atomic_epoch_test_data*)arg;
+    c89atomic_epoch_record* pRecord;
+
+    if (c89atomic_epoch_domain_acquire_record(&pData->domain, &pRecord) != C89ATOMIC_EPOCH_SUCCESS) {
+        c89atomic_fetch_add_32(&pData->errors, 1);
+        return 0;
+    }
+
+    while (c89atomic_load_explicit_32(&pData->done, c89atomic_memory_order_acquire) == 0) {
+        c89atomic_uint32 i;
+        c89atomic_epoch_test_node* pNode;
+
+        c89atomic_epoch_enter(&pData->domain, pRecord);
+        {
+            /* Look at a few nodes in the same critical section. Each of them must stay alive until we exit. */
+            for (i = 0; i < 16; i += 1) {
+                pNode = (c89atomic_epoch_test_node*)c89atomic_load_explicit_ptr((volatile void**)&pData->pCurrent, c89atomic_memory_order_acquire);
+
+                c89atomic_epoch_enter(&pData->domain, pRecord);    /* Nesting. */
+                if (c89atomic_load_explicit_32(&pNode->freed, c89atomic_memory_order_relaxed) != 0 || pNode->value != (c89atomic_uint32)(pNode - pData->nodes)) {
+                    c89atomic_fetch_add_32(&pData->errors, 1);
+                }
+                c89atomic_epoch_exit(&pData->domain, pRecord);
+            }
+        }
+        c89atomic_epoch_exit(&pData->domain, pRecord);
+
+        if ((pNode->value & 15) == 0) {
+            c89thrd_yield();
+        }
+    }
+
+    c89atomic_epoch_domain_release_record(&pData->domain, pRecord);
+    return 0;
+}
+
+static void c89atomic_test__epoch(void)
+{
+    printf("Epoch-based reclamation:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Critical sections and retire");
+    {
+        c89atomic_epoch_record records[2];
+        c89atomic_epoch_domain domain;
+        c89atomic_epoch_record* pRecord0;
+        c89atomic_epoch_record* pRecord1;
+        c89atomic_epoch_record* pRecord2;
+        c89atomic_epoch_test_data* pData = (c89atomic_epoch_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_bool success = 1;
+
+        if (c89atomic_epoch_domain_init(records, 2, c89atomic_epoch_test_free, pData, &domain) != C89ATOMIC_EPOCH_SUCCESS) success = 0;
+        if (c89atomic_epoch_domain_acquire_record(&domain, &pRecord0) != C89ATOMIC_EPOCH_SUCCESS) success = 0;
+        if (c89atomic_epoch_domain_acquire_record(&domain, &pRecord1) != C89ATOMIC_EPOCH_SUCCESS) success = 0;
+        if (c89atomic_epoch_domain_acquire_record(&domain, &pRecord2) != C89ATOMIC_EPOCH_OUT_OF_RECORDS) success = 0;
+
+        if (success) {
+            /* A thread sitting in a critical section must hold back reclamation. */
+            c89atomic_epoch_enter(&domain, pRecord1);
+            c89atomic_epoch_retire(&domain, pRecord0, &pData->nodes[0].epochNode);
+            c89atomic_epoch_reclaim(&domain, pRecord0);
+            if (c89atomic_epoch_reclaim(&domain, pRecord0) != 1 || pData->nodes[0].freed != 0) success = 0;
+
+            /* Once it leaves it takes two advances for the node to be freed. */
+            c89atomic_epoch_exit(&domain, pRecord1);
+            c89atomic_epoch_reclaim(&domain, pRecord0);
+            if (c89atomic_epoch_reclaim(&domain, pRecord0) != 0 || pData->nodes[0].freed != 1) success = 0;
+
+            /* Nodes left behind in a released record are freed when the domain is uninitialized. */
+            c89atomic_epoch_enter(&domain, pRecord1);
+            c89atomic_epoch_retire(&domain, pRecord0, &pData->nodes[1].epochNode);
+            c89atomic_epoch_domain_release_record(&domain, pRecord0);
+            c89atomic_epoch_exit(&domain, pRecord1);
+            c89atomic_epoch_domain_release_record(&domain, pRecord1);
+            if (pData->nodes[1].freed != 0) success = 0;
+            c89atomic_epoch_domain_uninit(&domain);
+            if (pData->nodes[1].freed != 1 || pData->freeCount != 2 || pData->errors != 0) success = 0;
+        }
+
+        free(pData);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Epoch wrap-around");
+    {
+        c89atomic_epoch_record records[1];
+        c89atomic_epoch_domain domain;
+        c89atomic_epoch_record* pRecord;
+        c89atomic_epoch_test_data* pData = (c89atomic_epoch_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_bool success = 1;
+        c89atomic_uint32 i;
+
+        c89atomic_epoch_domain_init(records, 1, c89atomic_epoch_test_free, pData, &domain);
+        c89atomic_epoch_domain_acquire_record(&domain, &pRecord);
+
+        /* Start just before the wrap. Nothing is in a critical section so each reclaim advances the epoch by one. */
+        domain.epoch = 0xFFFFFFFD;
+
+        for (i = 0; i < 8; i += 1) {
+            c89atomic_epoch_retire(&domain, pRecord, &pData->nodes[i].epochNode);
+
+            /* Advancing frees the node from the previous round. The one we just retired needs another advance. */
+            if (c89atomic_epoch_reclaim(&domain, pRecord) != 1 || pData->freeCount != i) success = 0;
+        }
+
+        c89atomic_epoch_domain_release_record(&domain, pRecord);
+        c89atomic_epoch_domain_uninit(&domain);
+        if (pData->freeCount != 8 || pData->errors != 0) success = 0;
+
+        free(pData);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Reclamation (1 writer, 3 readers)");
+    {
+        c89thrd_t threads[3];
+        c89atomic_epoch_test_data* pData = (c89atomic_epoch_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_epoch_record* pRecord;
+        int threadCount = 0;
+        c89atomic_uint32 i;
+
+        for (i = 0; i < C89ATOMIC_EPOCH_TEST_NODE_COUNT; i += 1) {
+            pData->nodes[i].value = i;
+        }
+
+        pData->pCurrent = &pData->nodes[0];
+        c89atomic_epoch_domain_init(pData->records, 4, c89atomic_epoch_test_free, pData, &pData->domain);
+        c89atomic_epoch_domain_acquire_record(&pData->domain, &pRecord);
+
+        for (i = 0; i < 3; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_epoch_test_reader, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 1; i < C89ATOMIC_EPOCH_TEST_NODE_COUNT; i += 1) {
+            void* pOld = c89atomic_exchange_explicit_ptr((volatile void**)&pData->pCurrent, &pData->nodes[i], c89atomic_memory_order_acq_rel);
+            c89atomic_epoch_retire(&pData->domain, pRecord, &((c89atomic_epoch_test_node*)pOld)->epochNode);
+
+            if ((i & 255) == 0) {
+                c89thrd_yield();
+            }
+        }
+
+        c89atomic_store_explicit_32(&pData->done, 1, c89atomic_memory_order_release);
+
+        for (i = 0; i < (c89atomic_uint32)threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        /* With nobody in a critical section everything must be freed after a couple of advances. */
+        c89atomic_epoch_reclaim(&pData->domain, pRecord);
+        c89atomic_epoch_reclaim(&pData->domain, pRecord);
+        if (c89atomic_epoch_reclaim(&pData->domain, pRecord) != 0) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        c89atomic_epoch_domain_release_record(&pData->domain, pRecord);
+        c89atomic_epoch_domain_uninit(&pData->domain);
+
+        if (threadCount == 3 && pData->errors == 0 && pData->freeCount == C89ATOMIC_EPOCH_TEST_NODE_COUNT - 1) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/*
+Data structure for the RCU test. A writer keeps publishing new copies of a node and readers check
+that the copy they're looking at hasn't been freed.
+*/
+#define C89ATOMIC_RCU_TEST_NODE_COUNT   10000
+
+typedef struct c89atomic_rcu_test_data c89atomic_rcu_test_data;
+
+typedef struct
+{
+    c89atomic_rcu_head head;
+    c89atomic_rcu_test_data* pData;
+    c89atomic_uint32 value;
+    c89atomic_uint32 freed;
+} c89atomic_rcu_test_node;
+
+struct c89atomic_rcu_test_data
+{
+    c89atomic_rcu_domain domain;
+    c89atomic_rcu_record records[4];
+    c89atomic_rcu_test_node nodes[C89ATOMIC_RCU_TEST_NODE_COUNT];
+    c89atomic_rcu_test_node* pCurrent;
+    c89atomic_uint32 freeCount;
+    c89atomic_uint32 done;
+    c89atomic_uint32 errors;
+};
+
+static void c89atomic_rcu_test_free(c89atomic_rcu_head* pHead)
+{
+    c89atomic_rcu_test_node* pNode = (c89atomic_rcu_test_node*)pHead;   /* The head is the first member. */
+
+    if (c89atomic_exchange_32(&pNode->freed, 1) != 0) {
+        c89atomic_fetch_add_32(&pNode->pData->errors, 1);    /* Double free. */
+    }
+
+    c89atomic_fetch_add_32(&pNode->pData->freeCount, 1);
+}
+
+static int c89atomic_rcu_test_reader(void* arg)
+{
+    c89atomic_rcu_test_data* pData = (c89atomic_rcu_test_data*)arg;
+    c89atomic_rcu_record* pRecord;
+    c89atomic_uint32 iteration = 0;
+
+    if (c89atomic_rcu_domain_acquire_record(&pData->domain, &pRecord) != C89ATOMIC_RCU_SUCCESS) {
+        c89atomic_fetch_add_32(&pData->errors, 1);
+        return 0;
+    }
+
+    while (c89atomic_load_explicit_32(&pData->done, c89atomic_memory_order_acquire) == 0) {
+        c89atomic_uint32 i;
+
+        for (i = 0; i < 16; i += 1) {
+            c89atomic_rcu_test_node* pNode = (c89atomic_rcu_test_node*)c89atomic_rcu_dereference((volatile void**)&pData->pCurrent);
+
+            if (c89atomic_load_explicit_32(&pNode->freed, c89atomic_memory_order_relaxed) != 0 || pNode->value != (c89atomic_uint32)(pNode - pData->nodes)) {
+                c89atomic_fetch_add_32(&pData->errors, 1);
+            }
+        }
+
+        c89atomic_rcu_quiescent_state(&pData->domain, pRecord);
+
+        /* Go offline every now and again to make sure writers don't wait for us while we're away. */
+        iteration += 1;
+        if ((iteration & 15) == 0) {
+            c89atomic_rcu_thread_offline(&pData->domain, pRecord);
+            c89thrd_yield();
+            c89atomic_rcu_thread_online(&pData->domain, pRecord);
+        }
+    }
+
+    c89atomic_rcu_domain_release_record(&pData->domain, pRecord);
+    return 0;
+}
+
+static void c89atomic_test__rcu(void)
+{
+    printf("RCU:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Grace periods");
+    {
+        c89atomic_rcu_record records[2];
+        c89atomic_rcu_domain domain;
+        c89atomic_rcu_record* pReader;
+        c89atomic_rcu_record* pWriter;
+        c89atomic_rcu_record* pExtra;
+        c89atomic_rcu_test_data* pData = (c89atomic_rcu_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_bool success = 1;
+
+        if (c89atomic_rcu_domain_init(records, 2, &domain) != C89ATOMIC_RCU_SUCCESS) success = 0;
+        if (c89atomic_rcu_domain_acquire_record(&domain, &pReader) != C89ATOMIC_RCU_SUCCESS) success = 0;
+        if (c89atomic_rcu_domain_acquire_record(&domain, &pWriter) != C89ATOMIC_RCU_SUCCESS) success = 0;
+        if (c89atomic_rcu_domain_acquire_record(&domain, &pExtra) != C89ATOMIC_RCU_OUT_OF_RECORDS) success = 0;
+
+        if (success) {
+            pData->nodes[0].pData = pData;
+            pData->nodes[1].pData = pData;
+
+            /* The callback must wait for the reader to pass through a quiescent state. */
+            c89atomic_rcu_call(&domain, pWriter, &pData->nodes[0].head, c89atomic_rcu_test_free);
+            if (c89atomic_rcu_poll(&domain, pWriter) != 1 || pData->nodes[0].freed != 0) success = 0;
+            c89atomic_rcu_quiescent_state(&domain, pReader);
+            if (c89atomic_rcu_poll(&domain, pWriter) != 0 || pData->nodes[0].freed != 1) success = 0;
+
+            /* Offline readers don't hold anything up. */
+            c89atomic_rcu_thread_offline(&domain, pReader);
+            c89atomic_rcu_synchronize(&domain, pWriter);
+            c89atomic_rcu_call(&domain, pWriter, &pData->nodes[1].head, c89atomic_rcu_test_free);
+            if (pData->nodes[1].freed != 1) success = 0;
+            c89atomic_rcu_thread_online(&domain, pReader);
+
+            c89atomic_rcu_domain_release_record(&domain, pReader);
+            c89atomic_rcu_domain_release_record(&domain, pWriter);
+            c89atomic_rcu_domain_uninit(&domain);
+            if (pData->freeCount != 2 || pData->errors != 0) success = 0;
+        }
+
+        free(pData);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Reclamation (1 writer, 3 readers)");
+    {
+        c89thrd_t threads[3];
+        c89atomic_rcu_test_data* pData = (c89atomic_rcu_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_rcu_record* pRecord;
+        int threadCount = 0;
+        c89atomic_uint32 i;
+
+        for (i = 0; i < C89ATOMIC_RCU_TEST_NODE_COUNT; i += 1) {
+            pData->nodes[i].pData = pData;
+            pData->nodes[i].value = i;
+        }
+
+        pData->pCurrent = &pData->nodes[0];
+        c89atomic_rcu_domain_init(pData->records, 4, &pData->domain);
+        c89atomic_rcu_domain_acquire_record(&pData->domain, &pRecord);
+
+        for (i = 0; i < 3; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_rcu_test_reader, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 1; i < C89ATOMIC_RCU_TEST_NODE_COUNT; i += 1) {
+            c89atomic_rcu_test_node* pOld = pData->pCurrent;   /* Only the writer changes this. */
+            c89atomic_rcu_assign_ptr((volatile void**)&pData->pCurrent, &pData->nodes[i]);
+
+            /* Mix synchronous and deferred reclamation. */
+            if ((i & 63) == 0) {
+                c89atomic_rcu_synchronize(&pData->domain, pRecord);
+                c89atomic_rcu_test_free(&pOld->head);
+            } else {
+                c89atomic_rcu_call(&pData->domain, pRecord, &pOld->head, c89atomic_rcu_test_free);
+            }
+
+            if ((i & 255) == 0) {
+                c89thrd_yield();
+            }
+        }
+
+        c89atomic_rcu_barrier(&pData->domain, pRecord);
+        if (pData->freeCount != C89ATOMIC_RCU_TEST_NODE_COUNT - 1) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        c89atomic_store_explicit_32(&pData->done, 1, c89atomic_memory_order_release);
+
+        for (i = 0; i < (c89atomic_uint32)threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        c89atomic_rcu_domain_release_record(&pData->domain, pRecord);
+        c89atomic_rcu_domain_uninit(&pData->domain);
+
+        if (threadCount == 3 && pData->errors == 0 && pData->freeCount == C89ATOMIC_RCU_TEST_NODE_COUNT - 1) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the stack test. Threads pop nodes off a shared free list and push them back. */
+#define C89ATOMIC_STACK_TEST_NODE_COUNT 64
+
+typedef struct
+{
+    c89atomic_stack_node node;
+    c89atomic_uint32 owned;
+} c89atomic_stack_test_node;
+
+typedef struct
+{
+    c89atomic_stack stack;
+    c89atomic_stack_test_node nodes[C89ATOMIC_STACK_TEST_NODE_COUNT];
+    c89atomic_uint32 iterations;
+    c89atomic_uint32 errors;
+} c89atomic_stack_test_data;
+
+static int c89atomic_stack_test_thread(void* arg)
+{
+    c89atomic_stack_test_data* pData = (c89atomic_stack_test_data*)arg;
+    c89atomic_stack_test_node* pHeld[4];
+    c89atomic_uint32 i;
+    c89atomic_uint32 j;
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        /* Take a few nodes so that the order of the list gets shuffled around, which is what triggers ABA problems. */
+        for (j = 0; j < 4; j += 1) {
+            pHeld[j] = (c89atomic_stack_test_node*)c89atomic_stack_pop(&pData->stack);
+
+            /* Nobody else can have this node. */
+            if (pHeld[j] != NULL && c89atomic_exchange_32(&pHeld[j]->owned, 1) != 0) {
+                c89atomic_fetch_add_32(&pData->errors, 1);
+            }
+        }
+
+        for (j = 0; j < 4; j += 1) {
+            if (pHeld[j] != NULL) {
+                c89atomic_exchange_32(&pHeld[j]->owned, 0);
+                c89atomic_stack_push(&pData->stack, &pHeld[j]->node);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__stack(void)
+{
+    printf("Stack:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Push, pop and pop all");
+    {
+        c89atomic_stack stack;
+        c89atomic_stack_node nodes[3];
+        c89atomic_stack_node* pList;
+        c89atomic_bool success = 1;
+
+        c89atomic_stack_init(&stack);
+        if (!c89atomic_stack_is_empty(&stack)) success = 0;
+        if (c89atomic_stack_pop(&stack) != NULL) success = 0;
+        if (c89atomic_stack_pop_all(&stack) != NULL) success = 0;
+
+        c89atomic_stack_push(&stack, &nodes[0]);
+        c89atomic_stack_push(&stack, &nodes[1]);
+        c89atomic_stack_push(&stack, &nodes[2]);
+        if (c89atomic_stack_is_empty(&stack)) success = 0;
+        if (c89atomic_stack_pop(&stack) != &nodes[2]) success = 0;
+
+        /* Pop all gives us the list in LIFO order. */
+        pList = c89atomic_stack_pop_all(&stack);
+        if (pList != &nodes[1] || pList->pNext != &nodes[0] || pList->pNext->pNext != NULL) success = 0;
+        if (!c89atomic_stack_is_empty(&stack)) success = 0;
+
+        /* Pushing the list back must keep the same order. */
+        c89atomic_stack_push(&stack, &nodes[2]);
+        c89atomic_stack_push_list(&stack, &nodes[1], &nodes[0]);
+        if (c89atomic_stack_pop(&stack) != &nodes[1]) success = 0;
+        if (c89atomic_stack_pop(&stack) != &nodes[0]) success = 0;
+        if (c89atomic_stack_pop(&stack) != &nodes[2]) success = 0;
+        if (c89atomic_stack_pop(&stack) != NULL) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Free list (4 threads)");
+    {
+        c89thrd_t threads[4];
+        c89atomic_stack_test_data* pData = (c89atomic_stack_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_stack_node* pNode;
+        c89atomic_uint32 count = 0;
+        int threadCount = 0;
+        int i;
+
+        c89atomic_stack_init(&pData->stack);
+        pData->iterations = 100000;
+
+        for (i = 0; i < C89ATOMIC_STACK_TEST_NODE_COUNT; i += 1) {
+            c89atomic_stack_push(&pData->stack, &pData->nodes[i].node);
+        }
+
+        for (i = 0; i < 4; i += 1) {
+            if (c89thrd_create(&threads[i], c89atomic_stack_test_thread, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        /* Every node must still be in the list exactly once. */
+        for (pNode = c89atomic_stack_pop_all(&pData->stack); pNode != NULL; pNode = pNode->pNext) {
+            c89atomic_stack_test_node* pTestNode = (c89atomic_stack_test_node*)pNode;
+            if (pTestNode->owned != 0) {
+                pData->errors += 1;
+            }
+
+            pTestNode->owned = 1;
+            count += 1;
+
+            if (count > C89ATOMIC_STACK_TEST_NODE_COUNT) {
+                break;  /* There's a loop in the list. */
+            }
+        }
+
+        if (threadCount == 4 && pData->errors == 0 && count == C89ATOMIC_STACK_TEST_NODE_COUNT) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the MPMC queue test. Each element records which producer pushed it and in what order. */
+#define C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT    2
+#define C89ATOMIC_MPMC_QUEUE_TEST_CONSUMER_COUNT    2
+#define C89ATOMIC_MPMC_QUEUE_TEST_ITEM_COUNT        100000     /* Per producer. */
+
+typedef struct
+{
+    c89atomic_uint32 producer;
+    c89atomic_uint32 index;
+} c89atomic_mpmc_queue_test_item;
+
+typedef struct
+{
+    c89atomic_mpmc_queue queue;
+    c89atomic_uint32 nextProducer;
+    c89atomic_uint32 poppedCount;
+    c89atomic_uint32 errors;
+    c89atomic_uint64 sums[C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT];
+} c89atomic_mpmc_queue_test_data;
+
+static int c89atomic_mpmc_queue_test_producer(void* arg)
+{
+    c89atomic_mpmc_queue_test_data* pData = (c89atomic_mpmc_queue_test_data*)arg;
+    c89atomic_mpmc_queue_test_item item;
+
+    item.producer = c89atomic_fetch_add_32(&pData->nextProducer, 1);
+
+    for (item.index = 0; item.index < C89ATOMIC_MPMC_QUEUE_TEST_ITEM_COUNT; item.index += 1) {
+        while (c89atomic_mpmc_queue_push(&pData->queue, &item) != C89ATOMIC_MPMC_QUEUE_SUCCESS) {
+            c89thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
+static int c89atomic_mpmc_queue_test_consumer(void* arg)
+{
+    c89atomic_mpmc_queue_test_data* pData = (c89atomic_mpmc_queue_test_data*)arg;
+    c89atomic_mpmc_queue_test_item item;
+    c89atomic_uint32 lastIndex[C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT];
+    c89atomic_uint64 sums[C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT];
+    c89atomic_uint32 iProducer;
+
+    for (iProducer = 0; iProducer < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT; iProducer += 1) {
+        lastIndex[iProducer] = 0xFFFFFFFF;
+        sums[iProducer] = 0;
+    }
+
+    while (c89atomic_load_32(&pData->poppedCount) < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT * C89ATOMIC_MPMC_QUEUE_TEST_ITEM_COUNT) {
+        if (c89atomic_mpmc_queue_pop(&pData->queue, &item) != C89ATOMIC_MPMC_QUEUE_SUCCESS) {
+            c89thrd_yield();
+            continue;
+        }
+
+        c89atomic_fetch_add_32(&pData->poppedCount, 1);
+
+        /* Items from the same producer must come out in the order they went in, even when split between consumers. */
+        if (item.producer >= C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT || (lastIndex[item.producer] != 0xFFFFFFFF && item.index <= lastIndex[item.producer])) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+            continue;
+        }
+
+        lastIndex[item.producer] = item.index;
+        sums[item.producer] += item.index;
+    }
+
+    for (iProducer = 0; iProducer < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT; iProducer += 1) {
+        c89atomic_fetch_add_64(&pData->sums[iProducer], sums[iProducer]);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__mpmc_queue(void)
+{
+    printf("MPMC Queue:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Push and pop");
+    {
+        c89atomic_uint64 buffer[8 * 2];    /* Each slot is 8 bytes for the sequence and 8 for the element. */
+        c89atomic_mpmc_queue queue;
+        c89atomic_uint32 value;
+        c89atomic_uint32 i;
+        c89atomic_bool success = 1;
+
+        if (c89atomic_mpmc_queue_get_buffer_size(8, sizeof(value)) != sizeof(buffer)) success = 0;
+        if (c89atomic_mpmc_queue_init(6, sizeof(value), buffer, &queue) != C89ATOMIC_MPMC_QUEUE_INVALID_ARGS) success = 0;
+        if (c89atomic_mpmc_queue_init(8, sizeof(value), buffer, &queue) != C89ATOMIC_MPMC_QUEUE_SUCCESS) success = 0;
+        if (c89atomic_mpmc_queue_pop(&queue, &value) != C89ATOMIC_MPMC_QUEUE_EMPTY) success = 0;
+
+        /* Go around a few times to make sure the sequence numbers carry over between laps. */
+        for (i = 0; i < 3 && success; i += 1) {
+            c89atomic_uint32 j;
+
+            for (j = 0; j < 8; j += 1) {
+                value = i*8 + j;
+                if (c89atomic_mpmc_queue_push(&queue, &value) != C89ATOMIC_MPMC_QUEUE_SUCCESS) success = 0;
+            }
+
+            if (c89atomic_mpmc_queue_push(&queue, &value) != C89ATOMIC_MPMC_QUEUE_FULL) success = 0;
+            if (c89atomic_mpmc_queue_length(&queue) != 8) success = 0;
+
+            for (j = 0; j < 8; j += 1) {
+                if (c89atomic_mpmc_queue_pop(&queue, &value) != C89ATOMIC_MPMC_QUEUE_SUCCESS || value != i*8 + j) success = 0;
+            }
+
+            if (c89atomic_mpmc_queue_pop(&queue, &value) != C89ATOMIC_MPMC_QUEUE_EMPTY) success = 0;
+            if (c89atomic_mpmc_queue_length(&queue) != 0) success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "2 producers, 2 consumers");
+    {
+        c89thrd_t threads[C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MPMC_QUEUE_TEST_CONSUMER_COUNT];
+        c89atomic_mpmc_queue_test_data* pData = (c89atomic_mpmc_queue_test_data*)calloc(1, sizeof(*pData));
+        void* pBuffer = malloc(c89atomic_mpmc_queue_get_buffer_size(64, sizeof(c89atomic_mpmc_queue_test_item)));
+        c89atomic_uint64 expectedSum = ((c89atomic_uint64)C89ATOMIC_MPMC_QUEUE_TEST_ITEM_COUNT * (C89ATOMIC_MPMC_QUEUE_TEST_ITEM_COUNT - 1)) / 2;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        /* A small capacity so the producers spend a lot of time with the queue full. */
+        c89atomic_mpmc_queue_init(64, sizeof(c89atomic_mpmc_queue_test_item), pBuffer, &pData->queue);
+
+        for (i = 0; i < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MPMC_QUEUE_TEST_CONSUMER_COUNT; i += 1) {
+            c89thrd_start_t proc = (i < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT) ? c89atomic_mpmc_queue_test_producer : c89atomic_mpmc_queue_test_consumer;
+            if (c89thrd_create(&threads[threadCount], proc, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount != C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MPMC_QUEUE_TEST_CONSUMER_COUNT || pData->errors != 0) {
+            success = 0;
+        }
+
+        /* Every item must have been popped exactly once. */
+        for (i = 0; i < C89ATOMIC_MPMC_QUEUE_TEST_PRODUCER_COUNT; i += 1) {
+            if (pData->sums[i] != expectedSum) {
+                success = 0;
+            }
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pBuffer);
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the Michael-Scott queue test. This works the same way as the MPMC queue test. */
+#define C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT  2
+#define C89ATOMIC_MS_QUEUE_TEST_CONSUMER_COUNT  2
+#define C89ATOMIC_MS_QUEUE_TEST_ITEM_COUNT      100000     /* Per producer. */
+
+typedef struct
+{
+    c89atomic_ms_queue_pool pool;
+    c89atomic_ms_queue queue;
+    c89atomic_uint32 nextProducer;
+    c89atomic_uint32 poppedCount;
+    c89atomic_uint32 errors;
+    c89atomic_uint64 sums[C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT];
+} c89atomic_ms_queue_test_data;
+
+static int c89atomic_ms_queue_test_producer(void* arg)
+{
+    c89atomic_ms_queue_test_data* pData = (c89atomic_ms_queue_test_data*)arg;
+    c89atomic_uint32 item[2];   /* Producer, index. */
+
+    item[0] = c89atomic_fetch_add_32(&pData->nextProducer, 1);
+
+    for (item[1] = 0; item[1] < C89ATOMIC_MS_QUEUE_TEST_ITEM_COUNT; item[1] += 1) {
+        while (c89atomic_ms_queue_push(&pData->queue, item) != C89ATOMIC_MS_QUEUE_SUCCESS) {
+            c89thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
+static int c89atomic_ms_queue_test_consumer(void* arg)
+{
+    c89atomic_ms_queue_test_data* pData = (c89atomic_ms_queue_test_data*)arg;
+    c89atomic_uint32 item[2];
+    c89atomic_uint32 lastIndex[C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT];
+    c89atomic_uint64 sums[C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT];
+    c89atomic_uint32 iProducer;
+
+    for (iProducer = 0; iProducer < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT; iProducer += 1) {
+        lastIndex[iProducer] = 0xFFFFFFFF;
+        sums[iProducer] = 0;
+    }
+
+    while (c89atomic_load_32(&pData->poppedCount) < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT * C89ATOMIC_MS_QUEUE_TEST_ITEM_COUNT) {
+        if (c89atomic_ms_queue_pop(&pData->queue, item) != C89ATOMIC_MS_QUEUE_SUCCESS) {
+            c89thrd_yield();
+            continue;
+        }
+
+        c89atomic_fetch_add_32(&pData->poppedCount, 1);
+
+        if (item[0] >= C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT || (lastIndex[item[0]] != 0xFFFFFFFF && item[1] <= lastIndex[item[0]])) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+            continue;
+        }
+
+        lastIndex[item[0]] = item[1];
+        sums[item[0]] += item[1];
+    }
+
+    for (iProducer = 0; iProducer < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT; iProducer += 1) {
+        c89atomic_fetch_add_64(&pData->sums[iProducer], sums[iProducer]);
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__ms_queue(void)
+{
+    printf("Michael-Scott Queue:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Push and pop");
+    {
+        c89atomic_uint64 buffer[(8 + 32 * 16) / 8];    /* 4 bytes of bitmap rounded up to 8, and 16 bytes per node. */
+        c89atomic_ms_queue_pool pool;
+        c89atomic_ms_queue queue;
+        c89atomic_ms_queue queue2;
+        c89atomic_uint32 value;
+        c89atomic_uint32 i;
+        c89atomic_bool success = 1;
+
+        if (c89atomic_ms_queue_pool_get_buffer_size(32, sizeof(value)) != sizeof(buffer)) success = 0;
+        if (c89atomic_ms_queue_pool_init(33, sizeof(value), buffer, &pool) != C89ATOMIC_MS_QUEUE_INVALID_ARGS) success = 0;
+        if (c89atomic_ms_queue_pool_init(32, sizeof(value), buffer, &pool) != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+        if (c89atomic_ms_queue_init(&pool, &queue) != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+        if (c89atomic_ms_queue_pop(&queue, &value) != C89ATOMIC_MS_QUEUE_EMPTY) success = 0;
+
+        /* One node goes to the dummy, so there's room for 31 elements. Go around a few times to recycle the nodes. */
+        for (i = 0; i < 3 && success; i += 1) {
+            c89atomic_uint32 j;
+
+            for (j = 0; j < 31; j += 1) {
+                value = i*31 + j;
+                if (c89atomic_ms_queue_push(&queue, &value) != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+            }
+
+            if (c89atomic_ms_queue_push(&queue, &value) != C89ATOMIC_MS_QUEUE_OUT_OF_MEMORY) success = 0;
+
+            for (j = 0; j < 31; j += 1) {
+                if (c89atomic_ms_queue_pop(&queue, &value) != C89ATOMIC_MS_QUEUE_SUCCESS || value != i*31 + j) success = 0;
+            }
+
+            if (c89atomic_ms_queue_pop(&queue, &value) != C89ATOMIC_MS_QUEUE_EMPTY) success = 0;
+        }
+
+        /* Uninitializing gives everything back, including what's still in the queue. */
+        value = 0;
+        c89atomic_ms_queue_push(&queue, &value);
+        c89atomic_ms_queue_uninit(&queue);
+
+        /* Two queues can share the pool. */
+        if (c89atomic_ms_queue_init(&pool, &queue)  != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+        if (c89atomic_ms_queue_init(&pool, &queue2) != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+        for (i = 0; i < 30; i += 1) {
+            if (c89atomic_ms_queue_push((i & 1) ? &queue : &queue2, &i) != C89ATOMIC_MS_QUEUE_SUCCESS) success = 0;
+        }
+        if (c89atomic_ms_queue_push(&queue, &value) != C89ATOMIC_MS_QUEUE_OUT_OF_MEMORY) success = 0;
+        if (c89atomic_ms_queue_pop(&queue2, &value) != C89ATOMIC_MS_QUEUE_SUCCESS || value != 0) success = 0;
+        if (c89atomic_ms_queue_pop(&queue,  &value) != C89ATOMIC_MS_QUEUE_SUCCESS || value != 1) success = 0;
+        c89atomic_ms_queue_uninit(&queue);
+        c89atomic_ms_queue_uninit(&queue2);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "2 producers, 2 consumers");
+    {
+        c89thrd_t threads[C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MS_QUEUE_TEST_CONSUMER_COUNT];
+        c89atomic_ms_queue_test_data* pData = (c89atomic_ms_queue_test_data*)calloc(1, sizeof(*pData));
+        void* pBuffer = malloc(c89atomic_ms_queue_pool_get_buffer_size(64, sizeof(c89atomic_uint32) * 2));
+        c89atomic_uint64 expectedSum = ((c89atomic_uint64)C89ATOMIC_MS_QUEUE_TEST_ITEM_COUNT * (C89ATOMIC_MS_QUEUE_TEST_ITEM_COUNT - 1)) / 2;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        /* A small pool so nodes get recycled quickly and producers spend time with the pool empty. */
+        c89atomic_ms_queue_pool_init(64, sizeof(c89atomic_uint32) * 2, pBuffer, &pData->pool);
+        c89atomic_ms_queue_init(&pData->pool, &pData->queue);
+
+        for (i = 0; i < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MS_QUEUE_TEST_CONSUMER_COUNT; i += 1) {
+            c89thrd_start_t proc = (i < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT) ? c89atomic_ms_queue_test_producer : c89atomic_ms_queue_test_consumer;
+            if (c89thrd_create(&threads[threadCount], proc, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount != C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT + C89ATOMIC_MS_QUEUE_TEST_CONSUMER_COUNT || pData->errors != 0) {
+            success = 0;
+        }
+
+        for (i = 0; i < C89ATOMIC_MS_QUEUE_TEST_PRODUCER_COUNT; i += 1) {
+            if (pData->sums[i] != expectedSum) {
+                success = 0;
+            }
+        }
+
+        c89atomic_ms_queue_uninit(&pData->queue);
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pBuffer);
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the MPSC queue test. Each message records which producer sent it and in what order. */
+#define C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT    4
+#define C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT     50000      /* Per producer. */
+
+typedef struct
+{
+    c89atomic_mpsc_queue_node node;
+    c89atomic_uint32 producer;
+    c89atomic_uint32 index;
+} c89atomic_mpsc_queue_test_message;
+
+typedef struct
+{
+    c89atomic_mpsc_queue queue;
+    c89atomic_mpsc_queue_test_message* pMessages;   /* C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT for each producer. */
+    c89atomic_uint32 nextProducer;
+} c89atomic_mpsc_queue_test_data;
+
+static int c89atomic_mpsc_queue_test_producer(void* arg)
+{
+    c89atomic_mpsc_queue_test_data* pData = (c89atomic_mpsc_queue_test_data*)arg;
+    c89atomic_uint32 producer = c89atomic_fetch_add_32(&pData->nextProducer, 1);
+    c89atomic_uint32 i;
+
+    for (i = 0; i < C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT; i += 1) {
+        c89atomic_mpsc_queue_test_message* pMessage = &pData->pMessages[producer * C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT + i];
+        pMessage->producer = producer;
+        pMessage->index    = i;
+
+        c89atomic_mpsc_queue_push(&pData->queue, &pMessage->node);
+
+        /* Give the consumer a chance to empty the queue now and then so the stub gets used. */
+        if ((i & 1023) == 0) {
+            c89thrd_yield();
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__mpsc_queue(void)
+{
+    printf("MPSC Queue:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Push and pop");
+    {
+        c89atomic_mpsc_queue queue;
+        c89atomic_mpsc_queue_node nodes[3];
+        c89atomic_uint32 i;
+        c89atomic_bool success = 1;
+
+        c89atomic_mpsc_queue_init(&queue);
+        if (!c89atomic_mpsc_queue_is_empty(&queue)) success = 0;
+        if (c89atomic_mpsc_queue_pop(&queue) != NULL) success = 0;
+
+        /* Go around a few times so the stub goes in and out of the queue. */
+        for (i = 0; i < 3; i += 1) {
+            c89atomic_mpsc_queue_push(&queue, &nodes[0]);
+            c89atomic_mpsc_queue_push(&queue, &nodes[1]);
+            if (c89atomic_mpsc_queue_is_empty(&queue)) success = 0;
+            if (c89atomic_mpsc_queue_pop(&queue) != &nodes[0]) success = 0;
+
+            c89atomic_mpsc_queue_push(&queue, &nodes[2]);
+            if (c89atomic_mpsc_queue_pop(&queue) != &nodes[1]) success = 0;
+            if (c89atomic_mpsc_queue_pop(&queue) != &nodes[2]) success = 0;
+            if (c89atomic_mpsc_queue_pop(&queue) != NULL) success = 0;
+            if (!c89atomic_mpsc_queue_is_empty(&queue)) success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "4 producers, 1 consumer");
+    {
+        c89thrd_t threads[C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT];
+        c89atomic_mpsc_queue_test_data data;
+        c89atomic_uint32 expectedIndices[C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT];
+        c89atomic_uint32 received = 0;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        c89atomic_mpsc_queue_init(&data.queue);
+        data.pMessages    = (c89atomic_mpsc_queue_test_message*)malloc(sizeof(*data.pMessages) * C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT * C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT);
+        data.nextProducer = 0;
+
+        for (i = 0; i < C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT; i += 1) {
+            expectedIndices[i] = 0;
+
+            if (c89thrd_create(&threads[threadCount], c89atomic_mpsc_queue_test_producer, &data) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        if (threadCount != C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT) {
+            success = 0;
+        }
+
+        /* Every producer's messages must come out in the order they went in, and none can go missing. */
+        while (received < (c89atomic_uint32)threadCount * C89ATOMIC_MPSC_QUEUE_TEST_MESSAGE_COUNT) {
+            c89atomic_mpsc_queue_test_message* pMessage = (c89atomic_mpsc_queue_test_message*)c89atomic_mpsc_queue_pop(&data.queue);
+            if (pMessage == NULL) {
+                c89thrd_yield();
+                continue;
+            }
+
+            if (pMessage->producer >= C89ATOMIC_MPSC_QUEUE_TEST_PRODUCER_COUNT || pMessage->index != expectedIndices[pMessage->producer]) {
+                success = 0;
+            } else {
+                expectedIndices[pMessage->producer] += 1;
+            }
+
+            received += 1;
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (c89atomic_mpsc_queue_pop(&data.queue) != NULL) {
+            success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(data.pMessages);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the hash map test. Threads insert their own keys while the table is resized underneath them. */
+#define C89ATOMIC_HASHMAP_TEST_THREAD_COUNT     4
+#define C89ATOMIC_HASHMAP_TEST_KEY_COUNT        1000   /* Per thread. */
+#define C89ATOMIC_HASHMAP_TEST_TABLE_COUNT      8      /* Starting at 64 slots, doubling each time. */
+
+typedef struct
+{
+    c89atomic_hashmap map;
+    c89atomic_hashmap_table tables[C89ATOMIC_HASHMAP_TEST_TABLE_COUNT];
+    c89atomic_hashmap_slot* pSlots[C89ATOMIC_HASHMAP_TEST_TABLE_COUNT];
+    c89atomic_uint32 nextThread;
+    c89atomic_uint32 errors;
+} c89atomic_hashmap_test_data;
+
+static void c89atomic_hashmap_test_grow(c89atomic_hashmap_test_data* pData)
+{
+    c89atomic_uint32 capacity = c89atomic_hashmap_get_capacity(&pData->map);
+    c89atomic_uint32 iTable;
+
+    if (c89atomic_hashmap_get_used_slot_count(&pData->map) <= capacity / 4 * 3) {
+        return;
+    }
+
+    /* The tables are set up in advance so any thread can start the resize. Only one will succeed. */
+    for (iTable = 0; iTable < C89ATOMIC_HASHMAP_TEST_TABLE_COUNT; iTable += 1) {
+        if (pData->tables[iTable].capacity > capacity) {
+            c89atomic_hashmap_begin_resize(&pData->map, &pData->tables[iTable]);
+            break;
+        }
+    }
+}
+
+static int c89atomic_hashmap_test_thread(void* arg)
+{
+    c89atomic_hashmap_test_data* pData = (c89atomic_hashmap_test_data*)arg;
+    c89atomic_uint64 firstKey = (c89atomic_uint64)c89atomic_fetch_add_32(&pData->nextThread, 1) * C89ATOMIC_HASHMAP_TEST_KEY_COUNT + 1;
+    c89atomic_uint64 key;
+
+    for (key = firstKey; key < firstKey + C89ATOMIC_HASHMAP_TEST_KEY_COUNT; key += 1) {
+        c89atomic_uint64 value;
+
+        c89atomic_hashmap_test_grow(pData);
+
+        while (c89atomic_hashmap_put(&pData->map, key, key * 3) == C89ATOMIC_HASHMAP_FULL) {
+            c89atomic_hashmap_test_grow(pData);
+            c89atomic_hashmap_migrate(&pData->map);
+        }
+
+        /* Every key we've put must still be there with the right value, no matter which table it's in. */
+        if (c89atomic_hashmap_get(&pData->map, key, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != key * 3) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        if (key > firstKey && c89atomic_hashmap_get(&pData->map, key - 1, &value) != ((key - 1) % 4 == 0 ? C89ATOMIC_HASHMAP_NOT_FOUND : C89ATOMIC_HASHMAP_SUCCESS)) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        /* Remove every 4th key so there are tombstones being moved around as well. */
+        if (key % 4 == 0) {
+            if (c89atomic_hashmap_remove(&pData->map, key) != C89ATOMIC_HASHMAP_SUCCESS) {
+                c89atomic_fetch_add_32(&pData->errors, 1);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__hashmap(void)
+{
+    printf("Hash Map:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Put, get and remove");
+    {
+        c89atomic_hashmap_slot slots[16];
+        c89atomic_hashmap_table table;
+        c89atomic_hashmap map;
+        c89atomic_uint64 value;
+        c89atomic_uint64 key;
+        c89atomic_bool success = 1;
+
+        if (c89atomic_hashmap_table_init(slots, 12, &table) != C89ATOMIC_HASHMAP_INVALID_ARGS) success = 0;
+        if (c89atomic_hashmap_table_init(slots, 16, &table) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_init(&table, &map) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+
+        if (c89atomic_hashmap_put(&map, 0, 1) != C89ATOMIC_HASHMAP_INVALID_ARGS) success = 0;
+        if (c89atomic_hashmap_put(&map, ~(c89atomic_uint64)0, 1) != C89ATOMIC_HASHMAP_INVALID_ARGS) success = 0;
+        if (c89atomic_hashmap_put(&map, 1, C89ATOMIC_HASHMAP_MAX_VALUE + 1) != C89ATOMIC_HASHMAP_INVALID_ARGS) success = 0;
+        if (c89atomic_hashmap_get(&map, 1, &value) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+
+        if (c89atomic_hashmap_put(&map, 1, 0) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_get(&map, 1, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != 0) success = 0;
+        if (c89atomic_hashmap_put(&map, 1, C89ATOMIC_HASHMAP_MAX_VALUE) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_get(&map, 1, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != C89ATOMIC_HASHMAP_MAX_VALUE) success = 0;
+
+        if (c89atomic_hashmap_remove(&map, 1) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_remove(&map, 1) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+        if (c89atomic_hashmap_get(&map, 1, &value) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+
+        /* Putting a removed key back reuses its slot. Fill up the rest of the table. */
+        for (key = 1; key <= 16; key += 1) {
+            if (c89atomic_hashmap_put(&map, key, key + 100) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        }
+        if (c89atomic_hashmap_get_used_slot_count(&map) != 16) success = 0;
+        if (c89atomic_hashmap_put(&map, 17, 0) != C89ATOMIC_HASHMAP_FULL) success = 0;
+        if (c89atomic_hashmap_get(&map, 17, &value) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+        if (c89atomic_hashmap_remove(&map, 17) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+
+        for (key = 1; key <= 16; key += 1) {
+            if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != key + 100) success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Incremental resize");
+    {
+        c89atomic_hashmap_slot* pSlots = (c89atomic_hashmap_slot*)malloc(sizeof(*pSlots) * (256 + 1024));
+        c89atomic_hashmap_table table;
+        c89atomic_hashmap_table newTable;
+        c89atomic_hashmap map;
+        c89atomic_uint64 value;
+        c89atomic_uint64 key;
+        c89atomic_uint32 migrateCount = 0;
+        c89atomic_bool success = 1;
+
+        c89atomic_hashmap_table_init(pSlots, 256, &table);
+        c89atomic_hashmap_table_init(pSlots + 256, 1024, &newTable);
+        c89atomic_hashmap_init(&table, &map);
+
+        for (key = 1; key <= 200; key += 1) {
+            c89atomic_hashmap_put(&map, key, key);
+        }
+        c89atomic_hashmap_remove(&map, 100);
+
+        if (c89atomic_hashmap_begin_resize(&map, &newTable) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_begin_resize(&map, &newTable) != C89ATOMIC_HASHMAP_BUSY) success = 0;
+
+        /* Move some of the table. Everything needs to be found while it's halfway between the two. */
+        c89atomic_hashmap_migrate(&map);
+        c89atomic_hashmap_migrate(&map);
+
+        for (key = 1; key <= 200; key += 1) {
+            if (c89atomic_hashmap_get(&map, key, &value) != (key == 100 ? C89ATOMIC_HASHMAP_NOT_FOUND : C89ATOMIC_HASHMAP_SUCCESS)) success = 0;
+        }
+
+        /* Now make changes. These will also help finish the resize. */
+
+        for (key = 1; key <= 200; key += 2) {
+            c89atomic_hashmap_put(&map, key, key * 2);  /* Replace. */
+        }
+        for (key = 201; key <= 400; key += 1) {
+            c89atomic_hashmap_put(&map, key, key * 2);  /* Insert. */
+        }
+        c89atomic_hashmap_remove(&map, 50);
+        c89atomic_hashmap_remove(&map, 300);
+
+        while (c89atomic_hashmap_migrate(&map)) {
+            migrateCount += 1;
+        }
+
+        if (c89atomic_hashmap_get_capacity(&map) != 1024) success = 0;
+        if (migrateCount > 256 / C89ATOMIC_HASHMAP_MIGRATE_CHUNK_SIZE) success = 0;
+
+        for (key = 1; key <= 400; key += 1) {
+            c89atomic_hashmap_result result = c89atomic_hashmap_get(&map, key, &value);
+
+            if (key == 50 || key == 100 || key == 300) {
+                if (result != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+            } else {
+                c89atomic_uint64 expected = (key > 200 || (key & 1) != 0) ? key * 2 : key;
+                if (result != C89ATOMIC_HASHMAP_SUCCESS || value != expected) success = 0;
+            }
+        }
+
+        /* Key 100 was removed before the resize so it wasn't moved over. The others were removed afterwards and keep their slots. */
+        if (c89atomic_hashmap_get_used_slot_count(&map) != 399) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pSlots);
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Inserting during a tight resize");
+    {
+        c89atomic_hashmap_slot* pSlots = (c89atomic_hashmap_slot*)malloc(sizeof(*pSlots) * (2048 + 1024));
+        c89atomic_hashmap_table table;
+        c89atomic_hashmap_table newTable;
+        c89atomic_hashmap map;
+        c89atomic_hashmap_result result;
+        c89atomic_uint64 value;
+        c89atomic_uint64 key;
+        c89atomic_uint32 insertedCount = 0;
+        c89atomic_bool success = 1;
+
+        c89atomic_hashmap_table_init(pSlots, 2048, &table);
+        c89atomic_hashmap_table_init(pSlots + 2048, 1024, &newTable);
+        c89atomic_hashmap_init(&table, &map);
+
+        for (key = 1; key <= 1000; key += 1) {
+            c89atomic_hashmap_put(&map, key, key);
+        }
+
+        /*
+        The new table is only just big enough for what's in the old one. New keys go straight into the new
+        table so they must not take the room that's needed for the keys that haven't been moved yet.
+        */
+        if (c89atomic_hashmap_begin_resize(&map, &newTable) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+
+        for (key = 1001; key <= 1100; key += 1) {
+            result = c89atomic_hashmap_put(&map, key, key);
+
+            if (result == C89ATOMIC_HASHMAP_SUCCESS) {
+                insertedCount += 1;
+                if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != key) success = 0;
+            } else if (result != C89ATOMIC_HASHMAP_FULL) {
+                success = 0;
+            }
+        }
+
+        if (c89atomic_hashmap_migrate(&map)) success = 0;
+        if (insertedCount != 1024 - 1000) success = 0;
+
+        for (key = 1; key <= 1000; key += 1) {
+            if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != key) success = 0;
+        }
+
+        if (c89atomic_hashmap_get_used_slot_count(&map) != 1024) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pSlots);
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Frozen empty slot can't be taken");
+    {
+        c89atomic_hashmap_slot* pSlots = (c89atomic_hashmap_slot*)malloc(sizeof(*pSlots) * (256 + 1024));
+        c89atomic_hashmap_table table;
+        c89atomic_hashmap_table newTable;
+        c89atomic_hashmap map;
+        c89atomic_uint64 value;
+        c89atomic_uint64 key;
+        c89atomic_uint64 collidingKey;
+        c89atomic_uint64 expectedKey = 0;
+        c89atomic_uint32 index;
+        c89atomic_bool success = 1;
+
+        c89atomic_hashmap_table_init(pSlots, 256, &table);
+        c89atomic_hashmap_table_init(pSlots + 256, 1024, &newTable);
+        c89atomic_hashmap_init(&table, &map);
+
+        /* Pick a key that lands past the first chunk so that putting it doesn't get its slot migrated first. */
+        for (key = 1; c89atomic_hashmap_hash(key, 256) < 128; key += 1) {
+        }
+
+        index = c89atomic_hashmap_hash(key, 256);
+        for (collidingKey = key + 1; c89atomic_hashmap_hash(collidingKey, 256) != index; collidingKey += 1) {
+        }
+
+        /* The key goes into the new table, freezing the empty slot it would have had in the old one. */
+        c89atomic_hashmap_begin_resize(&map, &newTable);
+        if (c89atomic_hashmap_put(&map, key, 1) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+
+        /*
+        A writer that hasn't noticed the resize yet would try to take the slot for the colliding key. That must
+        fail, or lookups for the first key would probe straight past the slot and give up at the next empty one.
+        */
+        if (c89atomic_compare_exchange_strong_64(&pSlots[index].key, &expectedKey, collidingKey)) success = 0;
+
+        if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != 1) success = 0;
+        if (c89atomic_hashmap_put(&map, collidingKey, 2) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_remove(&map, key) != C89ATOMIC_HASHMAP_SUCCESS) success = 0;
+        if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+
+        while (c89atomic_hashmap_migrate(&map)) {
+        }
+
+        if (c89atomic_hashmap_get(&map, key, &value) != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+        if (c89atomic_hashmap_get(&map, collidingKey, &value) != C89ATOMIC_HASHMAP_SUCCESS || value != 2) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pSlots);
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Resize while writing (4 threads)");
+    {
+        c89thrd_t threads[C89ATOMIC_HASHMAP_TEST_THREAD_COUNT];
+        c89atomic_hashmap_test_data* pData = (c89atomic_hashmap_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_uint64 key;
+        c89atomic_uint64 value;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        for (i = 0; i < C89ATOMIC_HASHMAP_TEST_TABLE_COUNT; i += 1) {
+            c89atomic_uint32 capacity = 64 << i;
+            pData->pSlots[i] = (c89atomic_hashmap_slot*)malloc(sizeof(c89atomic_hashmap_slot) * capacity);
+            c89atomic_hashmap_table_init(pData->pSlots[i], capacity, &pData->tables[i]);
+        }
+
+        c89atomic_hashmap_init(&pData->tables[0], &pData->map);
+
+        for (i = 0; i < C89ATOMIC_HASHMAP_TEST_THREAD_COUNT; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_hashmap_test_thread, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount != C89ATOMIC_HASHMAP_TEST_THREAD_COUNT || pData->errors != 0) {
+            success = 0;
+        }
+
+        /* We should have gone through a few resizes. */
+        if (c89atomic_hashmap_get_capacity(&pData->map) < 2048) {
+            success = 0;
+        }
+
+        for (key = 1; key <= C89ATOMIC_HASHMAP_TEST_THREAD_COUNT * C89ATOMIC_HASHMAP_TEST_KEY_COUNT; key += 1) {
+            c89atomic_hashmap_result result = c89atomic_hashmap_get(&pData->map, key, &value);
+
+            if (key % 4 == 0) {
+                if (result != C89ATOMIC_HASHMAP_NOT_FOUND) success = 0;
+            } else {
+                if (result != C89ATOMIC_HASHMAP_SUCCESS || value != key * 3) success = 0;
+            }
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        for (i = 0; i < C89ATOMIC_HASHMAP_TEST_TABLE_COUNT; i += 1) {
+            free(pData->pSlots[i]);
+        }
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+/* Data structure for the skip list test. Every thread tries to insert and remove the same keys, each with its own nodes. */
+#define C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT    4
+#define C89ATOMIC_SKIPLIST_TEST_KEY_COUNT       2000
+#define C89ATOMIC_SKIPLIST_TEST_REINSERT_COUNT  20000   /* Per thread. Each one uses a node. */
+
+typedef struct
+{
+    c89atomic_skiplist list;
+    c89atomic_skiplist_node* pNodes;    /* C89ATOMIC_SKIPLIST_TEST_KEY_COUNT per thread. */
+    c89atomic_uint32 nextThread;
+    c89atomic_uint32 insertedCount;
+    c89atomic_uint32 removedCount;
+    c89atomic_uint32 retiredCount;
+    c89atomic_uint32 errors;
+} c89atomic_skiplist_test_data;
+
+static void c89atomic_skiplist_test_retire(void* pUserData, c89atomic_skiplist_node* pNode)
+{
+    (void)pNode;
+    c89atomic_fetch_add_32((c89atomic_uint32*)pUserData, 1);
+}
+
+/* Whether or not a node can be got to from the head of the list on any level. Removed nodes that haven't been unlinked yet count. */
+static c89atomic_bool c89atomic_skiplist_test_is_reachable(c89atomic_skiplist* pList, c89atomic_skiplist_node* pNode)
+{
+    c89atomic_uint32 level;
+
+    for (level = 0; level < C89ATOMIC_SKIPLIST_MAX_HEIGHT; level += 1) {
+        c89atomic_skiplist_node* pCurr = &pList->head;
+
+        for (;;) {
+            /* Clear the removed bit. */
+            pCurr = (c89atomic_skiplist_node*)((c89atomic_uintptr)c89atomic_load_ptr((volatile void**)&pCurr->pNext[level]) & ~(c89atomic_uintptr)1);
+            if (pCurr == NULL) {
+                break;
+            }
+
+            if (pCurr == pNode) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Used by the reinsertion test. A node must not be reachable from any level by the time it's retired. */
+static void c89atomic_skiplist_test_retire_unreachable(void* pUserData, c89atomic_skiplist_node* pNode)
+{
+    c89atomic_skiplist_test_data* pData = (c89atomic_skiplist_test_data*)pUserData;
+
+    if (c89atomic_skiplist_test_is_reachable(&pData->list, pNode)) {
+        c89atomic_fetch_add_32(&pData->errors, 1);
+    }
+
+    c89atomic_fetch_add_32(&pData->retiredCount, 1);
+}
+
+/* Every thread inserts and removes the same handful of keys so that removed nodes keep getting new nodes with the same key put in front of them. */
+static int c89atomic_skiplist_test_reinsert_thread(void* arg)
+{
+    c89atomic_skiplist_test_data* pData = (c89atomic_skiplist_test_data*)arg;
+    c89atomic_skiplist_node* pNodes = pData->pNodes + c89atomic_fetch_add_32(&pData->nextThread, 1) * C89ATOMIC_SKIPLIST_TEST_REINSERT_COUNT;
+    c89atomic_uint32 iNode;
+
+    for (iNode = 0; iNode < C89ATOMIC_SKIPLIST_TEST_REINSERT_COUNT; iNode += 1) {
+        c89atomic_uint64 key = iNode % 2;
+
+        if (c89atomic_skiplist_insert(&pData->list, key, &pNodes[iNode]) == C89ATOMIC_SKIPLIST_SUCCESS) {
+            c89atomic_fetch_add_32(&pData->insertedCount, 1);
+        }
+
+        if (c89atomic_skiplist_remove(&pData->list, key) == C89ATOMIC_SKIPLIST_SUCCESS) {
+            c89atomic_fetch_add_32(&pData->removedCount, 1);
+        }
+    }
+
+    return 0;
+}
+
+static int c89atomic_skiplist_test_thread(void* arg)
+{
+    c89atomic_skiplist_test_data* pData = (c89atomic_skiplist_test_data*)arg;
+    c89atomic_skiplist_node* pNodes = pData->pNodes + c89atomic_fetch_add_32(&pData->nextThread, 1) * C89ATOMIC_SKIPLIST_TEST_KEY_COUNT;
+    c89atomic_uint32 iKey;
+
+    for (iKey = 0; iKey < C89ATOMIC_SKIPLIST_TEST_KEY_COUNT; iKey += 1) {
+        /* Spread the keys out so threads aren't always fighting over the end of the list. */
+        c89atomic_uint64 key = (iKey * 7919) % C89ATOMIC_SKIPLIST_TEST_KEY_COUNT;
+        c89atomic_skiplist_node* pFound;
+
+        if (c89atomic_skiplist_insert(&pData->list, key, &pNodes[iKey]) == C89ATOMIC_SKIPLIST_SUCCESS) {
+            c89atomic_fetch_add_32(&pData->insertedCount, 1);
+        }
+
+        /* Whoever won, the key needs to be there now unless it's already been removed. */
+        pFound = c89atomic_skiplist_find(&pData->list, key);
+        if ((pFound == NULL && key % 3 != 0) || (pFound != NULL && pFound->key != key)) {
+            c89atomic_fetch_add_32(&pData->errors, 1);
+        }
+
+        /* Remove every 3rd key. Only one thread can succeed for each node that was inserted. */
+        if (key % 3 == 0) {
+            if (c89atomic_skiplist_remove(&pData->list, key) == C89ATOMIC_SKIPLIST_SUCCESS) {
+                c89atomic_fetch_add_32(&pData->removedCount, 1);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void c89atomic_test__skiplist(void)
+{
+    printf("Skip List:\n");
+
+    printf("    %-*s", PRINT_WIDTH, "Insert, find and remove");
+    {
+        c89atomic_skiplist list;
+        c89atomic_skiplist_node nodes[100];
+        c89atomic_skiplist_node extra;
+        c89atomic_skiplist_node* pNode;
+        c89atomic_uint32 retiredCount = 0;
+        c89atomic_uint64 expectedKey;
+        c89atomic_bool success = 1;
+        int i;
+
+        if (c89atomic_skiplist_init(c89atomic_skiplist_test_retire, &retiredCount, &list) != C89ATOMIC_SKIPLIST_SUCCESS) success = 0;
+        if (c89atomic_skiplist_first(&list) != NULL) success = 0;
+
+        /* Insert out of order. Key 0 is allowed. */
+        for (i = 0; i < 100; i += 1) {
+            if (c89atomic_skiplist_insert(&list, (i * 37) % 100, &nodes[i]) != C89ATOMIC_SKIPLIST_SUCCESS) success = 0;
+        }
+
+        if (c89atomic_skiplist_insert(&list, 37, &extra) != C89ATOMIC_SKIPLIST_ALREADY_EXISTS) success = 0;
+        if (c89atomic_skiplist_find(&list, 37) != &nodes[1]) success = 0;
+        if (c89atomic_skiplist_find(&list, 0) != &nodes[0]) success = 0;
+        if (c89atomic_skiplist_find(&list, 100) != NULL) success = 0;
+
+        /* Remove the odd keys. */
+        for (i = 1; i < 100; i += 2) {
+            if (c89atomic_skiplist_remove(&list, (c89atomic_uint64)i) != C89ATOMIC_SKIPLIST_SUCCESS) success = 0;
+        }
+
+        if (c89atomic_skiplist_remove(&list, 1) != C89ATOMIC_SKIPLIST_NOT_FOUND) success = 0;
+        if (c89atomic_skiplist_find(&list, 37) != NULL) success = 0;
+        if (retiredCount != 50) success = 0;
+
+        /* What's left should be the even keys in order. */
+        expectedKey = 0;
+        for (pNode = c89atomic_skiplist_first(&list); pNode != NULL; pNode = c89atomic_skiplist_next(&list, pNode)) {
+            if (pNode->key != expectedKey) success = 0;
+            expectedKey += 2;
+        }
+
+        if (expectedKey != 100) success = 0;
+
+        /* A removed key can be inserted again with a different node. */
+        if (c89atomic_skiplist_insert(&list, 37, &extra) != C89ATOMIC_SKIPLIST_SUCCESS) success = 0;
+        if (c89atomic_skiplist_find(&list, 37) != &extra) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Range iteration");
+    {
+        c89atomic_skiplist list;
+        c89atomic_skiplist_node nodes[50];
+        c89atomic_skiplist_node* pNode;
+        c89atomic_uint64 expectedKey;
+        c89atomic_bool success = 1;
+        int i;
+
+        c89atomic_skiplist_init(NULL, NULL, &list);
+
+        /* Keys 10, 20, ..., 500. */
+        for (i = 0; i < 50; i += 1) {
+            c89atomic_skiplist_insert(&list, (c89atomic_uint64)(i + 1) * 10, &nodes[i]);
+        }
+
+        /* Everything from 95 up to but not including 200. */
+        expectedKey = 100;
+        for (pNode = c89atomic_skiplist_lower_bound(&list, 95); pNode != NULL && pNode->key < 200; pNode = c89atomic_skiplist_next(&list, pNode)) {
+            if (pNode->key != expectedKey) success = 0;
+            expectedKey += 10;
+        }
+
+        if (expectedKey != 200) success = 0;
+
+        if (c89atomic_skiplist_lower_bound(&list, 0) != &nodes[0]) success = 0;
+        if (c89atomic_skiplist_lower_bound(&list, 500) != &nodes[49]) success = 0;
+        if (c89atomic_skiplist_lower_bound(&list, 501) != NULL) success = 0;
+
+        /* Iterating on from a node that has been removed should carry on from where it was. */
+        pNode = c89atomic_skiplist_find(&list, 300);
+        c89atomic_skiplist_remove(&list, 300);
+        c89atomic_skiplist_remove(&list, 310);
+        if (pNode == NULL || c89atomic_skiplist_next(&list, pNode) != &nodes[31]) success = 0;
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Insert and remove (4 threads)");
+    {
+        c89thrd_t threads[C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT];
+        c89atomic_skiplist_test_data* pData = (c89atomic_skiplist_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_skiplist_node* pNode;
+        c89atomic_uint64 expectedKey;
+        c89atomic_uint32 count;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        pData->pNodes = (c89atomic_skiplist_node*)malloc(sizeof(c89atomic_skiplist_node) * C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT * C89ATOMIC_SKIPLIST_TEST_KEY_COUNT);
+        c89atomic_skiplist_init(c89atomic_skiplist_test_retire, &pData->retiredCount, &pData->list);
+
+        for (i = 0; i < C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_skiplist_test_thread, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        if (threadCount != C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT || pData->errors != 0) {
+            success = 0;
+        }
+
+        /* Every removed node has been retired exactly once. */
+        if (pData->removedCount != pData->retiredCount) {
+            success = 0;
+        }
+
+        /* Whatever is left must be in order with no duplicates. Keys that are never removed must all be there. */
+        expectedKey = 0;
+        count = 0;
+        for (pNode = c89atomic_skiplist_first(&pData->list); pNode != NULL; pNode = c89atomic_skiplist_next(&pData->list, pNode)) {
+            for (; expectedKey < pNode->key; expectedKey += 1) {
+                if (expectedKey % 3 != 0) success = 0;
+            }
+
+            if (pNode->key != expectedKey) success = 0;
+            expectedKey += 1;
+            count += 1;
+        }
+
+        for (; expectedKey < C89ATOMIC_SKIPLIST_TEST_KEY_COUNT; expectedKey += 1) {
+            if (expectedKey % 3 != 0) success = 0;
+        }
+
+        /* A removed key can be inserted again by a slower thread, so we can't know exactly how many there will be. */
+        if (count != pData->insertedCount - pData->removedCount) {
+            success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData->pNodes);
+        free(pData);
+    }
+
+    /*
+    An insert can link its node in front of a removed node with the same key on an upper level. This happens when
+    it searched that level before the node was removed. Set that up by hand and make sure the removed node still
+    gets unlinked everywhere.
+    */
+    printf("    %-*s", PRINT_WIDTH, "Unlinking behind a same-key node");
+    {
+        c89atomic_skiplist list;
+        c89atomic_skiplist_node nodes[64];
+        c89atomic_skiplist_node* pRemoved = NULL;
+        c89atomic_skiplist_node* pInserted = &nodes[0];
+        c89atomic_uint32 level;
+        c89atomic_bool success = 1;
+        int i;
+
+        c89atomic_skiplist_init(NULL, NULL, &list);
+
+        /* The removed node needs to be on at least 2 levels. */
+        for (i = 1; i < 64 && pRemoved == NULL; i += 1) {
+            if (c89atomic_skiplist_pick_height(5, &nodes[i]) >= 2) {
+                pRemoved = &nodes[i];
+            }
+        }
+
+        if (pRemoved == NULL || c89atomic_skiplist_insert(&list, 5, pRemoved) != C89ATOMIC_SKIPLIST_SUCCESS) {
+            success = 0;
+        } else {
+            /* Removing marks every level, top down. */
+            for (level = pRemoved->height; level > 0; level -= 1) {
+                pRemoved->pNext[level - 1] = (c89atomic_skiplist_node*)((c89atomic_uintptr)pRemoved->pNext[level - 1] | 1);
+            }
+
+            /*
+            The insert unlinked the removed node from the bottom level before linking in its own, but on level 1 it
+            still had the removed node as the successor from before it was marked.
+            */
+            pInserted->key      = 5;
+            pInserted->height   = 2;
+            pInserted->refs     = 1;
+            pInserted->pNext[0] = NULL;
+            pInserted->pNext[1] = pRemoved;
+            list.head.pNext[0]  = pInserted;
+            list.head.pNext[1]  = pInserted;
+
+            c89atomic_skiplist_unlink(&list, pRemoved);
+
+            if (c89atomic_skiplist_test_is_reachable(&list, pRemoved)) success = 0;
+            if (c89atomic_skiplist_find(&list, 5) != pInserted) success = 0;
+            if (list.head.pNext[1] != pInserted || pInserted->pNext[1] != NULL) success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+    }
+
+    printf("    %-*s", PRINT_WIDTH, "Reinserting removed keys (4 threads)");
+    {
+        c89thrd_t threads[C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT];
+        c89atomic_skiplist_test_data* pData = (c89atomic_skiplist_test_data*)calloc(1, sizeof(*pData));
+        c89atomic_skiplist_node* pNode;
+        c89atomic_uint32 count;
+        c89atomic_bool success = 1;
+        int threadCount = 0;
+        int i;
+
+        pData->pNodes = (c89atomic_skiplist_node*)malloc(sizeof(c89atomic_skiplist_node) * C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT * C89ATOMIC_SKIPLIST_TEST_REINSERT_COUNT);
+        c89atomic_skiplist_init(c89atomic_skiplist_test_retire_unreachable, pData, &pData->list);
+
+        for (i = 0; i < C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT; i += 1) {
+            if (c89thrd_create(&threads[threadCount], c89atomic_skiplist_test_reinsert_thread, pData) == c89thrd_success) {
+                threadCount += 1;
+            }
+        }
+
+        for (i = 0; i < threadCount; i += 1) {
+            c89thrd_join(threads[i], NULL);
+        }
+
+        /* The retire callback counts an error for every node it could still get to. */
+        if (threadCount != C89ATOMIC_SKIPLIST_TEST_THREAD_COUNT || pData->errors != 0) {
+            success = 0;
+        }
+
+        if (pData->removedCount != pData->retiredCount) {
+            success = 0;
+        }
+
+        count = 0;
+        for (pNode = c89atomic_skiplist_first(&pData->list); pNode != NULL; pNode = c89atomic_skiplist_next(&pData->list, pNode)) {
+            count += 1;
+        }
+
+        if (count != pData->insertedCount - pData->removedCount) {
+            success = 0;
+        }
+
+        if (success) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        free(pData->pNodes);
+        free(pData);
+    }
+
+    printf("\n");
+}
+
+
+int main(int argc, char** argv)
+{
+    enable_colored_output();
+
+    /* The size of basic types must be valid. If not, the architecture/compiler/platform is not supported. */
+    c89atomic_test__basic__sizeof();
+    if (g_ErrorCount > 0) {
+        printf("Tests cannot continue because the size of one or more basic types are not valid.\n");
+        return 1;
+    }
+
+    c89atomic_test__basic__flag_test_and_set();
+    c89atomic_test__basic__flag_clear();
+    c89atomic_test__basic__flag_load();
+    c89atomic_test__basic__load();
+    c89atomic_test__basic__store();
+    c89atomic_test__basic__exchange();
+    c89atomic_test__basic__compare_exchange_strong();
+    c89atomic_test__basic__compare_exchange_weak();
+    c89atomic_test__basic__fetch_add();
+    c89atomic_test__basic__fetch_sub();
+    c89atomic_test__basic__fetch_or();
+    c89atomic_test__basic__fetch_xor();
+    c89atomic_test__basic__fetch_and();
+    c89atomic_test__basic__compare_and_swap();
+
+    printf("c89atomic_is_lock_free_8  = %s\n", c89atomic_is_lock_free_8(NULL)  ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
+    printf("c89atomic_is_lock_free_16 = %s\n", c89atomic_is_lock_free_16(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
+    printf("c89atomic_is_lock_free_32 = %s\n", c89atomic_is_lock_free_32(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
+    printf("c89atomic_is_lock_free_64 = %s\n", c89atomic_is_lock_free_64(NULL) ? "\033[32mTRUE\033[0m" : "\033[31mFALSE\033[0m");
+
+    /* Putting these functions here for testing that they compile. */
+    c89atomic_thread_fence(c89atomic_memory_order_seq_cst);
+    c89atomic_signal_fence(c89atomic_memory_order_seq_cst);
+
+    /* Testing cases where the return value is not used. */
+    {
+        void* dst = NULL;
+        void* src = NULL;
+        c89atomic_exchange_ptr(&dst, src);
+        c89atomic_compare_exchange_strong_ptr(&dst, &dst, src);
+    }
+
+    {
+        c89atomic_uint64 dst = 0;
+        c89atomic_uint64 src = 1;
+        c89atomic_exchange_64(&dst, src);
+    }
+
+    /* Testing that some basic integer versions are working without compilation errors. */
+    {
+        int dst = 0;
+        int src = 1;
+        int res = c89atomic_exchange_i32(&dst, src);
+        (void)res;
+    }
+
+    /* Basic floating point tests. */
+    {
+        float dst = 1.0f;
+        float src = 2.0f;
+        float res = c89atomic_exchange_f32(&dst, src);
+        (void)res;
+
+        res = c89atomic_load_f32(&dst);
+        (void)res;
+    }
+
+    {
+        double dst = 1.0f;
+        double src = 2.0f;
+        double res = c89atomic_exchange_f64(&dst, src);
+        (void)res;
+
+        res = c89atomic_load_f64(&dst);
+        (void)res;
+    }
+
+
+    /* Basic deque tests. Not currently testing for multi-threaded correctness. */
+    {
+        c89atomic_deque_result result;
+        c89atomic_deque deque;
+        void* pValue = (void*)123456;
+
+        c89atomic_deque_init(&deque);
+
+        /* First thing to test is to take from the tail while the deque is empty. Want to test for wrap around bugs due to 1 being subtracted from 0. */
+        printf("\n");
+        printf("Deque Take Tail (Empty): ");
+        result = c89atomic_deque_take_tail(&deque, &pValue);
+        if (result == C89ATOMIC_DEQUE_NO_DATA_AVAILABLE) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        printf("Deque Take Head (Empty): ");
+        result = c89atomic_deque_take_head(&deque, &pValue);
+        if (result == C89ATOMIC_DEQUE_NO_DATA_AVAILABLE) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        printf("Deque Push Tail:         ");
+        result = c89atomic_deque_push_tail(&deque, (void*)1);
+        if (result == C89ATOMIC_DEQUE_SUCCESS) {
+            result = c89atomic_deque_push_tail(&deque, (void*)2);
+            if (result == C89ATOMIC_DEQUE_SUCCESS) {
+                result = c89atomic_deque_push_tail(&deque, (void*)3);
+                if (result == C89ATOMIC_DEQUE_SUCCESS) {
+                    c89atomic_test_passed();
+                } else {
+                    c89atomic_test_failed();
+                }
+            } else {
+                c89atomic_test_failed();
+            }
+        } else {
+            c89atomic_test_failed();
+        }
+        
+
+        /* Take from the tail. Expecting "3". */
+        printf("Deque Take Tail:         ");
+        result = c89atomic_deque_take_tail(&deque, &pValue);
+        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)3) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        /* Steal from the head. Expecting "1". */
+        printf("Deque Take Head:         ");
+        result = c89atomic_deque_take_head(&deque, &pValue);
+        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)1) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        /* Take last item. */
+        printf("Deque Take Tail (Last):  ");
+        result = c89atomic_deque_take_tail(&deque, &pValue);
+        if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)2) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        /* Now the deque should be empty. */
+        printf("Deque Empty:             ");
+        if (deque.head == deque.tail) {
+            c89atomic_test_passed();
+        } else {
+            c89atomic_test_failed();
+        }
+
+        /* Now we're going to take the last item from the head. We'll need to push a fresh item. */
+        printf("Deque Take Head (Last):  ");
+        result = c89atomic_deque_push_tail(&deque, (void*)4);
         if (result == C89ATOMIC_DEQUE_SUCCESS) {
             result = c89atomic_deque_take_head(&deque, &pValue);
             if (result == C89ATOMIC_DEQUE_SUCCESS && pValue == (void*)4) {
@@ -1116,6 +4683,72 @@ int main(int argc, char** argv)
     printf("\n");
     c89atomic_test__ring_buffer();
 
+    /* Spinlock tests. */
+    c89atomic_test__spinlock();
+
+    /* Wait/notify tests. */
+    c89atomic_test__wait();
+
+    /* 128-bit tests. */
+    c89atomic_test__128();
+
+    /* Floating point tests. */
+    c89atomic_test__float();
+
+    /* Min/max tests. */
+    c89atomic_test__minmax();
+
+    /* Read-modify-write tests. */
+    c89atomic_test__rmw();
+
+    /* Bit test tests. */
+    c89atomic_test__bit();
+
+    /* Memory ordering tests. */
+    c89atomic_test__ordering();
+
+    /* Backend info tests. */
+    c89atomic_test__backend_info();
+
+    /* Seqlock tests. */
+    c89atomic_test__seqlock();
+
+    /* Reader-writer lock tests. */
+    c89atomic_test__rwlock();
+
+    /* Counter tests. */
+    c89atomic_test__counter();
+
+    /* Pointer tests. */
+    c89atomic_test__tagged_ptr();
+
+    /* Hazard pointer tests. */
+    c89atomic_test__hazard_pointers();
+
+    /* Epoch-based reclamation tests. */
+    c89atomic_test__epoch();
+
+    /* RCU tests. */
+    c89atomic_test__rcu();
+
+    /* Stack tests. */
+    c89atomic_test__stack();
+
+    /* MPMC queue tests. */
+    c89atomic_test__mpmc_queue();
+
+    /* Michael-Scott queue tests. */
+    c89atomic_test__ms_queue();
+
+    /* MPSC queue tests. */
+    c89atomic_test__mpsc_queue();
+
+    /* Hash map tests. */
+    c89atomic_test__hashmap();
+
+    /* Skip list tests. */
+    c89atomic_test__skiplist();
+
 
     (void)argc;
     (void)argv;
@@ -0,0 +1,318 @@
+/*
+Rough throughput benchmarks for the locks, counters and queues. These are not tests and are not run by CTest.
+The numbers are only meaningful relative to each other on the same machine, and only when the machine
+has at least as many cores as the thread count being measured.
+*/
+#include <stdio.h>
+#include <string.h>
+
+/* Waiting threads should give up their time slice rather than spin so the high thread counts are measured fairly. */
+#if defined(_WIN32)
+    #include <windows.h>
+    #define C89ATOMIC_YIELD()   Sleep(0)
+#else
+    #include <sched.h>
+    #define C89ATOMIC_YIELD()   sched_yield()
+#endif
+
+#include "../c89atomic.c"
+
+#include "../extras/c89atomic_ring_buffer.c"
+#include "../extras/c89atomic_mpmc_queue.c"
+
+#include "../external/c89thread/c89thread.c"
+
+#define BENCHMARK_MAX_THREADS   16
+#define BENCHMARK_ITERATIONS    1000000
+#define BENCHMARK_QUEUE_CAPACITY 1024
+
+typedef struct
+{
+    c89atomic_spinlock spinlock;
+    c89atomic_uint8 pad0[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_spinlock)];
+    c89atomic_rwlock rwlock;
+    c89atomic_uint32 value;         /* The data being protected. Only used to give the lock holder something to do. */
+    c89atomic_uint32 start;         /* Set to 1 to let the threads start at the same time. */
+    c89atomic_uint32 iterations;    /* Per thread. */
+    c89atomic_uint32 writeInterval; /* One in every this many operations is a write. 0 for no writes. */
+    c89atomic_uint8 pad1[C89ATOMIC_CACHE_LINE_SIZE];
+    c89atomic_uint64 sharedCounter;
+    c89atomic_uint8 pad2[C89ATOMIC_CACHE_LINE_SIZE - sizeof(c89atomic_uint64)];
+    c89atomic_counter counter;
+    c89atomic_ring_buffer ringBuffer;   /* Protected by the spinlock. */
+    c89atomic_uint32 ringBufferData[BENCHMARK_QUEUE_CAPACITY * 2];
+    c89atomic_mpmc_queue queue;
+    c89atomic_uint64 queueData[BENCHMARK_QUEUE_CAPACITY * 2];   /* 16 bytes per slot. */
+} benchmark_data;
+
+static int benchmark_wait_for_start(benchmark_data* pData)
+{
+    while (c89atomic_load_explicit_32(&pData->start, c89atomic_memory_order_acquire) == 0) {
+        c89atomic_cpu_relax();
+    }
+
+    return 0;
+}
+
+static c89atomic_bool benchmark_is_write(benchmark_data* pData, c89atomic_uint32 i)
+{
+    return pData->writeInterval != 0 && (i % pData->writeInterval) == 0;
+}
+
+static int benchmark_spinlock_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 sum = 0;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_spinlock_lock(&pData->spinlock);
+        {
+            if (benchmark_is_write(pData, i)) {
+                pData->value += 1;
+            } else {
+                sum += pData->value;
+            }
+        }
+        c89atomic_spinlock_unlock(&pData->spinlock);
+    }
+
+    return (int)(sum & 1);
+}
+
+static int benchmark_rwlock_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 sum = 0;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        if (benchmark_is_write(pData, i)) {
+            c89atomic_rwlock_write_lock(&pData->rwlock);
+            {
+                pData->value += 1;
+            }
+            c89atomic_rwlock_write_unlock(&pData->rwlock);
+        } else {
+            c89atomic_uint32 slot = c89atomic_rwlock_read_lock(&pData->rwlock);
+            {
+                sum += pData->value;
+            }
+            c89atomic_rwlock_read_unlock(&pData->rwlock, slot);
+        }
+    }
+
+    return (int)(sum & 1);
+}
+
+static int benchmark_shared_counter_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_fetch_add_explicit_64(&pData->sharedCounter, 1, c89atomic_memory_order_relaxed);
+    }
+
+    return 0;
+}
+
+static int benchmark_sharded_counter_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_counter_increment(&pData->counter);
+    }
+
+    return 0;
+}
+
+/*
+Each iteration of the queue benchmarks is a push followed by a pop. Every thread is both a producer
+and a consumer which keeps the queue from filling up or running dry no matter the thread count.
+*/
+static int benchmark_locked_ring_buffer_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 sum = 0;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        void* pMapped;
+
+        for (;;) {
+            c89atomic_spinlock_lock(&pData->spinlock);
+            if (c89atomic_ring_buffer_map_produce(&pData->ringBuffer, 1, &pMapped) == 1) {
+                *(c89atomic_uint32*)pMapped = i;
+                c89atomic_ring_buffer_unmap_produce(&pData->ringBuffer, 1);
+                c89atomic_spinlock_unlock(&pData->spinlock);
+                break;
+            }
+            c89atomic_spinlock_unlock(&pData->spinlock);
+        }
+
+        for (;;) {
+            c89atomic_spinlock_lock(&pData->spinlock);
+            if (c89atomic_ring_buffer_map_consume(&pData->ringBuffer, 1, &pMapped) == 1) {
+                sum += *(c89atomic_uint32*)pMapped;
+                c89atomic_ring_buffer_unmap_consume(&pData->ringBuffer, 1);
+                c89atomic_spinlock_unlock(&pData->spinlock);
+                break;
+            }
+            c89atomic_spinlock_unlock(&pData->spinlock);
+        }
+    }
+
+    return (int)(sum & 1);
+}
+
+static int benchmark_mpmc_queue_thread(void* arg)
+{
+    benchmark_data* pData = (benchmark_data*)arg;
+    c89atomic_uint32 sum = 0;
+    c89atomic_uint32 i;
+
+    benchmark_wait_for_start(pData);
+
+    for (i = 0; i < pData->iterations; i += 1) {
+        c89atomic_uint32 value = i;
+
+        while (c89atomic_mpmc_queue_push(&pData->queue, &value) != C89ATOMIC_MPMC_QUEUE_SUCCESS) {
+            c89atomic_cpu_relax();
+        }
+
+        /* Can be empty for a moment if another thread has claimed a slot but not yet written to it. */
+        while (c89atomic_mpmc_queue_pop(&pData->queue, &value) != C89ATOMIC_MPMC_QUEUE_SUCCESS) {
+            c89atomic_cpu_relax();
+        }
+
+        sum += value;
+    }
+
+    return (int)(sum & 1);
+}
+
+/* Returns the average number of nanoseconds per operation, or -1 if the threads could not be created. */
+static double benchmark_run(c89thrd_start_t threadProc, int threadCount, c89atomic_uint32 writeInterval)
+{
+    c89thrd_t threads[BENCHMARK_MAX_THREADS];
+    static benchmark_data data;    /* Static because it's big. */
+    struct timespec startTime;
+    struct timespec elapsed;
+    int createdCount = 0;
+    int i;
+
+    memset(&data, 0, sizeof(data));
+    data.iterations    = BENCHMARK_ITERATIONS / threadCount;
+    data.writeInterval = writeInterval;
+    c89atomic_ring_buffer_init(BENCHMARK_QUEUE_CAPACITY, sizeof(c89atomic_uint32), 0, data.ringBufferData, &data.ringBuffer);
+    c89atomic_mpmc_queue_init(BENCHMARK_QUEUE_CAPACITY, sizeof(c89atomic_uint32), data.queueData, &data.queue);
+
+    for (i = 0; i < threadCount; i += 1) {
+        if (c89thrd_create(&threads[i], threadProc, &data) == c89thrd_success) {
+            createdCount += 1;
+        }
+    }
+
+    startTime = c89timespec_now();
+    c89atomic_store_explicit_32(&data.start, 1, c89atomic_memory_order_release);
+
+    for (i = 0; i < createdCount; i += 1) {
+        c89thrd_join(threads[i], NULL);
+    }
+
+    elapsed = c89timespec_diff(c89timespec_now(), startTime);
+
+    if (createdCount != threadCount) {
+        return -1;
+    }
+
+    return ((double)elapsed.tv_sec * 1000000000.0 + (double)elapsed.tv_nsec) / (double)(data.iterations * threadCount);
+}
+
+static void benchmark_rwlock(void)
+{
+    static const c89atomic_uint32 writeIntervals[] = {0, 100, 10};
+    int iInterval;
+    int threadCount;
+
+    printf("Reader-writer lock vs spinlock (ns per operation):\n");
+    printf("    %-24s %-8s %12s %12s\n", "Workload", "Threads", "spinlock", "rwlock");
+
+    for (iInterval = 0; iInterval < (int)(sizeof(writeIntervals) / sizeof(writeIntervals[0])); iInterval += 1) {
+        char workload[32];
+
+        if (writeIntervals[iInterval] == 0) {
+            sprintf(workload, "Reads only");
+        } else {
+            sprintf(workload, "1 write per %u ops", (unsigned int)writeIntervals[iInterval]);
+        }
+
+        for (threadCount = 1; threadCount <= BENCHMARK_MAX_THREADS; threadCount *= 2) {
+            double spinlockTime = benchmark_run(benchmark_spinlock_thread, threadCount, writeIntervals[iInterval]);
+            double rwlockTime   = benchmark_run(benchmark_rwlock_thread,   threadCount, writeIntervals[iInterval]);
+
+            printf("    %-24s %-8d %12.2f %12.2f\n", workload, threadCount, spinlockTime, rwlockTime);
+        }
+    }
+
+    printf("\n");
+}
+
+static void benchmark_counter(void)
+{
+    int threadCount;
+
+    printf("Sharded counter vs single counter (ns per increment):\n");
+    printf("    %-8s %12s %12s\n", "Threads", "single", "sharded");
+
+    for (threadCount = 1; threadCount <= BENCHMARK_MAX_THREADS; threadCount *= 2) {
+        double sharedTime  = benchmark_run(benchmark_shared_counter_thread,  threadCount, 0);
+        double shardedTime = benchmark_run(benchmark_sharded_counter_thread, threadCount, 0);
+
+        printf("    %-8d %12.2f %12.2f\n", threadCount, sharedTime, shardedTime);
+    }
+
+    printf("\n");
+}
+
+static void benchmark_queue(void)
+{
+    int threadCount;
+
+    printf("MPMC queue vs ring buffer with a spinlock (ns per push and pop):\n");
+    printf("    %-8s %12s %12s\n", "Threads", "locked ring", "mpmc queue");
+
+    for (threadCount = 1; threadCount <= BENCHMARK_MAX_THREADS; threadCount *= 2) {
+        double ringBufferTime = benchmark_run(benchmark_locked_ring_buffer_thread, threadCount, 0);
+        double queueTime      = benchmark_run(benchmark_mpmc_queue_thread,         threadCount, 0);
+
+        printf("    %-8d %12.2f %12.2f\n", threadCount, ringBufferTime, queueTime);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    benchmark_rwlock();
+    benchmark_counter();
+    benchmark_queue();
+
+    (void)argc;
+    (void)argv;
+
+    return 0;
+}